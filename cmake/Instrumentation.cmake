@@ -0,0 +1,10 @@
+#
+# Instrumentation
+#
+
+option(BUILD_INSTRUMENTATION "Enable building with runtime instrumentation counters" OFF)
+
+if (BUILD_INSTRUMENTATION)
+    message(STATUS "Building with instrumentation")
+    add_compile_definitions(BUILD_INSTRUMENTATION)
+endif ()
\ No newline at end of file
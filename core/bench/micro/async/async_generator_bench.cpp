@@ -0,0 +1,45 @@
+#include "plex/async/async_generator.h"
+
+#include <benchmark/benchmark.h>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+
+namespace plex::bench
+{
+static void AsyncGenerator_Iterate(benchmark::State& state)
+{
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  auto iota = [](size_t count) -> AsyncGenerator<size_t>
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      co_yield i;
+    }
+  };
+
+  for (auto _ : state)
+  {
+    auto generator = iota(amount);
+
+    auto consumer = [&]() -> Task<size_t>
+    {
+      size_t sum = 0;
+
+      while (size_t* value = co_await generator.Next())
+      {
+        sum += *value;
+      }
+
+      co_return sum;
+    };
+
+    benchmark::DoNotOptimize(SyncWait(consumer()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(AsyncGenerator_Iterate)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+} // namespace plex::bench
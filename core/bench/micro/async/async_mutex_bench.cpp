@@ -0,0 +1,88 @@
+#include "plex/async/async_mutex.h"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+#include "micro/common/fake_work.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+#include "plex/containers/vector.h"
+
+namespace plex::bench
+{
+static void AsyncMutex_Reference_StdMutex(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  std::mutex mutex;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    std::scoped_lock lock(mutex);
+
+    Work(10);
+  };
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(AsyncMutex_Reference_StdMutex)
+  ->Arg(1000)
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void AsyncMutex_Contended(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  AsyncMutex mutex(pool);
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    auto guard = co_await mutex.ScopedLock();
+
+    Work(10);
+  };
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(AsyncMutex_Contended)->Arg(1000)->Unit(benchmark::kMicrosecond)->MeasureProcessCPUTime()->UseRealTime();
+} // namespace plex::bench
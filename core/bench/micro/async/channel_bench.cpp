@@ -0,0 +1,68 @@
+#include "plex/async/channel.h"
+
+#include <benchmark/benchmark.h>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+
+namespace plex::bench
+{
+template<ChannelMode Mode>
+static void Channel_Pipeline(benchmark::State& state)
+{
+  ThreadPool pool(2, true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+  const auto capacity = static_cast<size_t>(state.range(1));
+
+  for (auto _ : state)
+  {
+    Channel<size_t, Mode> channel(pool, capacity);
+
+    auto producer = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < amount; i++)
+      {
+        co_await channel.Send(i);
+      }
+
+      channel.Close();
+    };
+
+    auto consumer = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      size_t sum = 0;
+
+      while (auto value = co_await channel.Receive())
+      {
+        sum += *value;
+      }
+
+      benchmark::DoNotOptimize(sum);
+    };
+
+    SyncWait(WhenAll(producer(), consumer()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK_TEMPLATE(Channel_Pipeline, ChannelMode::SingleProducerSingleConsumer)
+  ->Args({ 100000, 64 })
+  ->Args({ 100000, 1024 })
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+BENCHMARK_TEMPLATE(Channel_Pipeline, ChannelMode::MultiProducerMultiConsumer)
+  ->Args({ 100000, 64 })
+  ->Args({ 100000, 1024 })
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+} // namespace plex::bench
@@ -0,0 +1,112 @@
+#include "plex/async/frame_allocator.h"
+
+#include <benchmark/benchmark.h>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/thread_pool.h"
+#include "plex/async/when_all.h"
+#include "plex/containers/vector.h"
+
+namespace plex::bench
+{
+namespace
+{
+  Task<size_t> Leaf(size_t value)
+  {
+    co_return value;
+  }
+
+  Task<size_t> Nested(size_t depth)
+  {
+    if (depth == 0) co_return co_await Leaf(depth);
+
+    co_return co_await Nested(depth - 1) + 1;
+  }
+
+  Task<> Scheduled(ThreadPool& pool)
+  {
+    co_await pool.Schedule();
+  }
+} // namespace
+
+static void FrameAllocator_Reference_New_Delete(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    void* frame = ::operator new(256);
+    benchmark::DoNotOptimize(frame);
+    ::operator delete(frame, size_t { 256 });
+  }
+}
+
+BENCHMARK(FrameAllocator_Reference_New_Delete)->Unit(benchmark::kNanosecond);
+
+static void FrameAllocator_AllocateFrame_DeallocateFrame(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    void* frame = AllocateFrame(256);
+    benchmark::DoNotOptimize(frame);
+    DeallocateFrame(frame, 256);
+  }
+}
+
+BENCHMARK(FrameAllocator_AllocateFrame_DeallocateFrame)->Unit(benchmark::kNanosecond);
+
+static void FrameAllocator_Task_NestedChain(benchmark::State& state)
+{
+  const auto depth = static_cast<size_t>(state.range(0));
+
+  const auto before = GetFrameAllocatorStats();
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(SyncWait(Nested(depth)));
+  }
+
+  const auto after = GetFrameAllocatorStats();
+
+  state.counters["allocations"] =
+    benchmark::Counter(static_cast<double>(after.allocations - before.allocations), benchmark::Counter::kIsRate);
+  state.counters["heap_allocations"] = static_cast<double>(after.heap_allocations - before.heap_allocations);
+}
+
+BENCHMARK(FrameAllocator_Task_NestedChain)->Arg(1)->Arg(16)->Arg(256)->Unit(benchmark::kNanosecond);
+
+static void FrameAllocator_Task_CrossThread(benchmark::State& state)
+{
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  ThreadPool pool;
+
+  const auto before = GetFrameAllocatorStats();
+
+  for (auto _ : state)
+  {
+    // Frames are created on this thread and destroyed on the workers.
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(Scheduled(pool));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  const auto after = GetFrameAllocatorStats();
+
+  state.counters["allocations"] =
+    benchmark::Counter(static_cast<double>(after.allocations - before.allocations), benchmark::Counter::kIsRate);
+  state.counters["cache_misses"] = static_cast<double>(after.cache_misses - before.cache_misses);
+  state.counters["heap_allocations"] = static_cast<double>(after.heap_allocations - before.heap_allocations);
+}
+
+BENCHMARK(FrameAllocator_Task_CrossThread)
+  ->Arg(1000)
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+} // namespace plex::bench
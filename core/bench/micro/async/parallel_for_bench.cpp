@@ -0,0 +1,115 @@
+#include "plex/async/parallel_for.h"
+
+#include <benchmark/benchmark.h>
+
+#include "micro/common/fake_work.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+#include "plex/containers/vector.h"
+
+namespace plex::bench
+{
+namespace
+{
+  Task<> CreateTask(ThreadPool& pool, size_t begin, size_t end, size_t work)
+  {
+    co_await pool.Schedule();
+
+    for (size_t i = begin; i != end; i++)
+    {
+      Work(work);
+    }
+  }
+} // namespace
+
+static void ParallelFor_Reference_WhenAllOfTasks(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+  const auto grain = static_cast<size_t>(state.range(1));
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve((amount + grain - 1) / grain);
+
+    for (size_t i = 0; i < amount; i += grain)
+    {
+      tasks.push_back(CreateTask(pool, i, std::min(i + grain, amount), 10));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ParallelFor_Reference_WhenAllOfTasks)
+  ->Args({ 10000, 1 })
+  ->Args({ 10000, 64 })
+  ->Args({ 1000000, 1024 })
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ParallelFor_PerIndex(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+  const auto grain = static_cast<size_t>(state.range(1));
+
+  for (auto _ : state)
+  {
+    SyncWait(ParallelFor(pool, 0, amount, grain, [](size_t) { Work(10); }));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ParallelFor_PerIndex)
+  ->Args({ 10000, 1 })
+  ->Args({ 10000, 64 })
+  ->Args({ 1000000, 1024 })
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ParallelFor_UnevenWork(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state)
+  {
+    // Cost grows with the index, a static split would leave the last worker with most of the work.
+    SyncWait(ParallelFor(pool, 0, amount, 16, [](size_t i) { Work(i / 16); }));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ParallelFor_UnevenWork)->Arg(10000)->Unit(benchmark::kMicrosecond)->MeasureProcessCPUTime()->UseRealTime();
+
+static void ParallelReduce_Sum(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto result = SyncWait(ParallelReduce(
+      pool, 0, amount, 4096, size_t { 0 }, [](size_t i) { return i * i; }, [](size_t a, size_t b) { return a + b; }));
+
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ParallelReduce_Sum)->Arg(1000000)->Unit(benchmark::kMicrosecond)->MeasureProcessCPUTime()->UseRealTime();
+} // namespace plex::bench
@@ -1,6 +1,8 @@
 #include "plex/async/thread_pool.h"
 
+#include <chrono>
 #include <future>
+#include <thread>
 
 #include <benchmark/benchmark.h>
 
@@ -14,12 +16,22 @@ namespace plex::bench
 {
 namespace
 {
-  Task<> CreateTask(ThreadPool& pool, size_t work)
+  Task<> CreateTask(ThreadPool& pool, size_t work, SchedulePriority priority = SchedulePriority::Normal)
   {
-    co_await pool.Schedule();
+    co_await pool.Schedule(priority);
 
     Work(work);
   }
+
+  Task<> CreateHoppingTask(ThreadPool& pool, size_t hops, size_t work)
+  {
+    for (size_t i = 0; i < hops; i++)
+    {
+      co_await pool.Schedule(); // Every hop after the first is scheduled from a worker thread
+
+      Work(work);
+    }
+  }
 } // namespace
 
 static void ThreadPool_STD_Reference_ThreadCreation(benchmark::State& state)
@@ -251,4 +263,425 @@ BENCHMARK(ThreadPool_Schedule_WorkDividedInManySmallTasks)
   ->MeasureProcessCPUTime()
   ->UseRealTime();
 
-} // namespace plex::bench
\ No newline at end of file
+static void ThreadPool_Contention_ChainedHops(benchmark::State& state)
+{
+  // Many coroutines rescheduling themselves over and over from worker threads.
+  // In the shared mode every hop takes the queue lock, in the work stealing mode hops stay on the worker deque.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto amount = static_cast<size_t>(state.range(1));
+
+  constexpr size_t hops = 64;
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(CreateHoppingTask(pool, hops, 0));
+    }
+
+    benchmark::DoNotOptimize(tasks.data());
+    benchmark::ClobberMemory();
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount * hops));
+}
+
+BENCHMARK(ThreadPool_Contention_ChainedHops)
+  ->ArgNames({ "mode", "tasks" })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 64 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 64 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 1024 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 1024 })
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Contention_NestedFanOut(benchmark::State& state)
+{
+  // A task on the pool fans out many small tasks, which is how systems spawn sub-work.
+  // The fan out is done from a worker thread, so in the work stealing mode the children land in the local deque and
+  // are stolen by idle workers.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto amount = static_cast<size_t>(state.range(1));
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  auto fan_out = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(CreateTask(pool, 100));
+    }
+
+    co_await WhenAll(std::move(tasks));
+  };
+
+  for (auto _ : state)
+  {
+    SyncWait(fan_out());
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ThreadPool_Contention_NestedFanOut)
+  ->ArgNames({ "mode", "tasks" })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 1000 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 1000 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 10000 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 10000 })
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Contention_ExternalProducers(benchmark::State& state)
+{
+  // Threads outside of the pool handing off work, like the main thread or io threads do.
+  // In the shared mode every hand off takes the queue lock, in the work stealing mode it goes to the injection queue.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto producers_amount = static_cast<size_t>(state.range(1));
+
+  constexpr size_t amount = 1000;
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  auto produce = [&]()
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(CreateTask(pool, 0));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  };
+
+  for (auto _ : state)
+  {
+    Vector<std::thread> producers;
+    producers.reserve(producers_amount);
+
+    for (size_t i = 0; i < producers_amount; i++)
+    {
+      producers.emplace_back(produce);
+    }
+
+    for (auto& producer : producers)
+    {
+      producer.join();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(producers_amount * amount));
+}
+
+BENCHMARK(ThreadPool_Contention_ExternalProducers)
+  ->ArgNames({ "mode", "producers" })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 1 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 1 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 4 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 4 })
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Idle_WakeLatency(benchmark::State& state)
+{
+  // Time between scheduling from outside the pool and the coroutine running on a worker, when every worker is parked.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  std::chrono::high_resolution_clock::time_point resumed;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    resumed = std::chrono::high_resolution_clock::now();
+  };
+
+  for (auto _ : state)
+  {
+    // Give the workers time to go through their spin budget and park.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+    const auto scheduled = std::chrono::high_resolution_clock::now();
+
+    SyncWait(make_task());
+
+    state.SetIterationTime(std::chrono::duration<double>(resumed - scheduled).count());
+  }
+}
+
+BENCHMARK(ThreadPool_Idle_WakeLatency)
+  ->ArgName("mode")
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::Shared))
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::WorkStealing))
+  ->Unit(benchmark::kMicrosecond)
+  ->UseManualTime();
+
+static void ThreadPool_Idle_CPUUsage(benchmark::State& state)
+{
+  // Process CPU time burned by the pool over a wall clock period with a trickle of work, like a dedicated server
+  // between frames. Compare the CPU time against the real time.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  for (auto _ : state)
+  {
+    SyncWait(CreateTask(pool, 100));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+BENCHMARK(ThreadPool_Idle_CPUUsage)
+  ->ArgName("mode")
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::Shared))
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::WorkStealing))
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Priority_FrameLatencyUnderBackgroundLoad(benchmark::State& state)
+{
+  // Time to run a frame worth of small tasks while a bulk background job floods the pool.
+  // Without priorities the frame tasks wait behind the background job.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const bool use_priorities = state.range(1) != 0;
+
+  const auto frame_priority = use_priorities ? SchedulePriority::High : SchedulePriority::Normal;
+  const auto background_priority = use_priorities ? SchedulePriority::Low : SchedulePriority::Normal;
+
+  constexpr size_t frame_amount = 64;
+  constexpr size_t background_amount = 10000;
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  for (auto _ : state)
+  {
+    std::thread background(
+      [&]()
+      {
+        Vector<Task<>> tasks;
+        tasks.reserve(background_amount);
+
+        for (size_t i = 0; i < background_amount; i++)
+        {
+          tasks.push_back(CreateTask(pool, 1000, background_priority));
+        }
+
+        SyncWait(WhenAll(std::move(tasks)));
+      });
+
+    // Let the background job land in the pool first.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    Vector<Task<>> tasks;
+    tasks.reserve(frame_amount);
+
+    for (size_t i = 0; i < frame_amount; i++)
+    {
+      tasks.push_back(CreateTask(pool, 100, frame_priority));
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+
+    background.join();
+  }
+}
+
+BENCHMARK(ThreadPool_Priority_FrameLatencyUnderBackgroundLoad)
+  ->ArgNames({ "mode", "priorities" })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 0 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::Shared), 1 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 0 })
+  ->Args({ static_cast<int64_t>(ThreadPoolMode::WorkStealing), 1 })
+  ->Unit(benchmark::kMicrosecond)
+  ->UseManualTime();
+
+static void ThreadPool_Locality_ChunkPasses(benchmark::State& state)
+{
+  // Several passes over chunks of data, like systems iterating the same archetypes every frame.
+  // With hints every chunk is processed by the same worker group on every pass, keeping it in that group's caches.
+
+  const bool use_hints = state.range(0) != 0;
+
+  constexpr size_t chunk_count = 256;
+  constexpr size_t chunk_size = 16 * 1024; // 64KB of floats per chunk
+  constexpr size_t passes = 4;
+
+  ThreadPool pool(std::thread::hardware_concurrency(), true, ThreadPoolMode::WorkStealing);
+
+  Vector<float> data;
+  data.resize(chunk_count * chunk_size, 1.0f);
+
+  auto process_chunk = [&](size_t chunk) -> Task<>
+  {
+    if (use_hints) co_await pool.Schedule(LocalityHint { chunk });
+    else
+    {
+      co_await pool.Schedule();
+    }
+
+    float* values = data.data() + chunk * chunk_size;
+
+    for (size_t i = 0; i < chunk_size; i++)
+    {
+      values[i] = values[i] * 0.5f + 0.5f;
+    }
+  };
+
+  for (auto _ : state)
+  {
+    for (size_t pass = 0; pass < passes; pass++)
+    {
+      Vector<Task<>> tasks;
+      tasks.reserve(chunk_count);
+
+      for (size_t i = 0; i < chunk_count; i++)
+      {
+        tasks.push_back(process_chunk(i));
+      }
+
+      SyncWait(WhenAll(std::move(tasks)));
+    }
+  }
+
+  benchmark::DoNotOptimize(data.data());
+
+  state.counters["groups"] = static_cast<double>(pool.GroupCount());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(passes * data.size() * sizeof(float)));
+}
+
+BENCHMARK(ThreadPool_Locality_ChunkPasses)
+  ->ArgName("hints")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Batch_FanOut(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, static_cast<ThreadPoolMode>(state.range(0)));
+
+  const bool use_batch = state.range(1) != 0;
+
+  constexpr size_t amount = 1000;
+
+  ThreadPool::Batch batch;
+
+  auto make_task = [&]() -> Task<>
+  {
+    if (use_batch) co_await pool.Schedule(batch);
+    else
+    {
+      co_await pool.Schedule();
+    }
+
+    Work(100);
+  };
+
+  auto submit = [&]() -> Task<>
+  {
+    pool.Submit(batch);
+    co_return;
+  };
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(WhenAll(std::move(tasks)), submit()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ThreadPool_Batch_FanOut)
+  ->ArgNames({ "mode", "batch" })
+  ->ArgsProduct({ { 0, 1 }, { 0, 1 } })
+  ->Unit(benchmark::kMicrosecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+static void ThreadPool_Timer_ConcurrentSleeps(benchmark::State& state)
+{
+  ThreadPool pool(GetAmountPhysicalProcessors(), true, ThreadPoolMode::WorkStealing);
+
+  const auto amount = static_cast<size_t>(state.range(0));
+
+  std::atomic<int64_t> lateness = 0; // Total time timers resumed past their deadline, in nanoseconds
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    const auto deadline = ThreadPool::Clock::now() + std::chrono::microseconds(100 + index % 1000);
+
+    co_await pool.SleepUntil(deadline);
+
+    lateness.fetch_add((ThreadPool::Clock::now() - deadline).count(), std::memory_order_relaxed);
+  };
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task(i));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  const auto timers = static_cast<double>(state.iterations() * static_cast<int64_t>(amount));
+
+  state.counters["lateness_us"] = static_cast<double>(lateness.load()) / timers / 1000.0;
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ThreadPool_Timer_ConcurrentSleeps)
+  ->Arg(100)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
+
+} // namespace plex::bench
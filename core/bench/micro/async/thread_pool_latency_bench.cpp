@@ -0,0 +1,331 @@
+#include "plex/async/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "micro/common/fake_work.h"
+#include "plex/async/channel.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+#include "plex/containers/vector.h"
+
+// Latency and scalability suite of the thread pool.
+//
+// Latencies are reported as percentile counters (p50_ns, p90_ns, p99_ns, p999_ns, max_ns) next to the usual timings.
+// Run with --benchmark_out=<file> --benchmark_out_format=json (or csv) to compare runs on numbers.
+
+namespace plex::bench
+{
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  ///
+  /// Latency samples of a benchmark. Every sample has its own slot so that workers record without synchronization.
+  ///
+  class LatencySamples
+  {
+  public:
+    explicit LatencySamples(size_t amount)
+    {
+      samples_.resize(amount);
+    }
+
+    void Record(size_t index, Clock::time_point start) noexcept
+    {
+      samples_[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    ///
+    /// Appends the samples recorded since the last flush to the samples of the whole benchmark.
+    ///
+    void Flush()
+    {
+      all_.insert(all_.end(), samples_.begin(), samples_.end());
+    }
+
+    ///
+    /// Reports the percentiles of every flushed sample as counters of the benchmark.
+    ///
+    void Report(benchmark::State& state)
+    {
+      if (all_.empty()) return;
+
+      std::sort(all_.begin(), all_.end());
+
+      auto percentile = [&](double p)
+      {
+        const auto index = static_cast<size_t>(p * static_cast<double>(all_.size() - 1));
+        return static_cast<double>(all_[index]);
+      };
+
+      state.counters["p50_ns"] = percentile(0.5);
+      state.counters["p90_ns"] = percentile(0.9);
+      state.counters["p99_ns"] = percentile(0.99);
+      state.counters["p999_ns"] = percentile(0.999);
+      state.counters["max_ns"] = static_cast<double>(all_.back());
+    }
+
+  private:
+    Vector<int64_t> samples_;
+    std::vector<int64_t> all_;
+  };
+
+  Task<> CreateTimedTask(ThreadPool& pool, LatencySamples& samples, size_t index)
+  {
+    const auto scheduled = Clock::now();
+
+    co_await pool.Schedule();
+
+    samples.Record(index, scheduled);
+  }
+
+  Task<> CreateTask(ThreadPool& pool, size_t work)
+  {
+    co_await pool.Schedule();
+
+    Work(work);
+  }
+} // namespace
+
+static void ThreadPool_Latency_EnqueueToExecute(benchmark::State& state)
+{
+  // Time between a coroutine scheduling itself from outside the pool and a worker resuming it, for bursts of
+  // operations. The tail shows queueing, the head shows wake-up cost.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto amount = static_cast<size_t>(state.range(1));
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  LatencySamples samples(amount);
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(CreateTimedTask(pool, samples, i));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    state.PauseTiming();
+    samples.Flush();
+    state.ResumeTiming();
+  }
+
+  samples.Report(state);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ThreadPool_Latency_EnqueueToExecute)
+  ->ArgNames({ "mode", "burst" })
+  ->ArgsProduct({ { static_cast<int64_t>(ThreadPoolMode::Shared), static_cast<int64_t>(ThreadPoolMode::WorkStealing) },
+    { 1, 64, 4096 } })
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime();
+
+static void ThreadPool_Latency_FanOutFanIn(benchmark::State& state)
+{
+  // Cost of a worker forking empty children and joining them, at varying widths. Divide the time by the width for the
+  // cost per child.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto width = static_cast<size_t>(state.range(1));
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  auto fork_join = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    Vector<Task<>> tasks;
+    tasks.reserve(width);
+
+    for (size_t i = 0; i < width; i++)
+    {
+      tasks.push_back(CreateTask(pool, 0));
+    }
+
+    co_await WhenAll(std::move(tasks));
+  };
+
+  for (auto _ : state)
+  {
+    SyncWait(fork_join());
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(width));
+}
+
+BENCHMARK(ThreadPool_Latency_FanOutFanIn)
+  ->ArgNames({ "mode", "width" })
+  ->ArgsProduct({ { static_cast<int64_t>(ThreadPoolMode::Shared), static_cast<int64_t>(ThreadPoolMode::WorkStealing) },
+    { 1, 4, 16, 64, 256, 1024 } })
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime();
+
+static void ThreadPool_Latency_PingPong(benchmark::State& state)
+{
+  // Two coroutines passing a value back and forth through channels of capacity 1. Every exchange is a hand off between
+  // coroutines, and between workers whenever they are running on different ones.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+
+  constexpr size_t exchanges = 10000;
+
+  ThreadPool pool(2, false, mode);
+
+  for (auto _ : state)
+  {
+    Channel<size_t> ping(pool, 1);
+    Channel<size_t> pong(pool, 1);
+
+    auto pinger = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < exchanges; i++)
+      {
+        co_await ping.Send(i);
+        benchmark::DoNotOptimize(co_await pong.Receive());
+      }
+
+      ping.Close();
+    };
+
+    auto ponger = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      while (auto value = co_await ping.Receive())
+      {
+        co_await pong.Send(*value);
+      }
+    };
+
+    SyncWait(WhenAll(pinger(), ponger()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(exchanges));
+}
+
+BENCHMARK(ThreadPool_Latency_PingPong)
+  ->ArgName("mode")
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::Shared))
+  ->Arg(static_cast<int64_t>(ThreadPoolMode::WorkStealing))
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+static void ThreadPool_Scaling_Workers(benchmark::State& state)
+{
+  // Same amount of small tasks with more and more workers. Ideal scaling halves the time when the workers double.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto workers = static_cast<size_t>(state.range(1));
+
+  constexpr size_t amount = 10000;
+
+  ThreadPool pool(workers, false, mode);
+
+  for (auto _ : state)
+  {
+    Vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(CreateTask(pool, 1000));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+
+  state.counters["workers"] = static_cast<double>(workers);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(amount));
+}
+
+BENCHMARK(ThreadPool_Scaling_Workers)
+  ->ArgNames({ "mode", "workers" })
+  ->Apply(
+    [](benchmark::internal::Benchmark* benchmark)
+    {
+      const auto max_workers = static_cast<int64_t>(std::max(std::thread::hardware_concurrency(), 1u));
+
+      for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+      {
+        for (int64_t workers = 1; workers < max_workers; workers *= 2)
+        {
+          benchmark->Args({ static_cast<int64_t>(mode), workers });
+        }
+
+        benchmark->Args({ static_cast<int64_t>(mode), max_workers });
+      }
+    })
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+static void ThreadPool_Latency_ProducerContention(benchmark::State& state)
+{
+  // Threads outside of the pool scheduling at the same time, reported as enqueue-to-execute percentiles so that the
+  // cost of contention on the queue shows up in the tail.
+
+  const auto mode = static_cast<ThreadPoolMode>(state.range(0));
+  const auto producers_amount = static_cast<size_t>(state.range(1));
+
+  constexpr size_t amount = 1000; // Per producer
+
+  ThreadPool pool(std::thread::hardware_concurrency(), false, mode);
+
+  LatencySamples samples(producers_amount * amount);
+
+  for (auto _ : state)
+  {
+    Vector<std::thread> producers;
+    producers.reserve(producers_amount);
+
+    for (size_t p = 0; p < producers_amount; p++)
+    {
+      producers.emplace_back(
+        [&, p]()
+        {
+          Vector<Task<>> tasks;
+          tasks.reserve(amount);
+
+          for (size_t i = 0; i < amount; i++)
+          {
+            tasks.push_back(CreateTimedTask(pool, samples, p * amount + i));
+          }
+
+          SyncWait(WhenAll(std::move(tasks)));
+        });
+    }
+
+    for (auto& producer : producers)
+    {
+      producer.join();
+    }
+
+    state.PauseTiming();
+    samples.Flush();
+    state.ResumeTiming();
+  }
+
+  samples.Report(state);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(producers_amount * amount));
+}
+
+BENCHMARK(ThreadPool_Latency_ProducerContention)
+  ->ArgNames({ "mode", "producers" })
+  ->ArgsProduct({ { static_cast<int64_t>(ThreadPoolMode::Shared), static_cast<int64_t>(ThreadPoolMode::WorkStealing) },
+    { 1, 2, 4, 8 } })
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+} // namespace plex::bench
@@ -1,5 +1,8 @@
 #include "plex/scheduler/scheduler.h"
 
+#include <array>
+#include <utility>
+
 #include <benchmark/benchmark.h>
 
 #include "micro/common/fake_work.h"
@@ -50,6 +53,13 @@ namespace
     Work(10000);
   }
 
+  template<size_t id, Query... queries>
+  Task<void> HeavyAsyncSystemMock([[maybe_unused]] queries... q)
+  {
+    co_await thread_pool.Schedule();
+    Work(1000000);
+  }
+
   template<size_t StageId, size_t Systems, bool Async, size_t I = Systems>
   struct SystemGenerator
   {
@@ -89,6 +99,48 @@ namespace
     }
   };
 
+  // Large schedules. Systems only differ in id within a pattern, so that the query types (and everything instantiated
+  // for them) are shared. A pattern writes its own data and reads the data of the next pattern.
+
+  constexpr size_t cPatternCount = 8;
+  constexpr size_t cMaxSystemsPerPattern = 1250; // Up to 10k systems
+
+  template<size_t Pattern, size_t Id>
+  void PatternSystemMock(MockQuery<MockData<Pattern>, const MockData<(Pattern + 1) % cPatternCount>>)
+  {}
+
+  template<size_t Pattern, size_t... Ids>
+  constexpr auto MakePatternSystems(std::index_sequence<Ids...>)
+  {
+    return std::array { &PatternSystemMock<Pattern, Ids>... };
+  }
+
+  template<size_t Pattern>
+  void AddPatternSystems(Vector<std::unique_ptr<Stage>>& stages, size_t amount)
+  {
+    static constexpr auto systems = MakePatternSystems<Pattern>(std::make_index_sequence<cMaxSystemsPerPattern>());
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      stages[(i * cPatternCount + Pattern) % stages.size()]->AddSystem(systems[i]);
+    }
+  }
+
+  template<size_t... Patterns>
+  Vector<std::unique_ptr<Stage>> MakeLargeSchedule(size_t systems, size_t stage_count, std::index_sequence<Patterns...>)
+  {
+    Vector<std::unique_ptr<Stage>> stages;
+
+    for (size_t i = 0; i < stage_count; i++)
+    {
+      stages.push_back(std::make_unique<Stage>());
+    }
+
+    (AddPatternSystems<Patterns>(stages, systems / cPatternCount), ...);
+
+    return stages;
+  }
+
   template<size_t Stages, size_t I = Stages>
   struct StageScheduler
   {
@@ -137,6 +189,41 @@ BENCHMARK(Scheduler_ComputeSchedulerSteps_5Stages4SystemsEach)
   ->MeasureProcessCPUTime()
   ->UseRealTime();
 
+static void Scheduler_ComputeSchedulerSteps_LargeSchedule(benchmark::State& state)
+{
+  // Baking a new combination of stages happens on the first frame it is scheduled, so it stalls that frame.
+
+  const auto systems = static_cast<size_t>(state.range(0));
+
+  auto stages = MakeLargeSchedule(systems, 16, std::make_index_sequence<cPatternCount>());
+
+  Vector<Stage*> raw_ptr_stages;
+
+  for (auto& stage : stages)
+  {
+    raw_ptr_stages.push_back(stage.get());
+  }
+
+  for (auto _ : state)
+  {
+    auto steps = ComputeSchedulerData(raw_ptr_stages);
+
+    benchmark::DoNotOptimize(steps);
+  }
+
+  state.SetComplexityN(static_cast<int64_t>(systems));
+}
+
+BENCHMARK(Scheduler_ComputeSchedulerSteps_LargeSchedule)
+  ->ArgName("systems")
+  ->Arg(1000)
+  ->Arg(2500)
+  ->Arg(5000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
 // static void Scheduler_ComputeSchedulerSteps_10Stages8SystemsEach(benchmark::State& state)
 //{
 //   static constexpr size_t Stages = 10;
@@ -288,6 +375,47 @@ BENCHMARK(Scheduler_AsyncWork_5Stages4SystemsEach)
   ->MeasureProcessCPUTime()
   ->UseRealTime();
 
+static void Scheduler_AsyncWork_SkewedCosts(benchmark::State& state)
+{
+  // A chain of heavy systems next to many light ones that are added first. The heavy chain is the critical path, so
+  // the frame is shortest when its systems are started before the light ones.
+
+  static constexpr size_t Stages = 4;
+
+  Context context;
+
+  Scheduler scheduler;
+
+  SystemGenerator<1, 32, true>::AddSystems(scheduler);
+
+  scheduler.AddSystem<MockStage<1>>(HeavyAsyncSystemMock<1, MockQuery<MockData<100>>>);
+  scheduler.AddSystem<MockStage<2>>(HeavyAsyncSystemMock<2, MockQuery<MockData<100>>>);
+  scheduler.AddSystem<MockStage<3>>(HeavyAsyncSystemMock<3, MockQuery<MockData<100>>>);
+  scheduler.AddSystem<MockStage<4>>(HeavyAsyncSystemMock<4, MockQuery<MockData<100>>>);
+
+  // Run once to cache results and measure systems
+  StageScheduler<Stages>::ScheduleStages(scheduler);
+  SyncWait(scheduler.RunAll(context));
+
+  for (auto _ : state)
+  {
+    StageScheduler<Stages>::ScheduleStages(scheduler);
+
+    auto task = scheduler.RunAll(context);
+
+    benchmark::DoNotOptimize(task);
+
+    SyncWait(task);
+  }
+
+  benchmark::DoNotOptimize(scheduler);
+}
+
+BENCHMARK(Scheduler_AsyncWork_SkewedCosts)
+  ->Unit(benchmark::kMillisecond)
+  ->MeasureProcessCPUTime()
+  ->UseRealTime();
+
 static void Scheduler_Reference_10Stages8SystemsEach(benchmark::State& state)
 {
   static constexpr size_t Stages = 10;
@@ -1,6 +1,7 @@
 #ifndef PLEX_APP_APP_H
 #define PLEX_APP_APP_H
 
+#include "plex/async/main_thread_executor.h"
 #include "plex/async/thread_pool.h"
 #include "plex/scheduler/scheduler.h"
 
@@ -32,6 +33,16 @@ public:
   ///
   Task<void> RunScheduler();
 
+  ///
+  /// Executes all currently scheduled stages and waits for them to complete.
+  ///
+  /// The calling thread drives the main thread executor while waiting, so systems can resume on the main thread by
+  /// awaiting a schedule on the MainThreadExecutor global. In between, it helps the work pool.
+  ///
+  /// @warning Must be called by the thread that created the app.
+  ///
+  void RunFrame();
+
   ///
   /// Adds a package to the application.
   ///
@@ -151,6 +162,7 @@ private:
   Context global_context_;
   Scheduler scheduler_;
   ThreadPool work_pool_;
+  MainThreadExecutor main_thread_executor_;
 };
 } // namespace plex
 
@@ -0,0 +1,280 @@
+#ifndef PLEX_ASYNC_ASYNC_GENERATOR_H
+#define PLEX_ASYNC_ASYNC_GENERATOR_H
+
+#include <memory>
+#include <type_traits>
+
+#include "plex/async/task.h"
+
+namespace plex
+{
+template<typename Type>
+class AsyncGenerator;
+
+namespace details
+{
+  ///
+  /// Async generator promise.
+  ///
+  /// Yielded values are never copied, the promise only points to them. The value stays alive in the generator frame
+  /// while the generator is suspended at the yield.
+  ///
+  /// @tparam Type Type of the yielded values.
+  ///
+  template<typename Type>
+  class AsyncGeneratorPromise : public TaskContextCarrier
+  {
+  public:
+    using value_type = std::remove_reference_t<Type>;
+
+    ///
+    /// Awaiter used by yields and the final suspend. Transfers execution to the consumer.
+    ///
+    struct ConsumerAwaiter
+    {
+      ///
+      /// Called before suspending to check if we should avoid suspending.
+      ///
+      /// @return Always false.
+      ///
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      ///
+      /// Called after suspension. Resumes the consumer waiting for the next value.
+      ///
+      /// @param[in] handle Coroutine of the generator.
+      ///
+      /// @return Consumer handle to resume.
+      ///
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<AsyncGeneratorPromise> handle) const noexcept
+      {
+        return handle.promise().consumer_;
+      }
+
+      ///
+      /// Restores the task context of the generator, the consumer may have resumed it from another context.
+      ///
+      void await_resume() const noexcept
+      {
+        promise->RestoreContext();
+      }
+
+      AsyncGeneratorPromise* promise;
+    };
+
+    ///
+    /// Constructor.
+    ///
+    AsyncGeneratorPromise() noexcept : value_(nullptr) {}
+
+    ///
+    /// Obtains the generator from the promise.
+    ///
+    /// @return Generator for the promise.
+    ///
+    AsyncGenerator<Type> get_return_object() noexcept;
+
+    ///
+    /// Initially suspended to make generators lazily executed. Nothing runs until the first value is requested. Takes
+    /// the task context of the first consumer.
+    ///
+    /// @return Initial awaiter.
+    ///
+    InitialAwaiter initial_suspend() noexcept
+    {
+      return InitialSuspend();
+    }
+
+    ///
+    /// Clears the value and returns the awaiter that resumes the consumer, which then sees the end of the generator.
+    ///
+    /// @return Consumer awaiter.
+    ///
+    ConsumerAwaiter final_suspend() noexcept
+    {
+      value_ = nullptr;
+      return { this };
+    }
+
+    ///
+    /// Called by co_yield to publish a value and resume the consumer.
+    ///
+    /// @param[in] value Value to yield.
+    ///
+    /// @return Consumer awaiter.
+    ///
+    ConsumerAwaiter yield_value(value_type& value) noexcept
+    {
+      value_ = std::addressof(value);
+      return { this };
+    }
+
+    ///
+    /// Called by co_yield to publish a temporary value and resume the consumer. The temporary lives until the
+    /// generator is resumed.
+    ///
+    /// @param[in] value Value to yield.
+    ///
+    /// @return Consumer awaiter.
+    ///
+    ConsumerAwaiter yield_value(value_type&& value) noexcept
+    {
+      value_ = std::addressof(value);
+      return { this };
+    }
+
+    ///
+    /// Does nothing.
+    ///
+    void return_void() const noexcept {}
+
+    ///
+    /// Sets the consumer to resume on the next yield.
+    ///
+    /// @param[in] consumer Consumer coroutine.
+    ///
+    void SetConsumer(std::coroutine_handle<> consumer) noexcept
+    {
+      consumer_ = consumer;
+    }
+
+    ///
+    /// Returns the value that was yielded last.
+    ///
+    /// @return Pointer to the value, nullptr if the generator is done.
+    ///
+    [[nodiscard]] value_type* Value() const noexcept
+    {
+      return value_;
+    }
+
+    COROUTINE_UNHANDLED_EXCEPTION
+
+    COROUTINE_FRAME_ALLOCATOR
+
+  private:
+    value_type* value_;
+    std::coroutine_handle<> consumer_;
+  };
+} // namespace details
+
+///
+/// An async generator produces a sequence of values asynchronously. Values are produced with co_yield and pulled by
+/// the consumer with co_await, one at a time, so large results can be processed incrementally.
+///
+/// Generators are lazily executed. The generator runs until its next yield every time the consumer asks for a value,
+/// and execution is transferred between the two without going through a scheduler. The generator may await anything
+/// between yields, in which case the consumer is resumed wherever the generator is when it yields.
+///
+/// Values are not copied or allocated per element, the consumer gets a pointer to the yielded value which is valid
+/// until it asks for the next one.
+///
+/// @code
+/// AsyncGenerator<Chunk> ReadChunks(File& file)
+/// {
+///   Chunk chunk;
+///
+///   while (co_await file.Read(chunk))
+///   {
+///     co_yield chunk;
+///   }
+/// }
+///
+/// auto chunks = ReadChunks(file);
+///
+/// while (Chunk* chunk = co_await chunks.Next())
+/// {
+///   Process(*chunk);
+/// }
+/// @endcode
+///
+/// @tparam Type Type of the yielded values.
+///
+template<typename Type>
+class AsyncGenerator : public details::TaskBase
+{
+public:
+  using promise_type = details::AsyncGeneratorPromise<Type>;
+  using handle_type = std::coroutine_handle<promise_type>;
+  using value_type = typename promise_type::value_type;
+
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] handle Coroutine handle managed by the generator.
+  ///
+  explicit AsyncGenerator(handle_type handle) noexcept : TaskBase(handle) {}
+
+  ///
+  /// Returns an awaitable that when awaited, resumes the generator until it yields its next value.
+  ///
+  /// The awaiting coroutine is resumed on the thread that yielded the value.
+  ///
+  /// @warning The previous value is no longer valid once the next value is requested.
+  ///
+  /// @return Awaitable that results in a pointer to the next value, nullptr once the generator is done.
+  ///
+  auto Next() const noexcept
+  {
+    struct NextAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return !handle_ || handle_.done();
+      }
+
+      ///
+      /// Called after suspension. Sets the awaiting coroutine as the consumer and resumes the generator.
+      ///
+      /// @param[in] awaiting The awaiting coroutine.
+      ///
+      /// @return Generator handle to resume.
+      ///
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+      {
+        handle_.promise().SetConsumer(awaiting);
+        return handle_;
+      }
+
+      value_type* await_resume() const noexcept
+      {
+        return handle_ ? handle_.promise().Value() : nullptr;
+      }
+
+      handle_type handle_;
+    };
+
+    return NextAwaiter { Handle<promise_type>() };
+  }
+
+  ///
+  /// Returns whether or not the generator is done. Generators that are done will not yield any more values.
+  ///
+  /// @return True if the generator is done, false otherwise.
+  ///
+  [[nodiscard]] bool IsDone() const noexcept
+  {
+    return !Handle() || Handle().done();
+  }
+};
+
+namespace details
+{
+  // Out of line definitions
+
+  template<typename Type>
+  AsyncGenerator<Type> AsyncGeneratorPromise<Type>::get_return_object() noexcept
+  {
+    return AsyncGenerator<Type> { std::coroutine_handle<AsyncGeneratorPromise<Type>>::from_promise(*this) };
+  }
+} // namespace details
+
+template<typename Type>
+struct IsTriviallyRelocatable<AsyncGenerator<Type>> : std::true_type
+{};
+} // namespace plex
+
+#endif
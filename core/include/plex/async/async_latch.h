@@ -4,6 +4,7 @@
 #include <atomic>
 
 #include "plex/async/awaitable.h"
+#include "plex/async/task_local.h"
 #include "plex/debug/assertion.h"
 
 namespace plex
@@ -180,7 +181,7 @@ private:
     while (list != nullptr)
     {
       auto* next = list->next_;
-      list->awaiter_.resume();
+      details::ResumeIsolated(list->awaiter_);
       list = next;
     }
   }
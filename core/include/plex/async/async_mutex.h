@@ -0,0 +1,308 @@
+#ifndef PLEX_ASYNC_ASYNC_MUTEX_H
+#define PLEX_ASYNC_ASYNC_MUTEX_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "plex/async/awaitable.h"
+#include "plex/async/thread_pool.h"
+#include "plex/debug/assertion.h"
+
+namespace plex
+{
+///
+/// Unlocks an async mutex when destroyed.
+///
+/// @tparam Mutex Mutex type.
+///
+template<typename Mutex>
+class AsyncLockGuard
+{
+public:
+  ///
+  /// Constructor. Adopts a mutex that is already locked.
+  ///
+  /// @param[in] mutex Locked mutex.
+  ///
+  explicit AsyncLockGuard(Mutex& mutex) noexcept : mutex_(&mutex) {}
+
+  ///
+  /// Move constructor.
+  ///
+  /// @param[in] other Guard to move.
+  ///
+  AsyncLockGuard(AsyncLockGuard&& other) noexcept : mutex_(other.mutex_)
+  {
+    other.mutex_ = nullptr;
+  }
+
+  AsyncLockGuard(const AsyncLockGuard&) = delete;
+  AsyncLockGuard& operator=(const AsyncLockGuard&) = delete;
+  AsyncLockGuard& operator=(AsyncLockGuard&&) = delete;
+
+  ///
+  /// Destructor. Unlocks the mutex.
+  ///
+  ~AsyncLockGuard()
+  {
+    if (mutex_ != nullptr) mutex_->Unlock();
+  }
+
+private:
+  Mutex* mutex_;
+};
+
+///
+/// Mutual exclusion primitive for coroutines.
+///
+/// Awaiting the lock never blocks a thread. When the mutex is locked, the awaiting coroutine is suspended and added to
+/// a list of waiters. Unlocking hands the mutex over to the oldest waiter, which is resumed on the thread pool.
+///
+/// Locking and unlocking are lock-free, and uncontended they are a single compare and swap.
+///
+/// @code
+/// {
+///   auto guard = co_await mutex.ScopedLock();
+///
+///   // Access the protected resource
+/// }
+/// @endcode
+///
+class AsyncMutex
+{
+public:
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] pool Thread pool waiters are resumed on.
+  ///
+  explicit AsyncMutex(ThreadPool& pool) noexcept : pool_(pool), state_(cNotLocked), waiters_(nullptr) {}
+
+#ifndef NDEBUG
+  ///
+  /// Destructor.
+  ///
+  ~AsyncMutex() noexcept
+  {
+    ASSERT(state_.load(std::memory_order_relaxed) == cNotLocked, "The mutex was destroyed while locked");
+  }
+#endif
+
+  AsyncMutex(const AsyncMutex&) = delete;
+  AsyncMutex& operator=(const AsyncMutex&) = delete;
+
+  ///
+  /// Tries to lock the mutex without waiting.
+  ///
+  /// @return True if the mutex was locked, false if it is already locked.
+  ///
+  bool TryLock() noexcept
+  {
+    uintptr_t expected = cNotLocked;
+
+    return state_.compare_exchange_strong(
+      expected, cLockedNoWaiters, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex.
+  ///
+  /// @warning The mutex must be unlocked manually, prefer using ScopedLock.
+  ///
+  /// @return Lock awaitable.
+  ///
+  auto Lock() noexcept
+  {
+    return LockOperation { *this };
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex and results in a guard that unlocks it.
+  ///
+  /// @return Scoped lock awaitable.
+  ///
+  auto ScopedLock() noexcept
+  {
+    return ScopedLockOperation { *this };
+  }
+
+  ///
+  /// Unlocks the mutex. If there are waiters, the mutex is handed over to the oldest one.
+  ///
+  /// @warning The mutex must be locked.
+  ///
+  void Unlock()
+  {
+    ASSERT(state_.load(std::memory_order_relaxed) != cNotLocked, "The mutex is not locked");
+
+    LockOperation* waiter = waiters_;
+
+    if (waiter == nullptr)
+    {
+      uintptr_t expected = cLockedNoWaiters;
+
+      // Needs release so that the writes done while locked are visible to the next locker.
+      if (state_.compare_exchange_strong(expected, cNotLocked, std::memory_order_release, std::memory_order_relaxed))
+      {
+        return;
+      }
+
+      // New waiters arrived. They are stacked, reverse them so that the oldest comes first.
+      // Needs acquire to see the waiters.
+      uintptr_t stack = state_.exchange(cLockedNoWaiters, std::memory_order_acquire);
+
+      ASSERT(stack != cNotLocked && stack != cLockedNoWaiters, "There must be waiters");
+
+      auto operation = reinterpret_cast<LockOperation*>(stack);
+
+      do
+      {
+        LockOperation* next = operation->next_;
+        operation->next_ = waiter;
+        waiter = operation;
+        operation = next;
+      }
+      while (operation != nullptr);
+    }
+
+    // The mutex stays locked, it now belongs to the waiter.
+    waiters_ = waiter->next_;
+
+    waiter->Resume();
+  }
+
+  ///
+  /// Returns whether or not the mutex is locked.
+  ///
+  /// @note Only a snapshot, the mutex can be locked or unlocked right after.
+  ///
+  /// @return True if the mutex is locked, false otherwise.
+  ///
+  [[nodiscard]] bool IsLockedApprox() const noexcept
+  {
+    return state_.load(std::memory_order_relaxed) != cNotLocked;
+  }
+
+private:
+  ///
+  /// Represents a lock operation. Serves as both node in a list and the awaitable of the lock operation.
+  ///
+  class LockOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] mutex Mutex to lock.
+    ///
+    explicit LockOperation(AsyncMutex& mutex) noexcept
+      : mutex_(mutex), next_(nullptr), schedule_(mutex.pool_.Schedule())
+    {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if the mutex was locked without waiting.
+    ///
+    bool await_ready() const noexcept
+    {
+      return mutex_.TryLock();
+    }
+
+    ///
+    /// Called after suspension. Attempts to lock the mutex one last time, otherwise pushes the operation to the front
+    /// of the waiters stack contained as the mutex state.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if the mutex was locked, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      awaiter_ = awaiter;
+
+      uintptr_t state = mutex_.state_.load(std::memory_order_relaxed);
+
+      for (;;)
+      {
+        if (state == cNotLocked)
+        {
+          if (mutex_.state_.compare_exchange_weak(
+                state, cLockedNoWaiters, std::memory_order_acquire, std::memory_order_relaxed))
+          {
+            return false;
+          }
+        }
+        else
+        {
+          next_ = state == cLockedNoWaiters ? nullptr : reinterpret_cast<LockOperation*>(state);
+
+          // Needs release so that the unlocker sees the operation.
+          if (mutex_.state_.compare_exchange_weak(
+                state, reinterpret_cast<uintptr_t>(this), std::memory_order_release, std::memory_order_relaxed))
+          {
+            return true;
+          }
+        }
+      }
+    }
+
+    ///
+    /// Does nothing.
+    ///
+    void await_resume() const noexcept {}
+
+  protected:
+    AsyncMutex& mutex_;
+
+  private:
+    friend class AsyncMutex;
+
+    ///
+    /// Resumes the waiting coroutine on the thread pool.
+    ///
+    void Resume() noexcept
+    {
+      schedule_.await_suspend(awaiter_);
+    }
+
+  private:
+    LockOperation* next_;
+    std::coroutine_handle<> awaiter_;
+
+    ThreadPool::ScheduleAwaiter schedule_;
+  };
+
+  ///
+  /// Lock operation that results in a lock guard.
+  ///
+  class ScopedLockOperation : public LockOperation
+  {
+  public:
+    using LockOperation::LockOperation;
+
+    ///
+    /// Returns a guard that owns the lock.
+    ///
+    /// @return Lock guard.
+    ///
+    [[nodiscard]] AsyncLockGuard<AsyncMutex> await_resume() const noexcept
+    {
+      return AsyncLockGuard<AsyncMutex> { mutex_ };
+    }
+  };
+
+private:
+  // Any other state is a pointer to the stack of newest waiters.
+  static constexpr uintptr_t cNotLocked = 1;
+  static constexpr uintptr_t cLockedNoWaiters = 0;
+
+  ThreadPool& pool_;
+
+  std::atomic<uintptr_t> state_;
+
+  LockOperation* waiters_; // Oldest waiters in order, only accessed by the owner of the lock
+};
+} // namespace plex
+
+#endif
@@ -0,0 +1,575 @@
+#ifndef PLEX_ASYNC_ASYNC_SEMAPHORE_H
+#define PLEX_ASYNC_ASYNC_SEMAPHORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "plex/async/awaitable.h"
+#include "plex/async/cancellation.h"
+#include "plex/async/exponential_backoff.h"
+#include "plex/async/thread_pool.h"
+#include "plex/debug/assertion.h"
+
+namespace plex
+{
+///
+/// Counting semaphore for coroutines.
+///
+/// The semaphore holds a given amount of permits. Awaiting an acquire takes a permit, or suspends the awaiting
+/// coroutine until one is released. Releasing hands the permit directly to a waiter, which is resumed on the thread
+/// pool.
+///
+/// Acquiring and releasing are lock-free. Waiters are not guaranteed to be resumed in the order they arrived.
+///
+/// Acquires can be given a cancellation token. A cancelled waiter is resumed without a permit by whoever unlinks it
+/// from the waiters, the thread requesting cancellation waits for that to happen.
+///
+class AsyncSemaphore
+{
+public:
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] pool Thread pool waiters are resumed on.
+  /// @param[in] permits Amount of permits initially available.
+  ///
+  AsyncSemaphore(ThreadPool& pool, size_t permits) noexcept : pool_(pool), state_(PermitsState(permits)) {}
+
+#ifndef NDEBUG
+  ///
+  /// Destructor.
+  ///
+  ~AsyncSemaphore() noexcept
+  {
+    ASSERT(IsPermits(state_.load(std::memory_order_relaxed)), "The semaphore was destroyed with waiters");
+  }
+#endif
+
+  AsyncSemaphore(const AsyncSemaphore&) = delete;
+  AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+  ///
+  /// Tries to take a permit without waiting.
+  ///
+  /// @return True if a permit was taken, false if none are available.
+  ///
+  bool TryAcquire() noexcept
+  {
+    uintptr_t state = state_.load(std::memory_order_relaxed);
+
+    while (IsPermits(state) && Permits(state) != 0)
+    {
+      // Needs acquire to see the writes done before the permit was released.
+      if (state_.compare_exchange_weak(state, state - cOnePermit, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  ///
+  /// Returns an awaitable that takes a permit.
+  ///
+  /// @return Acquire awaitable.
+  ///
+  auto Acquire() noexcept
+  {
+    return AcquireOperation { *this };
+  }
+
+  ///
+  /// Returns an awaitable that takes a permit, unless cancellation is requested first.
+  ///
+  /// The awaitable results in true if a permit was taken, false if cancelled.
+  ///
+  /// @param[in] token Token to stop waiting on.
+  ///
+  /// @return Cancellable acquire awaitable.
+  ///
+  auto Acquire(CancellationToken token) noexcept
+  {
+    return CancellableAcquireOperation { *this, std::move(token) };
+  }
+
+  ///
+  /// Releases permits. Every released permit is handed to a waiter if there are any.
+  ///
+  /// @param[in] amount Amount of permits to release.
+  ///
+  void Release(size_t amount = 1)
+  {
+    HandOver(nullptr, amount);
+  }
+
+  ///
+  /// Returns the amount of permits available.
+  ///
+  /// @note Only a snapshot, permits can be acquired or released right after.
+  ///
+  /// @return Amount of available permits.
+  ///
+  [[nodiscard]] size_t AvailableApprox() const noexcept
+  {
+    const uintptr_t state = state_.load(std::memory_order_relaxed);
+
+    return IsPermits(state) ? Permits(state) : 0;
+  }
+
+private:
+  ///
+  /// Represents an acquire operation. Serves as both node in a list and the awaitable of the acquire operation.
+  ///
+  class AcquireOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] semaphore Semaphore to acquire from.
+    ///
+    explicit AcquireOperation(AsyncSemaphore& semaphore) noexcept : AcquireOperation(semaphore, cWaiting) {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if a permit was taken without waiting.
+    ///
+    bool await_ready() const noexcept
+    {
+      return semaphore_.TryAcquire();
+    }
+
+    ///
+    /// Called after suspension. Attempts to take a permit one last time, otherwise waits for one.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if a permit was taken, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      awaiter_ = awaiter;
+
+      return TakeOrWait();
+    }
+
+    ///
+    /// Does nothing.
+    ///
+    void await_resume() const noexcept {}
+
+  protected:
+    // Status of the operation. Only cancellable operations ever leave the waiting status before being granted.
+    static constexpr uint32_t cIdle = 0; // Not waiting yet
+    static constexpr uint32_t cWaiting = 1;
+    static constexpr uint32_t cAcquired = 2;
+    static constexpr uint32_t cCancelled = 3; // Still in the waiters
+    static constexpr uint32_t cRemoved = 4; // Cancelled and unlinked from the waiters
+
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] semaphore Semaphore to acquire from.
+    /// @param[in] status Initial status.
+    ///
+    AcquireOperation(AsyncSemaphore& semaphore, uint32_t status) noexcept
+      : semaphore_(semaphore), next_(nullptr), status_(status), schedule_(semaphore.pool_.Schedule())
+    {}
+
+    ///
+    /// Attempts to take a permit, otherwise pushes the operation to the front of the waiters stack contained as the
+    /// semaphore state.
+    ///
+    /// @return False if a permit was taken, true if the operation waits.
+    ///
+    bool TakeOrWait() noexcept
+    {
+      std::atomic<uintptr_t>& state = semaphore_.state_;
+
+      uintptr_t old_state = state.load(std::memory_order_relaxed);
+
+      for (;;)
+      {
+        if (IsPermits(old_state) && Permits(old_state) != 0)
+        {
+          if (state.compare_exchange_weak(
+                old_state, old_state - cOnePermit, std::memory_order_acquire, std::memory_order_relaxed))
+          {
+            return false;
+          }
+        }
+        else
+        {
+          next_ = IsPermits(old_state) ? nullptr : reinterpret_cast<AcquireOperation*>(old_state);
+
+          // Needs release so that the releaser sees the operation.
+          if (state.compare_exchange_weak(
+                old_state, reinterpret_cast<uintptr_t>(this), std::memory_order_release, std::memory_order_relaxed))
+          {
+            return true;
+          }
+        }
+      }
+    }
+
+  private:
+    friend class AsyncSemaphore;
+
+    ///
+    /// Grants a permit to the waiting operation.
+    ///
+    /// @return True if granted, false if the operation was cancelled.
+    ///
+    bool Grant() noexcept
+    {
+      uint32_t expected = cWaiting;
+
+      return status_.compare_exchange_strong(expected, cAcquired, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    ///
+    /// Resumes the waiting coroutine on the thread pool.
+    ///
+    void Resume() noexcept
+    {
+      schedule_.await_suspend(awaiter_);
+    }
+
+    ///
+    /// Resumes the coroutine of a cancelled operation that was unlinked from the waiters.
+    ///
+    void ResumeCancelled() noexcept
+    {
+      // Lets the cancelling thread return. The operation stays alive until we resume the coroutine.
+      status_.store(cRemoved, std::memory_order_release);
+
+      Resume();
+    }
+
+  protected:
+    AsyncSemaphore& semaphore_;
+
+    AcquireOperation* next_;
+    std::coroutine_handle<> awaiter_;
+
+    std::atomic<uint32_t> status_;
+
+    ThreadPool::ScheduleAwaiter schedule_;
+  };
+
+  ///
+  /// Acquire operation that stops waiting when cancellation is requested. Results in true if a permit was taken.
+  ///
+  class CancellableAcquireOperation : public AcquireOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] semaphore Semaphore to acquire from.
+    /// @param[in] token Token to stop waiting on.
+    ///
+    CancellableAcquireOperation(AsyncSemaphore& semaphore, CancellationToken&& token) noexcept
+      : AcquireOperation(semaphore, cIdle), token_(std::move(token))
+    {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if already cancelled or if a permit was taken without waiting.
+    ///
+    bool await_ready() noexcept
+    {
+      if (token_.IsCancellationRequested()) status_.store(cRemoved, std::memory_order_relaxed);
+      else if (semaphore_.TryAcquire()) status_.store(cAcquired, std::memory_order_relaxed);
+
+      return status_.load(std::memory_order_relaxed) != cIdle;
+    }
+
+    ///
+    /// Called after suspension. Registers for cancellation, then attempts to take a permit one last time, otherwise
+    /// waits for one.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if a permit was taken or if cancelled, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      awaiter_ = awaiter;
+
+      // Registered before waiting so that no cancellation is missed, it can run right away.
+      if (token_.CanBeCancelled()) callback_.emplace(token_, Canceller { this });
+
+      uint32_t expected = cIdle;
+
+      if (!status_.compare_exchange_strong(expected, cWaiting, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        status_.store(cRemoved, std::memory_order_relaxed); // Cancelled before waiting
+        return false;
+      }
+
+      if (TakeOrWait()) return true;
+
+      expected = cWaiting;
+
+      // Cancelled while taking the permit, give it back for the other waiters.
+      if (!status_.compare_exchange_strong(expected, cAcquired, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        semaphore_.Release();
+        status_.store(cRemoved, std::memory_order_release);
+      }
+
+      return false;
+    }
+
+    ///
+    /// Returns whether or not a permit was taken.
+    ///
+    /// @return True if a permit was taken, false if cancelled.
+    ///
+    bool await_resume() const noexcept
+    {
+      return status_.load(std::memory_order_acquire) == cAcquired;
+    }
+
+  private:
+    ///
+    /// Invoked when cancellation is requested.
+    ///
+    struct Canceller
+    {
+      void operator()() const noexcept
+      {
+        operation->Cancel();
+      }
+
+      CancellableAcquireOperation* operation;
+    };
+
+    ///
+    /// Marks the operation as cancelled and waits until it is unlinked from the waiters and resumed.
+    ///
+    /// Destroying the callback waits for this to return, so the operation stays alive meanwhile.
+    ///
+    void Cancel() noexcept
+    {
+      uint32_t status = status_.load(std::memory_order_relaxed);
+
+      do
+      {
+        // Already granted, or not waiting yet in which case the awaiting side notices.
+        if (status != cIdle && status != cWaiting) return;
+      }
+      while (!status_.compare_exchange_weak(status, cCancelled, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+      if (status == cIdle) return;
+
+      // The operation can be held for a short time by a release that took the waiters out of the state.
+      ExponentialBackoff backoff;
+
+      while (status_.load(std::memory_order_acquire) != cRemoved)
+      {
+        semaphore_.Purge();
+
+        if (status_.load(std::memory_order_acquire) != cRemoved) backoff.Wait();
+      }
+    }
+
+  private:
+    CancellationToken token_;
+    std::optional<CancellationCallback<Canceller>> callback_;
+  };
+
+  ///
+  /// Hands permits over to waiters, keeping the permits left and giving the waiters left back.
+  ///
+  /// @param[in] waiters Waiters taken out of the state, owned by this call.
+  /// @param[in] amount Amount of permits to hand over.
+  ///
+  void HandOver(AcquireOperation* waiters, size_t amount)
+  {
+    uintptr_t state = state_.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+      // Hand our permits over to our waiters. Cancelled waiters are resumed without taking one.
+      while (waiters != nullptr && amount != 0)
+      {
+        AcquireOperation* next = waiters->next_;
+
+        if (waiters->Grant())
+        {
+          waiters->Resume();
+          amount--;
+        }
+        else
+        {
+          waiters->ResumeCancelled();
+        }
+
+        waiters = next;
+      }
+
+      if (waiters == nullptr && amount == 0) return;
+
+      if (IsPermits(state))
+      {
+        if (waiters == nullptr)
+        {
+          // Nobody is waiting, keep the permits.
+          if (state_.compare_exchange_weak(
+                state, state + amount * cOnePermit, std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            return;
+          }
+        }
+        else if (Permits(state) != 0)
+        {
+          // Permits were released in the meantime, take them for our waiters.
+          if (state_.compare_exchange_weak(state, cNoPermits, std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            amount = Permits(state);
+            state = cNoPermits;
+          }
+        }
+        else
+        {
+          // We are out of permits, give the waiters back.
+          Tail(waiters)->next_ = nullptr;
+
+          if (state_.compare_exchange_weak(
+                state, reinterpret_cast<uintptr_t>(waiters), std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            return;
+          }
+        }
+      }
+      else if (amount != 0)
+      {
+        // Take every waiter, we now own them.
+        if (state_.compare_exchange_weak(state, cNoPermits, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+          waiters = reinterpret_cast<AcquireOperation*>(state);
+          state = cNoPermits;
+        }
+      }
+      else
+      {
+        // We are out of permits, give the waiters back in front of the new ones.
+        Tail(waiters)->next_ = reinterpret_cast<AcquireOperation*>(state);
+
+        if (state_.compare_exchange_weak(
+              state, reinterpret_cast<uintptr_t>(waiters), std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+          return;
+        }
+      }
+    }
+  }
+
+  ///
+  /// Takes the waiters out of the state, resumes the cancelled ones and gives the others back.
+  ///
+  void Purge()
+  {
+    uintptr_t state = state_.load(std::memory_order_relaxed);
+
+    do
+    {
+      if (IsPermits(state)) return; // Nobody is waiting, or a release took the waiters
+    }
+    while (!state_.compare_exchange_weak(state, cNoPermits, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    AcquireOperation* waiters = reinterpret_cast<AcquireOperation*>(state);
+    AcquireOperation* kept = nullptr;
+    AcquireOperation** link = &kept;
+
+    while (waiters != nullptr)
+    {
+      AcquireOperation* next = waiters->next_;
+
+      if (waiters->status_.load(std::memory_order_acquire) == AcquireOperation::cCancelled) waiters->ResumeCancelled();
+      else
+      {
+        *link = waiters;
+        link = &waiters->next_;
+      }
+
+      waiters = next;
+    }
+
+    *link = nullptr;
+
+    if (kept != nullptr) HandOver(kept, 0);
+  }
+
+  ///
+  /// Returns whether or not the state holds permits, otherwise it is a pointer to the waiters.
+  ///
+  /// @param[in] state State to check.
+  ///
+  /// @return True if the state holds permits.
+  ///
+  static constexpr bool IsPermits(uintptr_t state) noexcept
+  {
+    return state & 1;
+  }
+
+  ///
+  /// Returns the amount of permits of a state holding permits.
+  ///
+  /// @param[in] state State holding permits.
+  ///
+  /// @return Amount of permits.
+  ///
+  static constexpr size_t Permits(uintptr_t state) noexcept
+  {
+    return state >> 1;
+  }
+
+  ///
+  /// Returns the state holding an amount of permits.
+  ///
+  /// @param[in] permits Amount of permits.
+  ///
+  /// @return State holding the permits.
+  ///
+  static constexpr uintptr_t PermitsState(size_t permits) noexcept
+  {
+    return (permits << 1) | 1;
+  }
+
+  ///
+  /// Returns the last operation of a list.
+  ///
+  /// @param[in] list List of operations.
+  ///
+  /// @return Last operation.
+  ///
+  static AcquireOperation* Tail(AcquireOperation* list) noexcept
+  {
+    while (list->next_ != nullptr)
+    {
+      list = list->next_;
+    }
+
+    return list;
+  }
+
+private:
+  // States tagged with the lowest bit hold the amount of permits. Any other state is a pointer to the stack of
+  // waiters, when there are no permits.
+  static constexpr uintptr_t cNoPermits = 1;
+  static constexpr uintptr_t cOnePermit = 2;
+
+  ThreadPool& pool_;
+
+  std::atomic<uintptr_t> state_;
+};
+} // namespace plex
+
+#endif
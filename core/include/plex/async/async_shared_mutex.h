@@ -0,0 +1,461 @@
+#ifndef PLEX_ASYNC_ASYNC_SHARED_MUTEX_H
+#define PLEX_ASYNC_ASYNC_SHARED_MUTEX_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "plex/async/async_mutex.h"
+#include "plex/async/awaitable.h"
+#include "plex/async/exponential_backoff.h"
+#include "plex/async/thread_pool.h"
+#include "plex/debug/assertion.h"
+
+namespace plex
+{
+///
+/// Unlocks the shared ownership of an async shared mutex when destroyed.
+///
+/// @tparam Mutex Mutex type.
+///
+template<typename Mutex>
+class AsyncSharedLockGuard
+{
+public:
+  ///
+  /// Constructor. Adopts a mutex that is already locked shared.
+  ///
+  /// @param[in] mutex Mutex locked shared.
+  ///
+  explicit AsyncSharedLockGuard(Mutex& mutex) noexcept : mutex_(&mutex) {}
+
+  ///
+  /// Move constructor.
+  ///
+  /// @param[in] other Guard to move.
+  ///
+  AsyncSharedLockGuard(AsyncSharedLockGuard&& other) noexcept : mutex_(other.mutex_)
+  {
+    other.mutex_ = nullptr;
+  }
+
+  AsyncSharedLockGuard(const AsyncSharedLockGuard&) = delete;
+  AsyncSharedLockGuard& operator=(const AsyncSharedLockGuard&) = delete;
+  AsyncSharedLockGuard& operator=(AsyncSharedLockGuard&&) = delete;
+
+  ///
+  /// Destructor. Unlocks the shared ownership of the mutex.
+  ///
+  ~AsyncSharedLockGuard()
+  {
+    if (mutex_ != nullptr) mutex_->UnlockShared();
+  }
+
+private:
+  Mutex* mutex_;
+};
+
+///
+/// Reader-writer mutex for coroutines.
+///
+/// The mutex is either locked exclusively by a single writer, or shared by any amount of readers. Awaiting the lock
+/// never blocks a thread. When the lock cannot be taken, the awaiting coroutine is suspended and added to a queue of
+/// waiters. Waiters are granted the lock in the order they arrived: a writer alone, or every consecutive reader at the
+/// front of the queue together. Granted waiters are resumed on the thread pool.
+///
+/// Once a writer waits, new readers wait behind it, so writers are never starved by a steady stream of readers.
+///
+/// Uncontended locking and unlocking is a single compare and swap. The queue of waiters is guarded by a small spin lock
+/// that is never held while resuming waiters.
+///
+class AsyncSharedMutex
+{
+public:
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] pool Thread pool waiters are resumed on.
+  ///
+  explicit AsyncSharedMutex(ThreadPool& pool) noexcept
+    : pool_(pool), state_(cNotLocked), head_(nullptr), tail_(nullptr)
+  {}
+
+#ifndef NDEBUG
+  ///
+  /// Destructor.
+  ///
+  ~AsyncSharedMutex() noexcept
+  {
+    ASSERT(state_.load(std::memory_order_relaxed) == cNotLocked, "The mutex was destroyed while locked");
+  }
+#endif
+
+  AsyncSharedMutex(const AsyncSharedMutex&) = delete;
+  AsyncSharedMutex& operator=(const AsyncSharedMutex&) = delete;
+
+  ///
+  /// Tries to lock the mutex exclusively without waiting.
+  ///
+  /// @return True if the mutex was locked, false otherwise.
+  ///
+  bool TryLock() noexcept
+  {
+    uint64_t expected = cNotLocked;
+
+    return state_.compare_exchange_strong(expected, cWriter, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Tries to lock the mutex shared without waiting.
+  ///
+  /// Fails when a writer owns or waits for the mutex.
+  ///
+  /// @return True if the mutex was locked shared, false otherwise.
+  ///
+  bool TryLockShared() noexcept
+  {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+
+    while (!(state & (cWriter | cWaiters)))
+    {
+      if (state_.compare_exchange_weak(state, state + cReader, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex exclusively.
+  ///
+  /// @warning The mutex must be unlocked manually, prefer using ScopedLock.
+  ///
+  /// @return Lock awaitable.
+  ///
+  auto Lock() noexcept
+  {
+    return LockOperation { *this, true };
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex shared.
+  ///
+  /// @warning The mutex must be unlocked manually, prefer using ScopedLockShared.
+  ///
+  /// @return Shared lock awaitable.
+  ///
+  auto LockShared() noexcept
+  {
+    return LockOperation { *this, false };
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex exclusively and results in a guard that unlocks it.
+  ///
+  /// @return Scoped lock awaitable.
+  ///
+  auto ScopedLock() noexcept
+  {
+    return ScopedLockOperation { *this };
+  }
+
+  ///
+  /// Returns an awaitable that locks the mutex shared and results in a guard that unlocks it.
+  ///
+  /// @return Scoped shared lock awaitable.
+  ///
+  auto ScopedLockShared() noexcept
+  {
+    return ScopedLockSharedOperation { *this };
+  }
+
+  ///
+  /// Unlocks the exclusive ownership of the mutex. If there are waiters, the mutex is handed over to them.
+  ///
+  /// @warning The mutex must be locked exclusively.
+  ///
+  void Unlock()
+  {
+    uint64_t expected = cWriter;
+
+    // Needs release so that the writes done while locked are visible to the next locker.
+    if (state_.compare_exchange_strong(expected, cNotLocked, std::memory_order_release, std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    ASSERT(expected == (cWriter | cWaiters), "The mutex is not locked exclusively");
+
+    HandOver();
+  }
+
+  ///
+  /// Unlocks a shared ownership of the mutex. If this was the last reader and there are waiters, the mutex is handed
+  /// over to them.
+  ///
+  /// @warning The mutex must be locked shared.
+  ///
+  void UnlockShared()
+  {
+    // Needs release so that the reads done while locked happen before the next writer.
+    const uint64_t state = state_.fetch_sub(cReader, std::memory_order_release) - cReader;
+
+    ASSERT(!(state & cWriter), "The mutex is not locked shared");
+
+    if (state == cWaiters) HandOver();
+  }
+
+  ///
+  /// Returns whether or not the mutex is locked, exclusively or shared.
+  ///
+  /// @note Only a snapshot, the mutex can be locked or unlocked right after.
+  ///
+  /// @return True if the mutex is locked, false otherwise.
+  ///
+  [[nodiscard]] bool IsLockedApprox() const noexcept
+  {
+    return (state_.load(std::memory_order_relaxed) & ~cWaiters) != cNotLocked;
+  }
+
+private:
+  ///
+  /// Represents a lock operation. Serves as both node in the queue and the awaitable of the lock operation.
+  ///
+  class LockOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] mutex Mutex to lock.
+    /// @param[in] exclusive Whether or not to lock exclusively, otherwise shared.
+    ///
+    LockOperation(AsyncSharedMutex& mutex, bool exclusive) noexcept
+      : mutex_(mutex), next_(nullptr), exclusive_(exclusive), schedule_(mutex.pool_.Schedule())
+    {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if the mutex was locked without waiting.
+    ///
+    bool await_ready() const noexcept
+    {
+      return exclusive_ ? mutex_.TryLock() : mutex_.TryLockShared();
+    }
+
+    ///
+    /// Called after suspension. Attempts to lock the mutex one last time, otherwise marks the mutex as having waiters
+    /// and appends the operation to the back of the queue.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if the mutex was locked, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      awaiter_ = awaiter;
+
+      mutex_.LockQueue();
+
+      uint64_t state = mutex_.state_.load(std::memory_order_relaxed);
+
+      for (;;)
+      {
+        const bool available = exclusive_ ? state == cNotLocked : !(state & (cWriter | cWaiters));
+
+        if (available)
+        {
+          if (mutex_.state_.compare_exchange_weak(
+                state, exclusive_ ? cWriter : state + cReader, std::memory_order_acquire, std::memory_order_relaxed))
+          {
+            mutex_.UnlockQueue();
+
+            return false;
+          }
+        }
+        else if (mutex_.state_.compare_exchange_weak(
+                   state, state | cWaiters, std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+
+      if (mutex_.tail_ != nullptr) mutex_.tail_->next_ = this;
+      else mutex_.head_ = this;
+
+      mutex_.tail_ = this;
+
+      mutex_.UnlockQueue();
+
+      return true;
+    }
+
+    ///
+    /// Does nothing.
+    ///
+    void await_resume() const noexcept {}
+
+  protected:
+    AsyncSharedMutex& mutex_;
+
+  private:
+    friend class AsyncSharedMutex;
+
+    ///
+    /// Resumes the waiting coroutine on the thread pool.
+    ///
+    void Resume() noexcept
+    {
+      schedule_.await_suspend(awaiter_);
+    }
+
+  private:
+    LockOperation* next_;
+    std::coroutine_handle<> awaiter_;
+
+    bool exclusive_;
+
+    ThreadPool::ScheduleAwaiter schedule_;
+  };
+
+  ///
+  /// Exclusive lock operation that results in a lock guard.
+  ///
+  class ScopedLockOperation : public LockOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] mutex Mutex to lock.
+    ///
+    explicit ScopedLockOperation(AsyncSharedMutex& mutex) noexcept : LockOperation(mutex, true) {}
+
+    ///
+    /// Returns a guard that owns the lock.
+    ///
+    /// @return Lock guard.
+    ///
+    [[nodiscard]] AsyncLockGuard<AsyncSharedMutex> await_resume() const noexcept
+    {
+      return AsyncLockGuard<AsyncSharedMutex> { mutex_ };
+    }
+  };
+
+  ///
+  /// Shared lock operation that results in a shared lock guard.
+  ///
+  class ScopedLockSharedOperation : public LockOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] mutex Mutex to lock.
+    ///
+    explicit ScopedLockSharedOperation(AsyncSharedMutex& mutex) noexcept : LockOperation(mutex, false) {}
+
+    ///
+    /// Returns a guard that owns the shared lock.
+    ///
+    /// @return Shared lock guard.
+    ///
+    [[nodiscard]] AsyncSharedLockGuard<AsyncSharedMutex> await_resume() const noexcept
+    {
+      return AsyncSharedLockGuard<AsyncSharedMutex> { mutex_ };
+    }
+  };
+
+  ///
+  /// Hands the mutex over to the waiters at the front of the queue: either a single writer, or every consecutive
+  /// reader.
+  ///
+  /// Must be called by the last owner of the mutex while the waiters bit is set. The waiters bit prevents anyone from
+  /// locking the mutex without going through the queue, so the state cannot change until it is handed over.
+  ///
+  void HandOver()
+  {
+    LockQueue();
+
+    LockOperation* granted = head_;
+    LockOperation* last = granted;
+
+    uint64_t state;
+
+    if (granted->exclusive_) state = cWriter;
+    else
+    {
+      state = cReader;
+
+      while (last->next_ != nullptr && !last->next_->exclusive_)
+      {
+        last = last->next_;
+        state += cReader;
+      }
+    }
+
+    head_ = last->next_;
+    last->next_ = nullptr;
+
+    if (head_ == nullptr) tail_ = nullptr;
+    else state |= cWaiters;
+
+    // Needs acquire to see the writes done by the previous owners, they are published to the granted waiters when
+    // they are scheduled.
+    state_.exchange(state, std::memory_order_acq_rel);
+
+    UnlockQueue();
+
+    do
+    {
+      LockOperation* next = granted->next_;
+      granted->Resume();
+      granted = next;
+    }
+    while (granted != nullptr);
+  }
+
+  ///
+  /// Locks the queue of waiters.
+  ///
+  void LockQueue() noexcept
+  {
+    ExponentialBackoff backoff;
+
+    while (queue_lock_.test_and_set(std::memory_order_acquire))
+    {
+      backoff.Wait();
+    }
+  }
+
+  ///
+  /// Unlocks the queue of waiters.
+  ///
+  void UnlockQueue() noexcept
+  {
+    queue_lock_.clear(std::memory_order_release);
+  }
+
+private:
+  // The state holds the amount of readers and two flags, whether or not a writer owns the mutex and whether or not
+  // the queue has waiters.
+  static constexpr uint64_t cNotLocked = 0;
+  static constexpr uint64_t cWriter = 1;
+  static constexpr uint64_t cWaiters = 2;
+  static constexpr uint64_t cReader = 4;
+
+  ThreadPool& pool_;
+
+  std::atomic<uint64_t> state_;
+
+  std::atomic_flag queue_lock_;
+
+  // Waiters in order of arrival, guarded by the queue lock.
+  LockOperation* head_;
+  LockOperation* tail_;
+};
+} // namespace plex
+
+#endif
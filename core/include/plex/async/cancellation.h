@@ -0,0 +1,139 @@
+#ifndef PLEX_ASYNC_CANCELLATION_H
+#define PLEX_ASYNC_CANCELLATION_H
+
+#include <stop_token>
+#include <utility>
+
+namespace plex
+{
+///
+/// Observes whether or not cancellation was requested on a cancellation source.
+///
+/// Cancellation is cooperative: coroutines that accept a token check it at convenient points and stop early, while
+/// waiting operations that accept a token, like timers, complete early when cancellation is requested.
+///
+/// Tokens are cheap to copy. A default constructed token is never cancelled.
+///
+class CancellationToken
+{
+public:
+  ///
+  /// Default constructor. The token can never be cancelled.
+  ///
+  CancellationToken() noexcept = default;
+
+  ///
+  /// Returns whether or not cancellation was requested.
+  ///
+  /// @return True if cancellation was requested.
+  ///
+  [[nodiscard]] bool IsCancellationRequested() const noexcept
+  {
+    return token_.stop_requested();
+  }
+
+  ///
+  /// Returns whether or not cancellation can ever be requested, allowing to skip registering callbacks.
+  ///
+  /// @return True if the token can be cancelled.
+  ///
+  [[nodiscard]] bool CanBeCancelled() const noexcept
+  {
+    return token_.stop_possible();
+  }
+
+private:
+  friend class CancellationSource;
+
+  template<typename Callback>
+  friend class CancellationCallback;
+
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] token Underlying stop token.
+  ///
+  explicit CancellationToken(std::stop_token token) noexcept : token_(std::move(token)) {}
+
+private:
+  std::stop_token token_;
+};
+
+///
+/// Requests cancellation to every token it handed out.
+///
+/// Copies of a source share the same state, any of them can request cancellation.
+///
+class CancellationSource
+{
+public:
+  ///
+  /// Default constructor.
+  ///
+  CancellationSource() = default;
+
+  ///
+  /// Returns a token observing this source.
+  ///
+  /// @return Cancellation token.
+  ///
+  [[nodiscard]] CancellationToken Token() const noexcept
+  {
+    return CancellationToken { source_.get_token() };
+  }
+
+  ///
+  /// Requests cancellation. The callbacks registered on the tokens are invoked on the calling thread.
+  ///
+  /// @return True if this call requested cancellation, false if it was already requested.
+  ///
+  bool Cancel() noexcept
+  {
+    return source_.request_stop();
+  }
+
+  ///
+  /// Returns whether or not cancellation was requested.
+  ///
+  /// @return True if cancellation was requested.
+  ///
+  [[nodiscard]] bool IsCancellationRequested() const noexcept
+  {
+    return source_.stop_requested();
+  }
+
+private:
+  std::stop_source source_;
+};
+
+///
+/// Invokes a callback when cancellation is requested on a token, for as long as it is alive.
+///
+/// If cancellation was already requested, the callback is invoked right away by the constructor. Destroying the
+/// registration while the callback is running on another thread waits for the callback to return.
+///
+/// @tparam Callback Callback type.
+///
+template<typename Callback>
+class CancellationCallback
+{
+public:
+  ///
+  /// Constructor. Registers the callback.
+  ///
+  /// @param[in] token Token to observe.
+  /// @param[in] callback Callback to invoke on cancellation.
+  ///
+  CancellationCallback(const CancellationToken& token, Callback callback)
+    : callback_(token.token_, std::move(callback))
+  {}
+
+  CancellationCallback(const CancellationCallback&) = delete;
+  CancellationCallback& operator=(const CancellationCallback&) = delete;
+
+private:
+  std::stop_callback<Callback> callback_;
+};
+} // namespace plex
+
+#endif
@@ -0,0 +1,632 @@
+#ifndef PLEX_ASYNC_CHANNEL_H
+#define PLEX_ASYNC_CHANNEL_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "plex/async/async_semaphore.h"
+#include "plex/async/cancellation.h"
+#include "plex/async/exponential_backoff.h"
+#include "plex/async/thread_pool.h"
+#include "plex/debug/assertion.h"
+#include "plex/os/cpu_info.h"
+
+namespace plex
+{
+///
+/// Amount of coroutines allowed to use each end of a channel.
+///
+enum class ChannelMode
+{
+  /// A single coroutine sends and a single coroutine receives at a time.
+  SingleProducerSingleConsumer,
+
+  /// Any amount of coroutines send and receive concurrently.
+  MultiProducerMultiConsumer
+};
+
+namespace details
+{
+  ///
+  /// Bounded lock-free ring buffer of values.
+  ///
+  /// @tparam Type Type of the values.
+  /// @tparam Mode Amount of producers and consumers.
+  ///
+  template<typename Type, ChannelMode Mode>
+  class ChannelBuffer;
+
+  ///
+  /// Single producer single consumer ring buffer.
+  ///
+  /// Each side only writes its own index and caches the index of the other side, so that the shared cache lines are
+  /// only touched when the buffer looks full or empty.
+  ///
+  /// @tparam Type Type of the values.
+  ///
+  template<typename Type>
+  class ChannelBuffer<Type, ChannelMode::SingleProducerSingleConsumer>
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] capacity Minimum amount of values the buffer can hold.
+    ///
+    explicit ChannelBuffer(size_t capacity)
+      : slots_(std::make_unique<Slot[]>(std::bit_ceil(capacity))), mask_(std::bit_ceil(capacity) - 1), tail_(0),
+        cached_head_(0), head_(0), cached_tail_(0)
+    {}
+
+    ///
+    /// Destructor. Destroys the values left in the buffer.
+    ///
+    ~ChannelBuffer()
+    {
+      while (TryPop()) {}
+    }
+
+    ChannelBuffer(const ChannelBuffer&) = delete;
+    ChannelBuffer& operator=(const ChannelBuffer&) = delete;
+
+    ///
+    /// Pushes a value at the back of the buffer.
+    ///
+    /// @warning Must only be called by the producer.
+    ///
+    /// @param[in] value Value to push.
+    ///
+    /// @return True if the value was pushed, false if the buffer is full.
+    ///
+    bool TryPush(Type& value)
+    {
+      const size_t tail = tail_.load(std::memory_order_relaxed);
+
+      if (tail - cached_head_ > mask_)
+      {
+        // Needs acquire so that the consumer is done with the slot before we overwrite it.
+        cached_head_ = head_.load(std::memory_order_acquire);
+
+        if (tail - cached_head_ > mask_) return false;
+      }
+
+      new (slots_[tail & mask_].storage_) Type(std::move(value));
+
+      // Needs release so that the consumer sees the value.
+      tail_.store(tail + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    ///
+    /// Pops the value at the front of the buffer.
+    ///
+    /// @warning Must only be called by the consumer.
+    ///
+    /// @return Popped value, or nothing if the buffer is empty.
+    ///
+    std::optional<Type> TryPop()
+    {
+      const size_t head = head_.load(std::memory_order_relaxed);
+
+      if (head == cached_tail_)
+      {
+        // Needs acquire to see the value written by the producer.
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+
+        if (head == cached_tail_) return std::nullopt;
+      }
+
+      Type* value = slots_[head & mask_].Get();
+
+      std::optional<Type> result(std::move(*value));
+
+      value->~Type();
+
+      head_.store(head + 1, std::memory_order_release);
+
+      return result;
+    }
+
+  private:
+    ///
+    /// Uninitialized storage for a value.
+    ///
+    struct Slot
+    {
+      Type* Get() noexcept
+      {
+        return std::launder(reinterpret_cast<Type*>(storage_));
+      }
+
+      alignas(Type) char storage_[sizeof(Type)];
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    // Producer side
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t tail_;
+    size_t cached_head_;
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t head_;
+    size_t cached_tail_;
+  };
+
+  ///
+  /// Multi producer multi consumer ring buffer.
+  ///
+  /// Every slot holds a sequence number that tells whether it is ready to be written or read for a given position, so
+  /// that producers and consumers only contend on their own index.
+  ///
+  /// @note Based on Dmitry Vyukov's bounded MPMC queue.
+  ///
+  /// @tparam Type Type of the values.
+  ///
+  template<typename Type>
+  class ChannelBuffer<Type, ChannelMode::MultiProducerMultiConsumer>
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] capacity Minimum amount of values the buffer can hold.
+    ///
+    explicit ChannelBuffer(size_t capacity)
+      : slots_(std::make_unique<Slot[]>(std::bit_ceil(capacity))), mask_(std::bit_ceil(capacity) - 1), tail_(0),
+        head_(0)
+    {
+      for (size_t i = 0; i <= mask_; i++)
+      {
+        slots_[i].sequence_.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ///
+    /// Destructor. Destroys the values left in the buffer.
+    ///
+    ~ChannelBuffer()
+    {
+      while (TryPop()) {}
+    }
+
+    ChannelBuffer(const ChannelBuffer&) = delete;
+    ChannelBuffer& operator=(const ChannelBuffer&) = delete;
+
+    ///
+    /// Pushes a value at the back of the buffer.
+    ///
+    /// @param[in] value Value to push.
+    ///
+    /// @return True if the value was pushed, false if the buffer is full.
+    ///
+    bool TryPush(Type& value)
+    {
+      size_t position = tail_.load(std::memory_order_relaxed);
+
+      Slot* slot;
+
+      for (;;)
+      {
+        slot = &slots_[position & mask_];
+
+        // Needs acquire so that the consumer is done with the slot before we overwrite it.
+        const size_t sequence = slot->sequence_.load(std::memory_order_acquire);
+
+        const auto difference = static_cast<intptr_t>(sequence - position);
+
+        if (difference == 0)
+        {
+          if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        }
+        else if (difference < 0) return false;
+        else position = tail_.load(std::memory_order_relaxed);
+      }
+
+      new (slot->storage_) Type(std::move(value));
+
+      // Needs release so that the consumer sees the value.
+      slot->sequence_.store(position + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    ///
+    /// Pops the value at the front of the buffer.
+    ///
+    /// @return Popped value, or nothing if the buffer is empty.
+    ///
+    std::optional<Type> TryPop()
+    {
+      size_t position = head_.load(std::memory_order_relaxed);
+
+      Slot* slot;
+
+      for (;;)
+      {
+        slot = &slots_[position & mask_];
+
+        // Needs acquire to see the value written by the producer.
+        const size_t sequence = slot->sequence_.load(std::memory_order_acquire);
+
+        const auto difference = static_cast<intptr_t>(sequence - (position + 1));
+
+        if (difference == 0)
+        {
+          if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        }
+        else if (difference < 0) return std::nullopt;
+        else position = head_.load(std::memory_order_relaxed);
+      }
+
+      Type* value = slot->Get();
+
+      std::optional<Type> result(std::move(*value));
+
+      value->~Type();
+
+      // Needs release so that the next producer of the slot writes after we are done.
+      slot->sequence_.store(position + mask_ + 1, std::memory_order_release);
+
+      return result;
+    }
+
+  private:
+    ///
+    /// Uninitialized storage for a value and the sequence of the slot.
+    ///
+    struct Slot
+    {
+      Type* Get() noexcept
+      {
+        return std::launder(reinterpret_cast<Type*>(storage_));
+      }
+
+      std::atomic_size_t sequence_;
+
+      alignas(Type) char storage_[sizeof(Type)];
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t tail_;
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t head_;
+  };
+} // namespace details
+
+///
+/// Bounded channel to stream values between coroutines.
+///
+/// Awaiting a send suspends the coroutine while the channel is full, and awaiting a receive suspends it while the
+/// channel is empty. Suspended coroutines are resumed on the thread pool once a slot or a value becomes available.
+/// Values are held in a lock-free ring buffer, nothing is allocated per value.
+///
+/// Closing the channel lets the receivers drain the values left, after which they receive nothing. Sends and receives
+/// given a cancellation token stop waiting once cancellation is requested.
+///
+/// @code
+/// while (auto value = co_await channel.Receive())
+/// {
+///   Process(*value);
+/// }
+/// @endcode
+///
+/// @tparam Type Type of the values.
+/// @tparam Mode Amount of coroutines allowed to use each end of the channel.
+///
+template<typename Type, ChannelMode Mode = ChannelMode::MultiProducerMultiConsumer>
+class Channel
+{
+public:
+  ///
+  /// Constructor.
+  ///
+  /// @param[in] pool Thread pool suspended coroutines are resumed on.
+  /// @param[in] capacity Maximum amount of values held by the channel.
+  ///
+  Channel(ThreadPool& pool, size_t capacity)
+    : buffer_(capacity), free_slots_(pool, capacity), values_(pool, 0), closed_(false)
+  {
+    ASSERT(capacity != 0, "The capacity must not be zero");
+  }
+
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  ///
+  /// Returns an awaitable that sends a value, waiting for a free slot if the channel is full.
+  ///
+  /// @warning The channel must not be closed.
+  ///
+  /// @param[in] value Value to send.
+  ///
+  /// @return Send awaitable.
+  ///
+  auto Send(Type value)
+  {
+    ASSERT(!closed_.load(std::memory_order_relaxed), "Cannot send on a closed channel");
+
+    return SendOperation<AcquireOperation> { *this, std::move(value) };
+  }
+
+  ///
+  /// Returns an awaitable that sends a value, waiting for a free slot if the channel is full, unless cancellation is
+  /// requested first.
+  ///
+  /// The awaitable results in true if the value was sent, false if cancelled in which case the value is dropped.
+  ///
+  /// @warning The channel must not be closed.
+  ///
+  /// @param[in] value Value to send.
+  /// @param[in] token Token to stop waiting on.
+  ///
+  /// @return Cancellable send awaitable.
+  ///
+  auto Send(Type value, CancellationToken token)
+  {
+    ASSERT(!closed_.load(std::memory_order_relaxed), "Cannot send on a closed channel");
+
+    return SendOperation<CancellableAcquireOperation> { *this, std::move(value), std::move(token) };
+  }
+
+  ///
+  /// Returns an awaitable that receives a value, waiting for one if the channel is empty.
+  ///
+  /// The awaitable results in the received value, or nothing if the channel is closed and empty.
+  ///
+  /// @return Receive awaitable.
+  ///
+  auto Receive() noexcept
+  {
+    return ReceiveOperation<AcquireOperation> { *this };
+  }
+
+  ///
+  /// Returns an awaitable that receives a value, waiting for one if the channel is empty, unless cancellation is
+  /// requested first.
+  ///
+  /// The awaitable results in the received value, or nothing if cancelled or if the channel is closed and empty.
+  ///
+  /// @param[in] token Token to stop waiting on.
+  ///
+  /// @return Cancellable receive awaitable.
+  ///
+  auto Receive(CancellationToken token) noexcept
+  {
+    return ReceiveOperation<CancellableAcquireOperation> { *this, std::move(token) };
+  }
+
+  ///
+  /// Closes the channel. Receivers get the values left, then nothing.
+  ///
+  /// @warning Every send must be completed before closing.
+  ///
+  void Close()
+  {
+    ASSERT(!closed_.load(std::memory_order_relaxed), "The channel is already closed");
+
+    // Needs release so that receivers that see the channel closed also see every value sent.
+    closed_.store(true, std::memory_order_release);
+
+    // Wakes up every current and future receiver. They find the channel empty and closed.
+    values_.Release(cClosedPermits);
+  }
+
+private:
+  using AcquireOperation = decltype(std::declval<AsyncSemaphore&>().Acquire());
+  using CancellableAcquireOperation = decltype(std::declval<AsyncSemaphore&>().Acquire(CancellationToken {}));
+
+  ///
+  /// Awaitable of a send operation. Waits for a free slot, then pushes the value.
+  ///
+  /// @tparam Acquire Operation acquiring the free slot.
+  ///
+  template<typename Acquire>
+  class SendOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @tparam Token Cancellation token type, only for cancellable operations.
+    ///
+    /// @param[in] channel Channel to send on.
+    /// @param[in] value Value to send.
+    /// @param[in] token Token to stop waiting on.
+    ///
+    template<typename... Token>
+    SendOperation(Channel& channel, Type&& value, Token&&... token)
+      : channel_(channel), value_(std::move(value)),
+        acquire_(channel.free_slots_.Acquire(std::forward<Token>(token)...))
+    {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if a free slot was taken without waiting.
+    ///
+    bool await_ready() noexcept
+    {
+      return acquire_.await_ready();
+    }
+
+    ///
+    /// Called after suspension. Waits for a free slot.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if a free slot was taken, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      return acquire_.await_suspend(awaiter);
+    }
+
+    ///
+    /// Pushes the value in the slot taken.
+    ///
+    /// @return Nothing, or whether or not the value was sent when cancellable.
+    ///
+    auto await_resume()
+    {
+      if constexpr (std::is_same_v<Acquire, CancellableAcquireOperation>)
+      {
+        if (!acquire_.await_resume()) return false;
+
+        channel_.Push(value_);
+
+        return true;
+      }
+      else
+      {
+        channel_.Push(value_);
+      }
+    }
+
+  private:
+    Channel& channel_;
+
+    Type value_;
+
+    Acquire acquire_;
+  };
+
+  ///
+  /// Awaitable of a receive operation. Waits for a value, then pops it.
+  ///
+  /// @tparam Acquire Operation acquiring the value.
+  ///
+  template<typename Acquire>
+  class ReceiveOperation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @tparam Token Cancellation token type, only for cancellable operations.
+    ///
+    /// @param[in] channel Channel to receive from.
+    /// @param[in] token Token to stop waiting on.
+    ///
+    template<typename... Token>
+    explicit ReceiveOperation(Channel& channel, Token&&... token) noexcept
+      : channel_(channel), acquire_(channel.values_.Acquire(std::forward<Token>(token)...))
+    {}
+
+    ///
+    /// Called before suspending to check if we should avoid suspending.
+    ///
+    /// @return True if a value was taken without waiting.
+    ///
+    bool await_ready() noexcept
+    {
+      return acquire_.await_ready();
+    }
+
+    ///
+    /// Called after suspension. Waits for a value.
+    ///
+    /// @param[in] awaiter Awaiting coroutine.
+    ///
+    /// @return False if a value was taken, true if the coroutine waits.
+    ///
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      return acquire_.await_suspend(awaiter);
+    }
+
+    ///
+    /// Pops the value taken.
+    ///
+    /// @return Received value, or nothing if cancelled or if the channel is closed and empty.
+    ///
+    std::optional<Type> await_resume()
+    {
+      if constexpr (std::is_same_v<Acquire, CancellableAcquireOperation>)
+      {
+        if (!acquire_.await_resume()) return std::nullopt;
+      }
+
+      return channel_.Pop();
+    }
+
+  private:
+    Channel& channel_;
+
+    Acquire acquire_;
+  };
+
+  ///
+  /// Pushes a value in a slot taken by a sender.
+  ///
+  /// The slot can still be in use for a short time by a receiver that has not finished popping.
+  ///
+  /// @param[in] value Value to push.
+  ///
+  void Push(Type& value)
+  {
+    ExponentialBackoff backoff;
+
+    while (!buffer_.TryPush(value))
+    {
+      backoff.Wait();
+    }
+
+    values_.Release();
+  }
+
+  ///
+  /// Pops a value taken by a receiver.
+  ///
+  /// The value can still be in the process of being pushed for a short time by a sender that started earlier.
+  ///
+  /// @return Popped value, or nothing if the channel is closed and empty.
+  ///
+  std::optional<Type> Pop()
+  {
+    ExponentialBackoff backoff;
+
+    for (;;)
+    {
+      if (auto value = buffer_.TryPop())
+      {
+        free_slots_.Release();
+
+        return value;
+      }
+
+      if (closed_.load(std::memory_order_acquire))
+      {
+        // Sends are completed before closing, try one last time in case values were sent right before.
+        auto value = buffer_.TryPop();
+
+        if (value) free_slots_.Release();
+
+        return value;
+      }
+
+      backoff.Wait();
+    }
+  }
+
+private:
+  // Amount of values released when closing, enough for every receiver to wake up.
+  static constexpr size_t cClosedPermits = size_t { 1 } << 40;
+
+  details::ChannelBuffer<Type, Mode> buffer_;
+
+  AsyncSemaphore free_slots_;
+  AsyncSemaphore values_;
+
+  std::atomic_bool closed_;
+};
+} // namespace plex
+
+#endif
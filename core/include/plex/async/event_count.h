@@ -0,0 +1,158 @@
+#ifndef PLEX_ASYNC_EVENT_COUNT_H
+#define PLEX_ASYNC_EVENT_COUNT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace plex
+{
+///
+/// Lets threads sleep until some condition becomes true, without having to lock anything to check the condition.
+///
+/// Waiting is done in two phases:
+///
+/// @code
+/// auto key = event_count.PrepareWait();
+///
+/// if (condition) event_count.CancelWait();
+/// else
+/// {
+///   event_count.Wait(key);
+/// }
+/// @endcode
+///
+/// The notifying side makes the condition true and then calls NotifyOne or NotifyAll. Notifying is very cheap when
+/// nobody is waiting, it does not make a system call.
+///
+/// @note Built on atomic wait and notify, which use a futex on Linux and WaitOnAddress on Windows.
+///
+class EventCount
+{
+public:
+  using Key = uint32_t;
+
+  ///
+  /// Default constructor.
+  ///
+  constexpr EventCount() noexcept : epoch_(0), waiters_(0) {}
+
+  EventCount(const EventCount&) = delete;
+  EventCount& operator=(const EventCount&) = delete;
+
+  ///
+  /// Announces that the current thread is about to wait.
+  ///
+  /// Must be followed by either CancelWait or Wait with the returned key, after checking the condition.
+  ///
+  /// @return Key to pass to wait.
+  ///
+  [[nodiscard]] Key PrepareWait() noexcept
+  {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+
+    // Pairs with the fence in Notify. Either the notifier sees us waiting or we see the condition it made true.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  ///
+  /// Cancels a prepared wait, because the condition became true.
+  ///
+  void CancelWait() noexcept
+  {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Blocks until notified after the wait was prepared.
+  ///
+  /// @param[in] key Key returned by prepare wait.
+  ///
+  void Wait(Key key) noexcept
+  {
+    while (epoch_.load(std::memory_order_acquire) == key)
+    {
+      epoch_.wait(key, std::memory_order_acquire);
+    }
+
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Wakes up one waiting thread, if there are any.
+  ///
+  /// @warning Must be called after making the condition true.
+  ///
+  void NotifyOne() noexcept
+  {
+    if (Notify()) epoch_.notify_one();
+  }
+
+  ///
+  /// Wakes up all waiting threads, if there are any.
+  ///
+  /// @warning Must be called after making the condition true.
+  ///
+  void NotifyAll() noexcept
+  {
+    if (Notify()) epoch_.notify_all();
+  }
+
+  ///
+  /// Wakes up as many waiting threads as requested, at most all of them.
+  ///
+  /// @warning Must be called after making the condition true.
+  ///
+  /// @param[in] count Amount of threads to wake up.
+  ///
+  void NotifyMany(size_t count) noexcept
+  {
+    if (count == 0 || !Notify()) return;
+
+    if (count >= waiters_.load(std::memory_order_relaxed)) epoch_.notify_all();
+    else
+    {
+      for (size_t i = 0; i != count; i++)
+      {
+        epoch_.notify_one();
+      }
+    }
+  }
+
+  ///
+  /// Returns approximately the amount of threads waiting or about to wait.
+  ///
+  /// @return Approximate amount of waiters.
+  ///
+  [[nodiscard]] uint32_t WaitersApprox() const noexcept
+  {
+    return waiters_.load(std::memory_order_relaxed);
+  }
+
+private:
+  ///
+  /// Advances the epoch if there are waiters.
+  ///
+  /// @return True if there are waiters that need to be woken up, false otherwise.
+  ///
+  bool Notify() noexcept
+  {
+    // Pairs with the fence in PrepareWait.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (waiters_.load(std::memory_order_relaxed) == 0) return false;
+
+    epoch_.fetch_add(1, std::memory_order_release);
+
+    return true;
+  }
+
+private:
+  std::atomic<uint32_t> epoch_;
+  std::atomic<uint32_t> waiters_;
+};
+} // namespace plex
+
+#endif
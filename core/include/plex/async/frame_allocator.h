@@ -0,0 +1,65 @@
+#ifndef PLEX_ASYNC_FRAME_ALLOCATOR_H
+#define PLEX_ASYNC_FRAME_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+///
+/// Used to make coroutine promises allocate their frames with the frame allocator.
+///
+#define COROUTINE_FRAME_ALLOCATOR                                   \
+  static void* operator new(size_t size)                            \
+  {                                                                 \
+    return ::plex::AllocateFrame(size);                             \
+  }                                                                 \
+                                                                    \
+  static void operator delete(void* pointer, size_t size) noexcept \
+  {                                                                 \
+    ::plex::DeallocateFrame(pointer, size);                         \
+  }
+
+namespace plex
+{
+///
+/// Counters of the frame allocator, summed over every thread.
+///
+struct FrameAllocatorStats
+{
+  uint64_t allocations; // Frames allocated
+  uint64_t deallocations; // Frames deallocated
+  uint64_t cache_misses; // Allocations that could not be served by the thread cache
+  uint64_t heap_allocations; // Allocations made to the global heap (Blocks of frames and large frames)
+};
+
+///
+/// Allocates memory for a coroutine frame.
+///
+/// Frames are pooled in size classes. Every thread caches free frames, so most allocations do not synchronize at all.
+/// Frames can be deallocated by any thread, threads that free more than they allocate give the frames back to a
+/// global pool that other threads refill from.
+///
+/// Large frames are allocated directly on the heap.
+///
+/// @param[in] size Size of the frame.
+///
+/// @return Pointer to the frame memory.
+///
+void* AllocateFrame(size_t size);
+
+///
+/// Deallocates memory of a coroutine frame.
+///
+/// @param[in] pointer Pointer to the frame memory.
+/// @param[in] size Size of the frame, must be the same size as when allocated.
+///
+void DeallocateFrame(void* pointer, size_t size) noexcept;
+
+///
+/// Returns the frame allocator counters summed over every thread.
+///
+/// @return Frame allocator counters.
+///
+FrameAllocatorStats GetFrameAllocatorStats();
+} // namespace plex
+
+#endif
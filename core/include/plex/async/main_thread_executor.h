@@ -0,0 +1,313 @@
+#ifndef PLEX_ASYNC_MAIN_THREAD_EXECUTOR_H
+#define PLEX_ASYNC_MAIN_THREAD_EXECUTOR_H
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+
+#include "plex/async/thread_pool.h"
+#include "plex/async/trigger_task.h"
+#include "plex/debug/assertion.h"
+#include "plex/utilities/type_traits.h"
+
+namespace plex
+{
+///
+/// Executor that resumes coroutines on a single thread, the thread that created it. Meant for work that must run on
+/// the main thread, like windowing or submitting to the GPU.
+///
+/// Coroutines are only resumed when the owning thread drives the executor, either by running the pending coroutines or
+/// by running the executor until an awaitable completes.
+///
+/// @code
+/// co_await executor.Schedule(); // Resumed on the main thread
+///
+/// window.PollEvents();
+///
+/// co_await pool.Schedule(); // Back on the thread pool
+/// @endcode
+///
+class MainThreadExecutor
+{
+public:
+  ///
+  /// Default constructor. The calling thread becomes the thread the executor resumes coroutines on.
+  ///
+  MainThreadExecutor() noexcept : head_(nullptr), epoch_(0), thread_id_(std::this_thread::get_id()) {}
+
+#ifndef NDEBUG
+  ///
+  /// Destructor.
+  ///
+  ~MainThreadExecutor() noexcept
+  {
+    ASSERT(head_.load(std::memory_order_relaxed) == nullptr, "There are still coroutines left");
+  }
+#endif
+
+  MainThreadExecutor(const MainThreadExecutor&) = delete;
+  MainThreadExecutor& operator=(const MainThreadExecutor&) = delete;
+
+  ///
+  /// Returns an awaiter that will schedule the awaiting coroutine to be later resumed on the thread of the executor.
+  ///
+  /// @return Executor awaiter.
+  ///
+  auto Schedule() noexcept
+  {
+    return Operation { this };
+  }
+
+  ///
+  /// Resumes every coroutine scheduled so far, in the order they were scheduled. Coroutines scheduled while running
+  /// are left for the next call.
+  ///
+  /// @warning Must be called by the thread of the executor.
+  ///
+  /// @return Amount of coroutines resumed.
+  ///
+  size_t RunPending()
+  {
+    ASSERT(IsExecutorThread(), "Main thread executor must be driven by its own thread");
+
+    if (head_.load(std::memory_order_relaxed) == nullptr) return 0;
+
+    // The operations are stacked, reverse them to get them back in schedule order.
+    Operation* stack = head_.exchange(nullptr, std::memory_order_acquire);
+    Operation* list = nullptr;
+
+    while (stack != nullptr)
+    {
+      Operation* next = stack->next_;
+      stack->next_ = list;
+      list = stack;
+      stack = next;
+    }
+
+    size_t amount = 0;
+
+    while (list != nullptr)
+    {
+      Operation* next = list->next_; // The operation is gone once resumed
+
+      details::ResumeIsolated(list->handle_);
+      list = next;
+
+      amount++;
+    }
+
+    return amount;
+  }
+
+  ///
+  /// Runs the executor until the awaitable completes, then returns its result.
+  ///
+  /// Behaves like a sync wait, except that the waiting thread resumes the coroutines scheduled on the executor instead
+  /// of only blocking. Sleeps while there is nothing to resume.
+  ///
+  /// @warning Must be called by the thread of the executor.
+  ///
+  /// @tparam Awaitable Awaitable type.
+  ///
+  /// @param[in] awaitable Awaitable to wait for.
+  ///
+  /// @return Result of the awaitable.
+  ///
+  template<Awaitable Awaitable>
+  auto RunUntilComplete(Awaitable&& awaitable) -> typename AwaitableTraits<Awaitable>::AwaitResultType
+  {
+    return Run(std::forward<Awaitable>(awaitable), []() { return false; });
+  }
+
+  ///
+  /// Runs the executor until the awaitable completes, then returns its result. Executes operations queued on the
+  /// thread pool whenever there is nothing to resume on the executor.
+  ///
+  /// @warning Must be called by the thread of the executor.
+  ///
+  /// @tparam Awaitable Awaitable type.
+  ///
+  /// @param[in] pool Thread pool to help.
+  /// @param[in] awaitable Awaitable to wait for.
+  ///
+  /// @return Result of the awaitable.
+  ///
+  template<Awaitable Awaitable>
+  auto RunUntilComplete(ThreadPool& pool, Awaitable&& awaitable) ->
+    typename AwaitableTraits<Awaitable>::AwaitResultType
+  {
+    return Run(std::forward<Awaitable>(awaitable), [&pool]() { return pool.TryRunOne(); });
+  }
+
+  ///
+  /// Returns whether or not the calling thread is the thread of the executor.
+  ///
+  /// @return True if called by the thread of the executor.
+  ///
+  [[nodiscard]] bool IsExecutorThread() const noexcept
+  {
+    return std::this_thread::get_id() == thread_id_;
+  }
+
+private:
+  ///
+  /// Runs the executor until the awaitable completes.
+  ///
+  /// @tparam Awaitable Awaitable type.
+  /// @tparam Help Callable type.
+  ///
+  /// @param[in] awaitable Awaitable to wait for.
+  /// @param[in] help Called when there is nothing to resume, returns whether or not it did other work instead.
+  ///
+  /// @return Result of the awaitable.
+  ///
+  template<Awaitable Awaitable, typename Help>
+  auto Run(Awaitable&& awaitable, Help help) -> typename AwaitableTraits<Awaitable>::AwaitResultType
+  {
+    Flag flag(this);
+
+    auto trigger_task = MakeTriggerTask<Flag>(std::forward<Awaitable>(awaitable));
+
+    trigger_task.Start(flag);
+
+    for (;;)
+    {
+      // Read before looking for work, anything scheduled or completing afterwards changes it and cancels the wait.
+      const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+
+      RunPending();
+
+      if (flag.IsDone()) break;
+
+      if (help()) continue;
+
+      if (head_.load(std::memory_order_relaxed) == nullptr) epoch_.wait(epoch, std::memory_order_acquire);
+    }
+
+    return trigger_task.Result();
+  }
+
+  ///
+  /// Represents a coroutine scheduled on the executor.
+  ///
+  class Operation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] executor Executor to schedule on.
+    ///
+    constexpr explicit Operation(MainThreadExecutor* executor) noexcept : executor_(executor), next_(nullptr) {}
+
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    ///
+    /// Does nothing.
+    ///
+    void await_resume() const noexcept {}
+
+    ///
+    /// Called after suspension. Pushes the operation for the executor thread to resume.
+    ///
+    /// @param[in] awaiting Awaiting coroutine.
+    ///
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+      handle_ = awaiting;
+
+      executor_->Push(this);
+    }
+
+  private:
+    friend class MainThreadExecutor;
+
+    MainThreadExecutor* executor_;
+
+    std::coroutine_handle<> handle_;
+    Operation* next_;
+  };
+
+  ///
+  /// Trigger for running until an awaitable completes. Wakes up the executor thread when fired.
+  ///
+  class Flag
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] executor Executor to wake up.
+    ///
+    explicit Flag(MainThreadExecutor* executor) noexcept : executor_(executor), done_(false) {}
+
+    ///
+    /// Marks the awaitable as completed and wakes up the executor thread.
+    ///
+    void Fire() noexcept
+    {
+      MainThreadExecutor* executor = executor_; // The flag is gone once done is seen
+
+      done_.store(true, std::memory_order_release);
+
+      executor->Wake();
+    }
+
+    ///
+    /// Returns whether or not the awaitable completed.
+    ///
+    /// @return True if completed.
+    ///
+    [[nodiscard]] bool IsDone() const noexcept
+    {
+      return done_.load(std::memory_order_acquire);
+    }
+
+  private:
+    MainThreadExecutor* executor_;
+    std::atomic_bool done_;
+  };
+
+  ///
+  /// Pushes an operation to be resumed, then wakes up the executor thread.
+  ///
+  /// @param[in] operation Operation to push.
+  ///
+  void Push(Operation* operation) noexcept
+  {
+    Operation* head = head_.load(std::memory_order_relaxed);
+
+    do
+    {
+      operation->next_ = head;
+    }
+    while (!head_.compare_exchange_weak(head, operation, std::memory_order_release, std::memory_order_relaxed));
+
+    Wake();
+  }
+
+  ///
+  /// Wakes up the executor thread if it is sleeping.
+  ///
+  void Wake() noexcept
+  {
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+  }
+
+private:
+  std::atomic<Operation*> head_; // Stack of scheduled operations
+  std::atomic_uint32_t epoch_; // Changes every time there is something for the executor thread to do
+
+  std::thread::id thread_id_;
+};
+
+template<>
+struct IsThreadSafe<MainThreadExecutor> : std::true_type
+{};
+} // namespace plex
+
+#endif
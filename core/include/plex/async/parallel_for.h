@@ -0,0 +1,291 @@
+#ifndef PLEX_ASYNC_PARALLEL_FOR_H
+#define PLEX_ASYNC_PARALLEL_FOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+
+#include "plex/async/thread_pool.h"
+#include "plex/async/when_all.h"
+
+namespace plex
+{
+///
+/// Concept required to be the body of a parallel for. Either invoked once per chunk with the range of the chunk, or
+/// once per index.
+///
+/// @tparam Type Type to check.
+///
+template<typename Type>
+concept ParallelForBody = std::invocable<Type&, size_t, size_t> || std::invocable<Type&, size_t>;
+
+namespace details
+{
+  ///
+  /// Hands out chunks of an index range to the runners of a parallel algorithm.
+  ///
+  /// Chunks start large and shrink as the range runs out: the first claims are few and cheap, the last ones are small
+  /// so that runners finish at about the same time. Chunks are never smaller than the grain, except for the last one.
+  ///
+  class ParallelRange
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] begin First index of the range.
+    /// @param[in] end Last index of the range (exclusive).
+    /// @param[in] grain Minimum amount of indices per chunk.
+    /// @param[in] runners Amount of runners claiming chunks.
+    ///
+    ParallelRange(size_t begin, size_t end, size_t grain, size_t runners) noexcept
+      : next_(begin), end_(end), grain_(grain), divisor_(runners * cChunksPerRunner)
+    {}
+
+    ///
+    /// Claims the next chunk of the range.
+    ///
+    /// @param[out] chunk_begin First index of the chunk.
+    /// @param[out] chunk_end Last index of the chunk (exclusive).
+    ///
+    /// @return True if a chunk was claimed, false if the range is exhausted.
+    ///
+    bool Claim(size_t& chunk_begin, size_t& chunk_end) noexcept
+    {
+      size_t current = next_.load(std::memory_order_relaxed);
+
+      // Relaxed is enough, the work done on the chunks is published when the runners complete.
+      do
+      {
+        if (current >= end_) return false;
+
+        const size_t remaining = end_ - current;
+
+        chunk_end = current + std::min(remaining, std::max(grain_, remaining / divisor_));
+      }
+      while (!next_.compare_exchange_weak(current, chunk_end, std::memory_order_relaxed, std::memory_order_relaxed));
+
+      chunk_begin = current;
+
+      return true;
+    }
+
+    ///
+    /// Returns the amount of runners worth using for a range.
+    ///
+    /// @param[in] pool Thread pool the runners execute on.
+    /// @param[in] begin First index of the range.
+    /// @param[in] end Last index of the range (exclusive).
+    /// @param[in] grain Minimum amount of indices per chunk.
+    ///
+    /// @return Amount of runners, never more than the amount of chunks of grain size.
+    ///
+    static size_t RunnerCount(const ThreadPool& pool, size_t begin, size_t end, size_t grain) noexcept
+    {
+      const size_t chunks = (end - begin + grain - 1) / grain;
+
+      return std::max<size_t>(std::min(pool.ThreadCount(), chunks), 1);
+    }
+
+  private:
+    // Amount of chunks a runner claims from its share of the remaining range. Higher balances better, lower claims
+    // less often.
+    static constexpr size_t cChunksPerRunner = 2;
+
+    std::atomic_size_t next_;
+
+    size_t end_;
+    size_t grain_;
+    size_t divisor_;
+  };
+
+  ///
+  /// Runs the body of a parallel for on chunks claimed from the range until it is exhausted.
+  ///
+  /// Runners are spread across the workers by recursively handing half of them to another worker, so that they are
+  /// started in parallel rather than one by one.
+  ///
+  /// @tparam Body Body type.
+  ///
+  /// @param[in] pool Thread pool to run on.
+  /// @param[in] range Range to claim chunks from.
+  /// @param[in] body Body to invoke.
+  /// @param[in] runners Amount of runners to start.
+  /// @param[in] schedule Whether or not to schedule on the pool first, otherwise runs on the current thread.
+  ///
+  /// @return Task that completes when the runners are done.
+  ///
+  template<ParallelForBody Body>
+  Task<> ParallelForRunner(ThreadPool& pool, ParallelRange& range, Body& body, size_t runners, bool schedule)
+  {
+    if (schedule) co_await pool.Schedule();
+
+    if (runners > 1)
+    {
+      const size_t half = runners / 2;
+
+      co_await WhenAll(ParallelForRunner(pool, range, body, runners - half, true),
+        ParallelForRunner(pool, range, body, half, false));
+    }
+    else
+    {
+      size_t chunk_begin;
+      size_t chunk_end;
+
+      while (range.Claim(chunk_begin, chunk_end))
+      {
+        if constexpr (std::invocable<Body&, size_t, size_t>) body(chunk_begin, chunk_end);
+        else
+        {
+          for (size_t i = chunk_begin; i != chunk_end; i++)
+          {
+            body(i);
+          }
+        }
+      }
+    }
+  }
+
+  ///
+  /// Reduces the chunks claimed from the range until it is exhausted.
+  ///
+  /// Runners are spread the same way as for the parallel for. Partial results are reduced up the tree of runners.
+  ///
+  /// @tparam Type Result type.
+  /// @tparam Map Map type.
+  /// @tparam Reduce Reduce type.
+  ///
+  /// @param[in] pool Thread pool to run on.
+  /// @param[in] range Range to claim chunks from.
+  /// @param[in] identity Identity of the reduction.
+  /// @param[in] map Map that produces a value for a chunk or an index.
+  /// @param[in] reduce Reduction of two values.
+  /// @param[in] runners Amount of runners to start.
+  /// @param[in] schedule Whether or not to schedule on the pool first, otherwise runs on the current thread.
+  ///
+  /// @return Task that returns the reduction of the chunks claimed by the runners.
+  ///
+  template<typename Type, typename Map, typename Reduce>
+  Task<Type> ParallelReduceRunner(ThreadPool& pool,
+    ParallelRange& range,
+    const Type& identity,
+    Map& map,
+    Reduce& reduce,
+    size_t runners,
+    bool schedule)
+  {
+    if (schedule) co_await pool.Schedule();
+
+    if (runners > 1)
+    {
+      const size_t half = runners / 2;
+
+      auto [first, second] =
+        co_await CollectAll(ParallelReduceRunner(pool, range, identity, map, reduce, runners - half, true),
+          ParallelReduceRunner(pool, range, identity, map, reduce, half, false));
+
+      co_return reduce(std::move(first), std::move(second));
+    }
+
+    Type result = identity;
+
+    size_t chunk_begin;
+    size_t chunk_end;
+
+    while (range.Claim(chunk_begin, chunk_end))
+    {
+      if constexpr (std::invocable<Map&, size_t, size_t>)
+        result = reduce(std::move(result), map(chunk_begin, chunk_end));
+      else
+      {
+        for (size_t i = chunk_begin; i != chunk_end; i++)
+        {
+          result = reduce(std::move(result), map(i));
+        }
+      }
+    }
+
+    co_return result;
+  }
+} // namespace details
+
+///
+/// Creates a new awaitable that invokes the body over a range of indices on the workers of a thread pool.
+///
+/// The range is split in chunks that are claimed by one runner per worker. Chunks start large and shrink as the range
+/// runs out, so that workers stay balanced even when the cost of the indices varies. Nothing is allocated per chunk.
+///
+/// The body is either invoked once per chunk with the first and last (exclusive) index of the chunk, or once per index.
+/// It may be invoked concurrently by multiple workers.
+///
+/// A range that fits in a single grain runs directly on the awaiting thread.
+///
+/// @tparam Body Body type.
+///
+/// @param[in] pool Thread pool to run on.
+/// @param[in] begin First index of the range.
+/// @param[in] end Last index of the range (exclusive).
+/// @param[in] grain Minimum amount of indices per chunk. Should be large enough to amortize claiming a chunk.
+/// @param[in] body Body to invoke.
+///
+/// @return Task that completes when the body was invoked for every index of the range.
+///
+template<ParallelForBody Body>
+Task<> ParallelFor(ThreadPool& pool, size_t begin, size_t end, size_t grain, Body body)
+{
+  if (begin >= end) co_return;
+
+  grain = std::max<size_t>(grain, 1);
+
+  const size_t runners = details::ParallelRange::RunnerCount(pool, begin, end, grain);
+
+  details::ParallelRange range(begin, end, grain, runners);
+
+  co_await details::ParallelForRunner(pool, range, body, runners, end - begin > grain);
+}
+
+///
+/// Creates a new awaitable that maps every index of a range to a value and reduces the values on the workers of a
+/// thread pool.
+///
+/// The range is split the same way as for the parallel for. Every runner reduces the chunks it claims, then the partial
+/// results are reduced together.
+///
+/// The map either produces a value for a chunk from the first and last (exclusive) index of the chunk, or a value for a
+/// single index. The map and the reduction may be invoked concurrently by multiple workers.
+///
+/// @warning The reduction must be associative and commutative, chunks are not reduced in index order.
+///
+/// @tparam Type Result type.
+/// @tparam Map Map type.
+/// @tparam Reduce Reduce type.
+///
+/// @param[in] pool Thread pool to run on.
+/// @param[in] begin First index of the range.
+/// @param[in] end Last index of the range (exclusive).
+/// @param[in] grain Minimum amount of indices per chunk. Should be large enough to amortize claiming a chunk.
+/// @param[in] identity Identity of the reduction, returned for an empty range.
+/// @param[in] map Map that produces a value for a chunk or an index.
+/// @param[in] reduce Reduction of two values.
+///
+/// @return Task that returns the reduction of every mapped value.
+///
+template<typename Type, typename Map, typename Reduce>
+requires(std::invocable<Map&, size_t, size_t> || std::invocable<Map&, size_t>)
+        && std::invocable<Reduce&, Type, Type>
+Task<Type> ParallelReduce(
+  ThreadPool& pool, size_t begin, size_t end, size_t grain, Type identity, Map map, Reduce reduce)
+{
+  if (begin >= end) co_return identity;
+
+  grain = std::max<size_t>(grain, 1);
+
+  const size_t runners = details::ParallelRange::RunnerCount(pool, begin, end, grain);
+
+  details::ParallelRange range(begin, end, grain, runners);
+
+  co_return co_await details::ParallelReduceRunner(pool, range, identity, map, reduce, runners, end - begin > grain);
+}
+} // namespace plex
+
+#endif
@@ -4,6 +4,8 @@
 #include <thread>
 
 #include "plex/async/awaitable.h"
+#include "plex/async/frame_allocator.h"
+#include "plex/async/task_local.h"
 #include "plex/debug/assertion.h"
 #include "plex/utilities/type_traits.h"
 
@@ -20,7 +22,7 @@ namespace details
   ///
   /// Base for the shared task promise.
   ///
-  class SharedTaskPromiseBase
+  class SharedTaskPromiseBase : public TaskContextCarrier
   {
   public:
     ///
@@ -88,12 +90,11 @@ namespace details
         {
           // Pointer must be read before resuming because the resumed coroutine may destroy the waiter value.
           Node* next = list->next;
-          list->continuation.resume();
+          ResumeIsolated(list->continuation);
           list = next;
         }
 
-        // Last waiter is resumed here to be compiled as a tail call.
-        list->continuation.resume();
+        ResumeIsolated(list->continuation);
       }
     };
 
@@ -104,13 +105,13 @@ namespace details
 
     ///
     /// Initially suspended to make tasks lazily executed. Task must resume from its initial suspension
-    /// to be executed.
+    /// to be executed. Takes the task context of the coroutine that starts it.
     ///
-    /// @return Always suspend.
+    /// @return Initial awaiter.
     ///
-    std::suspend_always initial_suspend() const noexcept
+    InitialAwaiter initial_suspend() noexcept
     {
-      return {};
+      return InitialSuspend();
     }
 
     ///
@@ -146,7 +147,7 @@ namespace details
           && state_.compare_exchange_strong(old_list, started_no_waiters_value, std::memory_order_relaxed))
       {
         // Coroutine was not started
-        coroutine.resume();
+        ResumeIsolated(coroutine);
         old_list = state_.load(std::memory_order_acquire);
       }
 
@@ -199,6 +200,8 @@ namespace details
 
     COROUTINE_UNHANDLED_EXCEPTION
 
+    COROUTINE_FRAME_ALLOCATOR
+
   private:
     std::atomic_uint_fast32_t ref_count_;
 
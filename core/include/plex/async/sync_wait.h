@@ -3,6 +3,7 @@
 
 #include <atomic>
 
+#include "plex/async/thread_pool.h"
 #include "plex/async/trigger_task.h"
 
 namespace plex
@@ -139,6 +140,32 @@ auto SyncWait(Awaitable&& awaitable) -> typename AwaitableTraits<Awaitable>::Awa
   return trigger_task.Result();
 }
 
+///
+/// Creates a sync wait task for the awaitable and waits until its done, executing operations queued on the thread pool
+/// in the meantime instead of blocking.
+///
+/// The waiting thread acts like one more worker of the pool until the awaitable is done. It only parks when there is
+/// nothing to execute, and it is woken up directly when the awaitable completes.
+///
+/// @tparam Awaitable Awaitable type to synchronously wait on.
+///
+/// @param[in] pool Thread pool to help.
+/// @param[in] awaitable To synchronously wait on.
+///
+template<Awaitable Awaitable>
+auto SyncWait(ThreadPool& pool, Awaitable&& awaitable) -> typename AwaitableTraits<Awaitable>::AwaitResultType
+{
+  ThreadPool::HelpFlag flag;
+
+  auto trigger_task = MakeTriggerTask<ThreadPool::HelpFlag>(std::forward<Awaitable>(awaitable));
+
+  trigger_task.Start(flag);
+
+  pool.HelpUntil(flag);
+
+  return trigger_task.Result();
+}
+
 } // namespace plex
 
 #endif
@@ -4,6 +4,8 @@
 #include <thread>
 
 #include "plex/async/awaitable.h"
+#include "plex/async/frame_allocator.h"
+#include "plex/async/task_local.h"
 #include "plex/debug/assertion.h"
 #include "plex/utilities/type_traits.h"
 
@@ -109,7 +111,7 @@ namespace details
   ///
   /// Base for the task promise.
   ///
-  class TaskPromiseBase
+  class TaskPromiseBase : public TaskContextCarrier
   {
   public:
     ///
@@ -155,13 +157,13 @@ namespace details
 
     ///
     /// Initially suspended to make tasks lazily executed. Task must resume from its initial suspension
-    /// to be executed.
+    /// to be executed. Takes the task context of the coroutine that starts it.
     ///
-    /// @return Always suspend.
+    /// @return Initial awaiter.
     ///
-    std::suspend_always initial_suspend() const noexcept
+    InitialAwaiter initial_suspend() noexcept
     {
-      return {};
+      return InitialSuspend();
     }
 
     ///
@@ -186,6 +188,8 @@ namespace details
 
     COROUTINE_UNHANDLED_EXCEPTION
 
+    COROUTINE_FRAME_ALLOCATOR
+
   private:
     std::coroutine_handle<> continuation_;
   };
@@ -488,7 +492,7 @@ public:
   void Eject()
   {
     Handle<promise_type>().promise().SetContinuation(std::noop_coroutine());
-    Handle().resume();
+    details::ResumeIsolated(Handle());
   }
 
   ///
@@ -524,6 +528,65 @@ namespace details
   }
 } // namespace details
 
+namespace details
+{
+  ///
+  /// Result type of a task awaiting an awaitable with its own task context. Rvalue references are returned by value.
+  ///
+  /// @tparam Awaitable Awaitable type.
+  ///
+  template<Awaitable Awaitable>
+  using WithTaskContextResult = std::conditional_t<
+    std::is_rvalue_reference_v<typename AwaitableTraits<Awaitable>::AwaitResultType>,
+    std::remove_reference_t<typename AwaitableTraits<Awaitable>::AwaitResultType>,
+    typename AwaitableTraits<Awaitable>::AwaitResultType>;
+} // namespace details
+
+///
+/// Creates a task that awaits the awaitable with its own task context. The awaitable, and every coroutine it starts,
+/// sees the task locals of that context instead of the ones of the awaiting coroutine.
+///
+/// @code
+/// TaskContext context;
+///
+/// co_await WithTaskContext(context, RunSystem()); // Task locals set by the system stay in the context
+/// @endcode
+///
+/// @tparam Awaitable Awaitable type.
+///
+/// @param[in] context Context to await the awaitable with. Must outlive the task.
+/// @param[in] awaitable Awaitable to await.
+///
+/// @return Task that results in the result of the awaitable.
+///
+template<Awaitable Awaitable>
+Task<details::WithTaskContextResult<Awaitable>> WithTaskContext(TaskContext& context, Awaitable awaitable)
+{
+  using ResultType = details::WithTaskContextResult<Awaitable>;
+
+  TaskContext* previous = co_await details::SwitchTaskContext { &context };
+
+  // The previous context is switched back before completing, so that it is still current if this task was started
+  // from outside of a coroutine.
+  if constexpr (std::is_void_v<ResultType>)
+  {
+    co_await std::move(awaitable);
+    co_await details::SwitchTaskContext { previous };
+  }
+  else if constexpr (std::is_reference_v<ResultType>)
+  {
+    ResultType result = co_await std::move(awaitable);
+    co_await details::SwitchTaskContext { previous };
+    co_return result;
+  }
+  else
+  {
+    ResultType result = co_await std::move(awaitable);
+    co_await details::SwitchTaskContext { previous };
+    co_return std::move(result);
+  }
+}
+
 template<typename Type>
 struct IsTriviallyRelocatable<Task<Type>> : std::true_type
 {};
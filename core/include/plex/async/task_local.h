@@ -0,0 +1,357 @@
+#ifndef PLEX_ASYNC_TASK_LOCAL_H
+#define PLEX_ASYNC_TASK_LOCAL_H
+
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+#include "plex/debug/assertion.h"
+
+namespace plex
+{
+class TaskContext;
+
+namespace details
+{
+  ///
+  /// Task context of the coroutine running on the current thread. Inline so that restoring it on every resume is a
+  /// plain thread local access.
+  ///
+  inline thread_local TaskContext* current_task_context = nullptr;
+
+  ///
+  /// Returns a reference to the task context of the coroutine running on the current thread.
+  ///
+  /// @return Reference to the current task context pointer, nullptr if there is none.
+  ///
+  inline TaskContext*& CurrentTaskContext() noexcept
+  {
+    return current_task_context;
+  }
+
+  ///
+  /// Allocates a new task local slot.
+  ///
+  /// @warning Terminates when every slot is taken, slots are never freed.
+  ///
+  /// @return Index of the slot, always less than TaskContext::cMaxLocals.
+  ///
+  size_t AllocateTaskLocalSlot() noexcept;
+} // namespace details
+
+///
+/// Storage for task locals. Task locals are like thread locals, except that they follow coroutines as they move
+/// between threads.
+///
+/// Coroutines started by another coroutine share its context, unless they are given their own. Awaiting a task with
+/// WithTaskContext gives it a context of its own.
+///
+/// @note Contexts can be copied to start from the values of another context.
+///
+class TaskContext
+{
+public:
+  static constexpr size_t cMaxLocals = 16; // Creating more task locals terminates
+
+  ///
+  /// Default constructor. Every task local starts as nullptr.
+  ///
+  constexpr TaskContext() noexcept : slots_ {} {}
+
+  ///
+  /// Returns the value of a slot.
+  ///
+  /// @param[in] index Index of the slot.
+  ///
+  /// @return Value of the slot.
+  ///
+  [[nodiscard]] void* Get(size_t index) const noexcept
+  {
+    ASSERT(index < cMaxLocals, "Task local slot out of range");
+    return slots_[index];
+  }
+
+  ///
+  /// Sets the value of a slot.
+  ///
+  /// @param[in] index Index of the slot.
+  /// @param[in] value Value to set.
+  ///
+  void Set(size_t index, void* value) noexcept
+  {
+    ASSERT(index < cMaxLocals, "Task local slot out of range");
+    slots_[index] = value;
+  }
+
+  ///
+  /// Returns the task context of the coroutine running on the current thread.
+  ///
+  /// @return Current task context, nullptr if there is none.
+  ///
+  [[nodiscard]] static TaskContext* Current() noexcept
+  {
+    return details::CurrentTaskContext();
+  }
+
+private:
+  void* slots_[cMaxLocals];
+};
+
+///
+/// Key to a value stored in the context of the running task. Lookups are a single indexed load from the current task
+/// context.
+///
+/// Task locals only point to their value, the value must outlive the context. Keys are meant to be static, the slot of
+/// a key is never reused.
+///
+/// @code
+/// static TaskLocal<Arena> cArena;
+///
+/// cArena.Set(&arena); // For the current task and every task it starts afterwards
+///
+/// co_await pool.Schedule();
+///
+/// Arena* arena = cArena.Get(); // Same arena, even on another thread
+/// @endcode
+///
+/// @tparam Type Type of the value.
+///
+template<typename Type>
+class TaskLocal
+{
+public:
+  ///
+  /// Default constructor. Allocates a slot.
+  ///
+  TaskLocal() noexcept : index_(details::AllocateTaskLocalSlot()) {}
+
+  TaskLocal(const TaskLocal&) = delete;
+  TaskLocal& operator=(const TaskLocal&) = delete;
+
+  ///
+  /// Returns the value in the context of the running task.
+  ///
+  /// @return Pointer to the value, nullptr if not set or if there is no task context.
+  ///
+  [[nodiscard]] Type* Get() const noexcept
+  {
+    const TaskContext* context = TaskContext::Current();
+    return context ? static_cast<Type*>(context->Get(index_)) : nullptr;
+  }
+
+  ///
+  /// Sets the value in the context of the running task.
+  ///
+  /// @warning There must be a task context.
+  ///
+  /// @param[in] value Pointer to the value.
+  ///
+  void Set(Type* value) const noexcept
+  {
+    TaskContext* context = TaskContext::Current();
+
+    ASSERT(context, "No task context to set the task local in");
+
+    context->Set(index_, static_cast<void*>(value));
+  }
+
+private:
+  size_t index_;
+};
+
+namespace details
+{
+  ///
+  /// Resumes a coroutine from outside of its awaiter, like a worker loop or a coroutine releasing waiters. The task
+  /// context of the resumer is current again once the coroutine suspends.
+  ///
+  /// @param[in] handle Coroutine to resume.
+  ///
+  inline void ResumeIsolated(std::coroutine_handle<> handle)
+  {
+    TaskContext*& current = CurrentTaskContext();
+
+    TaskContext* const previous = current;
+
+    handle.resume();
+
+    current = previous;
+  }
+
+  ///
+  /// Awaited to switch the task context of the awaiting coroutine. Results in the previous context.
+  ///
+  struct SwitchTaskContext
+  {
+    TaskContext* context;
+  };
+
+  ///
+  /// Returns the awaiter of an awaitable.
+  ///
+  /// @tparam Awaitable Awaitable type.
+  ///
+  /// @param[in] awaitable Awaitable to get the awaiter of.
+  ///
+  /// @return The awaiter, or a reference to the awaitable if it is an awaiter itself.
+  ///
+  template<typename Awaitable>
+  decltype(auto) GetAwaiter(Awaitable&& awaitable)
+  {
+    if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); })
+      return std::forward<Awaitable>(awaitable).operator co_await();
+    else if constexpr (requires { operator co_await(std::forward<Awaitable>(awaitable)); })
+      return operator co_await(std::forward<Awaitable>(awaitable));
+    else
+    {
+      return std::forward<Awaitable>(awaitable);
+    }
+  }
+
+  ///
+  /// Wraps an awaiter to restore the task context of the awaiting coroutine when it is resumed.
+  ///
+  /// @tparam Awaiter Awaiter type, a reference when the awaitable is an awaiter itself.
+  ///
+  template<typename Awaiter>
+  struct TaskContextAwaiter
+  {
+    bool await_ready() noexcept(noexcept(std::declval<Awaiter&>().await_ready()))
+    {
+      return awaiter.await_ready();
+    }
+
+    template<typename Promise>
+    decltype(auto) await_suspend(std::coroutine_handle<Promise> handle) noexcept(
+      noexcept(std::declval<Awaiter&>().await_suspend(handle)))
+    {
+      return awaiter.await_suspend(handle);
+    }
+
+    decltype(auto) await_resume() noexcept(noexcept(std::declval<Awaiter&&>().await_resume()))
+    {
+      CurrentTaskContext() = context;
+
+      return static_cast<Awaiter&&>(awaiter).await_resume();
+    }
+
+    Awaiter awaiter;
+    TaskContext* context;
+  };
+
+  ///
+  /// Base for promises of coroutines that carry a task context.
+  ///
+  /// The context is taken from the coroutine that starts this one, then restored every time this coroutine is resumed
+  /// after a co_await, whatever thread it is resumed on.
+  ///
+  class TaskContextCarrier
+  {
+  public:
+    ///
+    /// Initial awaiter. Takes the context of the starter when first resumed.
+    ///
+    struct InitialAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      ///
+      /// Does nothing.
+      ///
+      void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+      ///
+      /// Takes the context of the coroutine starting this one.
+      ///
+      void await_resume() const noexcept
+      {
+        carrier->context_ = CurrentTaskContext();
+      }
+
+      TaskContextCarrier* carrier;
+    };
+
+    ///
+    /// Constructor.
+    ///
+    constexpr TaskContextCarrier() noexcept : context_(nullptr) {}
+
+    ///
+    /// Wraps every awaited awaitable to restore the context of this coroutine when it is resumed.
+    ///
+    /// @tparam Awaitable Awaitable type.
+    ///
+    /// @param[in] awaitable Awaited awaitable.
+    ///
+    /// @return Awaiter restoring the context.
+    ///
+    template<typename Awaitable>
+    auto await_transform(Awaitable&& awaitable) noexcept(noexcept(GetAwaiter(std::forward<Awaitable>(awaitable))))
+    {
+      using Awaiter = decltype(GetAwaiter(std::forward<Awaitable>(awaitable)));
+
+      return TaskContextAwaiter<Awaiter> { GetAwaiter(std::forward<Awaitable>(awaitable)), context_ };
+    }
+
+    ///
+    /// Switches the context of this coroutine.
+    ///
+    /// @param[in] switch_context Context to switch to.
+    ///
+    /// @return Awaiter that does not suspend and results in the previous context.
+    ///
+    auto await_transform(SwitchTaskContext switch_context) noexcept
+    {
+      TaskContext* previous = std::exchange(context_, switch_context.context);
+
+      CurrentTaskContext() = context_;
+
+      struct Awaiter
+      {
+        bool await_ready() const noexcept
+        {
+          return true;
+        }
+
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+        TaskContext* await_resume() const noexcept
+        {
+          return previous;
+        }
+
+        TaskContext* previous;
+      };
+
+      return Awaiter { previous };
+    }
+
+    ///
+    /// Makes the context of this coroutine the current context. For resume points that are not a co_await.
+    ///
+    void RestoreContext() const noexcept
+    {
+      CurrentTaskContext() = context_;
+    }
+
+  protected:
+    ///
+    /// Returns the initial awaiter, taking the context of the starter.
+    ///
+    /// @return Initial awaiter.
+    ///
+    InitialAwaiter InitialSuspend() noexcept
+    {
+      return { this };
+    }
+
+  private:
+    TaskContext* context_;
+  };
+} // namespace details
+} // namespace plex
+
+#endif
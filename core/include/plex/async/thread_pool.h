@@ -2,13 +2,85 @@
 #define PLEX_ASYNC_THREAD_POOL_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
+#include "plex/async/cancellation.h"
+#include "plex/async/event_count.h"
 #include "plex/async/task.h"
+#include "plex/os/cpu_info.h"
+#include "plex/os/thread.h"
 #include "plex/utilities/type_traits.h"
 
 namespace plex
 {
+///
+/// Strategy used by a thread pool to distribute operations between its workers.
+///
+enum class ThreadPoolMode
+{
+  /// Every operation goes through a single queue shared by all workers.
+  Shared,
+
+  /// Every worker owns a deque. Operations scheduled from a worker stay on that worker and idle workers steal from
+  /// the others. Operations scheduled from outside the pool go through a lock-free injection queue.
+  WorkStealing
+};
+
+///
+/// Priority lane an operation is scheduled in.
+///
+/// Workers drain higher priority lanes first. Every once in a while a worker looks at the lower lanes first, so that
+/// they cannot be starved by a constant flow of higher priority work.
+///
+enum class SchedulePriority : uint8_t
+{
+  /// Latency critical work, like systems of the current frame.
+  High = 0,
+
+  /// Default priority.
+  Normal = 1,
+
+  /// Background work, like asset decoding or autosaves.
+  Low = 2
+};
+
+///
+/// Hint of where an operation should be executed.
+///
+/// Operations scheduled with the same hint are executed by workers of the same group (Workers sharing a L3 cache or a
+/// NUMA node), so that work on the same archetype or chunk stays near its memory. Workers of other groups only take
+/// the operation as a last resort.
+///
+struct LocalityHint
+{
+  size_t key;
+};
+
+///
+/// Snapshot of the counters of a single worker of a thread pool.
+///
+/// Counters are only collected when building with instrumentation (BUILD_INSTRUMENTATION), otherwise they are always
+/// zero and collecting them costs nothing.
+///
+struct ThreadPoolWorkerStats
+{
+  uint64_t executed; // Operations executed
+  uint64_t steals; // Operations stolen from other workers (Work stealing mode only)
+  uint64_t wake_ups; // Times the worker was woken up after parking
+  uint64_t max_queue_depth; // Most operations seen at once in a lane of the worker deque (Work stealing mode only)
+
+  // Time spent in every state, up to the last time the worker changed state.
+  std::chrono::nanoseconds busy; // Executing or looking for work
+  std::chrono::nanoseconds spinning; // Spinning before parking
+  std::chrono::nanoseconds parked; // Sleeping until woken up
+};
+
 ///
 /// Pool of threads to execute tasks on.
 ///
@@ -19,13 +91,24 @@ namespace plex
 class ThreadPool
 {
 public:
+  class Batch;
+
+  using Clock = std::chrono::steady_clock; // Clock used by timers
+
+#ifdef BUILD_INSTRUMENTATION
+  static constexpr bool cStatsEnabled = true; // Whether or not worker counters are collected
+#else
+  static constexpr bool cStatsEnabled = false;
+#endif
+
   ///
   /// Parametric constructor.
   ///
   /// @param[in] thread_count Amount of worker threads to create pool with.
   /// @param[in] lock_threads Locks every thread to a physical processor.
+  /// @param[in] mode Strategy used to distribute operations between workers.
   ///
-  ThreadPool(const size_t thread_count, bool lock_threads);
+  ThreadPool(const size_t thread_count, bool lock_threads, ThreadPoolMode mode = ThreadPoolMode::Shared);
 
   ///
   /// Default constructor.
@@ -45,13 +128,169 @@ public:
   ///
   /// Returns an awaiter that will schedule the awaiting coroutine to be later resumed by the thread pool.
   ///
+  /// @param[in] priority Lane to schedule the coroutine in.
+  ///
   /// @return Thread pool awaiter.
   ///
-  auto Schedule()
+  auto Schedule(SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return Operation { this, priority };
+  }
+
+  ///
+  /// Returns an awaiter that will schedule the awaiting coroutine to be later resumed by the thread pool, preferably by
+  /// a worker of the group the hint maps to.
+  ///
+  /// @note The hint is ignored in the shared mode.
+  ///
+  /// @param[in] hint Locality hint.
+  /// @param[in] priority Lane to schedule the coroutine in.
+  ///
+  /// @return Thread pool awaiter.
+  ///
+  auto Schedule(LocalityHint hint, SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return Operation { this, priority, hint.key };
+  }
+
+  ///
+  /// Returns an awaiter that will schedule the awaiting coroutine to be later resumed by a specific worker.
+  ///
+  /// Other workers never steal the coroutine, which keeps work that benefits from a warm cache on the same core across
+  /// schedules, at the cost of waiting for that worker to be free. A worker resumes the coroutines pinned to it before
+  /// looking for any other work.
+  ///
+  /// @param[in] worker_index Index of the worker, smaller than the thread count.
+  ///
+  /// @return Pinned awaiter.
+  ///
+  auto ScheduleOn(size_t worker_index)
+  {
+    return PinnedOperation { this, worker_index };
+  }
+
+  ///
+  /// Returns an awaiter that adds the awaiting coroutine to a batch instead of scheduling it right away. The coroutine
+  /// is scheduled when the batch is submitted.
+  ///
+  /// @param[in] batch Batch to add the coroutine to.
+  /// @param[in] priority Lane to schedule the coroutine in.
+  ///
+  /// @return Batch awaiter.
+  ///
+  auto Schedule(Batch& batch, SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return BatchOperation { this, batch, priority };
+  }
+
+  ///
+  /// Returns an awaiter that will resume the awaiting coroutine on the thread pool once the duration has elapsed.
+  ///
+  /// No thread is blocked while waiting. Timers are kept by a single timer thread, started the first time a timer is
+  /// used, which schedules the coroutines when they expire.
+  ///
+  /// @tparam Rep Duration representation type.
+  /// @tparam Period Duration period type.
+  ///
+  /// @param[in] duration Minimum amount of time to wait for.
+  /// @param[in] priority Lane to schedule the coroutine in when the timer expires.
+  ///
+  /// @return Timer awaiter.
+  ///
+  template<typename Rep, typename Period>
+  auto SleepFor(std::chrono::duration<Rep, Period> duration, SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return SleepFor(duration, CancellationToken {}, priority);
+  }
+
+  ///
+  /// Returns an awaiter that will resume the awaiting coroutine on the thread pool once the duration has elapsed, or
+  /// as soon as cancellation is requested.
+  ///
+  /// @tparam Rep Duration representation type.
+  /// @tparam Period Duration period type.
+  ///
+  /// @param[in] duration Minimum amount of time to wait for.
+  /// @param[in] token Token that cancels the wait.
+  /// @param[in] priority Lane to schedule the coroutine in when the timer expires or is cancelled.
+  ///
+  /// @return Timer awaiter. Results in true if the timer expired, false if it was cancelled.
+  ///
+  template<typename Rep, typename Period>
+  auto SleepFor(std::chrono::duration<Rep, Period> duration,
+    CancellationToken token,
+    SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return SleepUntil(Clock::now() + std::chrono::ceil<Clock::duration>(duration), std::move(token), priority);
+  }
+
+  ///
+  /// Returns an awaiter that will resume the awaiting coroutine on the thread pool once the deadline is reached, or
+  /// as soon as cancellation is requested.
+  ///
+  /// Deadlines that are already reached behave like a regular schedule.
+  ///
+  /// @param[in] deadline Point in time to wait until.
+  /// @param[in] token Token that cancels the wait.
+  /// @param[in] priority Lane to schedule the coroutine in when the timer expires or is cancelled.
+  ///
+  /// @return Timer awaiter. Results in true if the timer expired, false if it was cancelled.
+  ///
+  auto SleepUntil(
+    Clock::time_point deadline, CancellationToken token, SchedulePriority priority = SchedulePriority::Normal)
+  {
+    return TimerOperation { this, deadline, std::move(token), priority };
+  }
+
+  ///
+  /// Returns an awaiter that will resume the awaiting coroutine on the thread pool once the deadline is reached.
+  ///
+  /// @param[in] deadline Point in time to wait until.
+  /// @param[in] priority Lane to schedule the coroutine in when the timer expires.
+  ///
+  /// @return Timer awaiter.
+  ///
+  auto SleepUntil(Clock::time_point deadline, SchedulePriority priority = SchedulePriority::Normal)
   {
-    return Operation { this };
+    return SleepUntil(deadline, CancellationToken {}, priority);
   }
 
+  ///
+  /// Schedules every coroutine of a batch at once, then empties the batch.
+  ///
+  /// The whole batch is published with a single lock in the shared mode, or a single atomic splice per lane in the
+  /// work stealing mode, and only as many workers as there are operations are woken up.
+  ///
+  /// @param[in] batch Batch to submit.
+  ///
+  void Submit(Batch& batch);
+
+  ///
+  /// Executes one queued operation on the calling thread, if there is one.
+  ///
+  /// Lets a thread that waits on the pool help it instead of sitting idle. Operations pinned to a worker are never
+  /// executed this way.
+  ///
+  /// @return True if an operation was executed, false if none was queued.
+  ///
+  bool TryRunOne();
+
+  ///
+  /// Sets the scheduler policy and priority of a worker thread.
+  ///
+  /// Lets latency critical workers run ahead of other threads of the process, like logging or background threads, or
+  /// keeps background workers out of their way.
+  ///
+  /// @see SetThreadPriority for eligible priorities and privileges.
+  ///
+  /// @param[in] worker_index Index of the worker, smaller than the thread count.
+  /// @param[in] policy Scheduler policy to use for the worker.
+  /// @param[in] priority Priority of the worker.
+  ///
+  /// @return True if the priority was set, false if it is not supported or the process lacks the privileges.
+  ///
+  bool SetWorkerPriority(size_t worker_index, ThreadSchedulerPolicy policy, int priority);
+
   ///
   /// Returns amount of worker threads contained by this thread pool.
   ///
@@ -62,8 +301,56 @@ public:
     return thread_count_;
   }
 
+  ///
+  /// Returns a snapshot of the counters of every worker.
+  ///
+  /// Counters are updated by the workers without synchronization, so the snapshot is only approximate while the pool is
+  /// busy.
+  ///
+  /// @return Counters of every worker, in worker order.
+  ///
+  [[nodiscard]] std::vector<ThreadPoolWorkerStats> Stats() const;
+
+  ///
+  /// Returns the strategy used to distribute operations between workers.
+  ///
+  /// @return Thread pool mode.
+  ///
+  [[nodiscard]] constexpr ThreadPoolMode Mode() const noexcept
+  {
+    return mode_;
+  }
+
+  ///
+  /// Returns the amount of worker groups. Workers of a group share a L3 cache or a NUMA node.
+  ///
+  /// @note Always 1 in the shared mode or when the CPU topology is unknown.
+  ///
+  /// @return Amount of worker groups.
+  ///
+  [[nodiscard]] constexpr size_t GroupCount() const noexcept
+  {
+    return group_count_;
+  }
+
 private:
+  static constexpr size_t cLaneCount = 3; // One per schedule priority
+
+  // Amount of operations a worker looks for before looking at the lowest priority lane first.
+  static constexpr size_t cStarvationInterval = 64;
+
+  // Locality of operations scheduled without a hint.
+  static constexpr size_t cNoLocality = static_cast<size_t>(-1);
+
   class WorkQueue;
+  class InjectionQueue;
+  class BatchOperation;
+  class TimerOperation;
+  class PinnedOperation;
+  struct Worker;
+  struct Group;
+  struct WorkerCounters;
+  struct Parker;
 
   ///
   /// Represents a queued operation for the thread pool. Contains the handle to the coroutine.
@@ -74,9 +361,15 @@ private:
     ///
     /// Constructor.
     ///
-    /// @param[in] pool
+    /// @param[in] pool Thread pool to schedule on.
+    /// @param[in] priority Lane to schedule in.
+    /// @param[in] locality Locality hint key.
     ///
-    constexpr Operation(ThreadPool* pool) noexcept : pool_(pool), next_(nullptr) {}
+    constexpr Operation(ThreadPool* pool,
+      SchedulePriority priority = SchedulePriority::Normal,
+      size_t locality = cNoLocality) noexcept
+      : pool_(pool), next_(nullptr), locality_(locality), priority_(priority)
+    {}
 
     bool await_ready() const noexcept
     {
@@ -109,137 +402,961 @@ private:
     ///
     void Execute() const
     {
-      handle_.resume();
+      details::ResumeIsolated(handle_);
+    }
+
+    ///
+    /// Returns the index of the lane the operation is scheduled in.
+    ///
+    /// @return Lane index.
+    ///
+    [[nodiscard]] constexpr size_t Lane() const noexcept
+    {
+      return static_cast<size_t>(priority_);
+    }
+
+    ///
+    /// Returns the locality hint key of the operation.
+    ///
+    /// @return Locality hint key, no locality if the operation was scheduled without a hint.
+    ///
+    [[nodiscard]] constexpr size_t Locality() const noexcept
+    {
+      return locality_;
     }
 
   private:
     friend class WorkQueue;
+    friend class InjectionQueue;
+    friend class Batch;
+    friend class BatchOperation;
+    friend class TimerOperation;
+    friend class PinnedOperation;
 
     ThreadPool* pool_;
 
     std::coroutine_handle<> handle_;
     Operation* next_;
+
+    size_t locality_;
+    SchedulePriority priority_;
   };
 
-  class WorkQueue
+public:
+  ///
+  /// Awaiter returned by a regular schedule.
+  ///
+  /// Calling await_suspend on it schedules a suspended coroutine from anywhere, which lets synchronization primitives
+  /// resume their waiters on the pool instead of inline. It must stay alive until the coroutine is resumed.
+  ///
+  using ScheduleAwaiter = Operation;
+
+  ///
+  /// Trigger that is done once fired, for a thread that helps the pool until then. The helping thread parks on the
+  /// flag itself, so firing wakes up that thread alone.
+  ///
+  class HelpFlag
   {
   public:
     ///
     /// Default constructor.
     ///
-    constexpr WorkQueue() noexcept : head_(nullptr), tail_(&head_) {}
+    constexpr HelpFlag() noexcept : state_(0), next_(nullptr) {}
 
-    WorkQueue(WorkQueue& other) = delete;
-    WorkQueue& operator=(WorkQueue& other) = delete;
+    ///
+    /// Marks the flag as done and wakes up the helping thread.
+    ///
+    void Fire() noexcept
+    {
+      state_.fetch_or(cDone, std::memory_order_release);
+      state_.notify_one();
+    }
 
     ///
-    /// Adds an operation to the back of the queue.
+    /// Returns whether or not the flag was fired.
     ///
-    /// @param[in] task Task to add.
+    /// @return True if fired.
     ///
-    void Enqueue(Operation* task) noexcept
+    [[nodiscard]] bool IsDone() const noexcept
     {
-      ASSERT(!task->next_, "Task next must be nullptr");
+      return (state_.load(std::memory_order_acquire) & cDone) != 0;
+    }
 
-      tail_.load(std::memory_order_acquire)->next_ = task;
-      tail_ = task;
+  private:
+    friend class ThreadPool;
+
+    static constexpr uint32_t cDone = 1;
+    static constexpr uint32_t cWakeUp = 2; // Added by the pool to wake up the helping thread for new work
+
+    std::atomic<uint32_t> state_;
+    HelpFlag* next_; // Next parked helping thread, protected by the lock of the pool
+  };
+
+  ///
+  /// Executes queued operations on the calling thread until the flag is fired. Parks on the flag while there is
+  /// nothing to execute, new work wakes it up when no worker is parked.
+  ///
+  /// @param[in] flag Flag to wait for.
+  ///
+  void HelpUntil(HelpFlag& flag);
+
+  ///
+  /// Coroutines waiting to be scheduled together.
+  ///
+  /// Coroutines are added to the batch by awaiting a batch schedule, which suspends them without scheduling them. The
+  /// batch is then submitted to the pool, which schedules all of them with a single publication. This is cheaper than
+  /// scheduling every coroutine on its own when starting many at once.
+  ///
+  /// @code
+  /// ThreadPool::Batch batch;
+  ///
+  /// for (auto& task : tasks)
+  /// {
+  ///   task.Start(); // Runs until co_await pool.Schedule(batch)
+  /// }
+  ///
+  /// pool.Submit(batch);
+  /// @endcode
+  ///
+  /// @warning Not thread safe, a batch must be filled and submitted by a single thread.
+  ///
+  class Batch
+  {
+  public:
+    ///
+    /// Default constructor.
+    ///
+    constexpr Batch() noexcept : heads_ {}, tails_ {}, sizes_ {} {}
+
+#ifndef NDEBUG
+    ///
+    /// Destructor.
+    ///
+    ~Batch() noexcept
+    {
+      ASSERT(Empty(), "Batch destroyed without being submitted");
     }
+#endif
+
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
 
     ///
-    /// Removes the operation from the front of the queue.
+    /// Returns the amount of coroutines in the batch.
     ///
-    void Dequeue() noexcept
+    /// @return Amount of coroutines.
+    ///
+    [[nodiscard]] constexpr size_t Size() const noexcept
     {
-      ASSERT(!Empty(), "Queue cannot be empty");
+      size_t size = 0;
 
-      head_.next_ = head_.next_->next_;
+      for (size_t lane_size : sizes_)
+      {
+        size += lane_size;
+      }
 
-      if (head_.next_ == nullptr) tail_.store(&head_, std::memory_order_release);
+      return size;
     }
 
     ///
-    /// Returns the operation at the front of the queue.
-    ///
-    /// @warning Will return the sentinel node if list is empty.
+    /// Returns whether or not the batch is empty.
     ///
-    /// @return Operation at the front of the queue, nullptr if the queue is empty.
+    /// @return True if the batch is empty, false otherwise.
     ///
-    [[nodiscard]] constexpr Operation* Front() const noexcept
+    [[nodiscard]] constexpr bool Empty() const noexcept
     {
-      return head_.next_;
+      return Size() == 0;
     }
 
+  private:
+    friend class ThreadPool;
+    friend class BatchOperation;
+
     ///
-    /// Returns whether or not the queue is empty.
+    /// Adds an operation at the back of the chain of its lane.
     ///
-    /// @return True if the queue is empty, false otherwise.
+    /// @param[in] operation Operation to add.
     ///
-    [[nodiscard]] constexpr bool Empty() const noexcept
+    void Add(Operation* operation) noexcept
     {
-      return !head_.next_;
+      const size_t lane = operation->Lane();
+
+      if (tails_[lane] != nullptr) tails_[lane]->next_ = operation;
+      else
+      {
+        heads_[lane] = operation;
+      }
+
+      tails_[lane] = operation;
+      sizes_[lane]++;
     }
 
     ///
-    /// Returns approximately whether or not the queue has work.
-    ///
-    /// @return True if the queue might have work, false otherwise.
+    /// Forgets every operation, after they were submitted.
     ///
-    [[nodiscard]] bool HasWorkApprox() const noexcept
+    void Clear() noexcept
     {
-      return tail_.load(std::memory_order_acquire) != &head_;
+      for (size_t lane = 0; lane != cLaneCount; lane++)
+      {
+        heads_[lane] = nullptr;
+        tails_[lane] = nullptr;
+        sizes_[lane] = 0;
+      }
     }
 
   private:
-    Operation head_; // Sentinel Node
-    std::atomic<Operation*> tail_;
+    Operation* heads_[cLaneCount]; // Chain of operations of every lane, in the order they were added
+    Operation* tails_[cLaneCount];
+    size_t sizes_[cLaneCount];
   };
 
 private:
   ///
-  /// Executed by every worker thread to enter work loop.
-  ///
-  /// Loops and waits for work to be processed until flagged to finish.
+  /// Represents an operation waiting in a batch.
   ///
-  void RunWorker();
+  class BatchOperation : public Operation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] pool Thread pool the batch will be submitted to.
+    /// @param[in] batch Batch to add to.
+    /// @param[in] priority Lane to schedule in.
+    ///
+    constexpr BatchOperation(ThreadPool* pool, Batch& batch, SchedulePriority priority) noexcept
+      : Operation(pool, priority), batch_(batch)
+    {}
 
-  ///
-  /// Enqueues the operation to be executed on a worker thread.
-  ///
-  /// @param[in] operation Operation to enqueue.
-  ///
-  void Enqueue(Operation* operation);
+    ///
+    /// Called after suspension. Adds the operation to the batch.
+    ///
+    /// @param[in] awaiting Awaiting coroutine.
+    ///
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+      handle_ = awaiting;
 
-  ///
-  /// Creates and initializes all the worker threads.
-  ///
-  void CreateWorkers();
+      batch_.Add(this);
+    }
 
-  ///
-  /// Tries to set the worker thread affinity so that every worker can only run on
-  /// one physical processor.
-  ///
-  /// If the amount of worker threads is greater than the amount of physical processors,
-  /// multiple worker threads can be assigned per physical processor.
-  ///
-  void SetWorkerThreadAffinity();
+  private:
+    Batch& batch_;
+  };
 
   ///
-  /// Destroys all the worker threads.
-  ///
-  /// @warning There should not be any work being scheduled while destroying workers.
+  /// Represents an operation waiting for a timer to expire.
   ///
-  void DestroyWorkers();
-
+  class TimerOperation : public Operation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] pool Thread pool to schedule on.
+    /// @param[in] deadline Point in time to schedule at.
+    /// @param[in] token Token that cancels the timer.
+    /// @param[in] priority Lane to schedule in.
+    ///
+    TimerOperation(
+      ThreadPool* pool, Clock::time_point deadline, CancellationToken token, SchedulePriority priority) noexcept
+      : Operation(pool, priority), deadline_(deadline), token_(std::move(token)), cancelled_(false)
+    {}
+
+    ///
+    /// Move constructor. Only valid before the operation is awaited.
+    ///
+    /// @param[in] other Operation to move.
+    ///
+    TimerOperation(TimerOperation&& other) noexcept
+      : Operation(other), deadline_(other.deadline_), token_(std::move(other.token_)), cancelled_(other.cancelled_)
+    {
+      ASSERT(!other.canceller_, "Cannot move a timer operation once awaited");
+    }
+
+    ///
+    /// Called after suspension. Adds the operation to the timers, or enqueues it right away if the deadline is already
+    /// reached or cancellation was requested.
+    ///
+    /// @param[in] awaiting Awaiting coroutine.
+    ///
+    void await_suspend(std::coroutine_handle<> awaiting)
+    {
+      handle_ = awaiting;
+
+      if (deadline_ <= Clock::now()) pool_->Enqueue(this);
+      else if (token_.IsCancellationRequested())
+      {
+        cancelled_ = true;
+        pool_->Enqueue(this);
+      }
+      else
+      {
+        // Registered before adding the timer, once added the coroutine can be resumed and the operation destroyed.
+        if (token_.CanBeCancelled()) canceller_.emplace(token_, Canceller { this });
+
+        pool_->AddTimer(this);
+      }
+    }
+
+    ///
+    /// Returns whether or not the timer expired.
+    ///
+    /// @return True if the timer expired, false if it was cancelled.
+    ///
+    bool await_resume() const noexcept
+    {
+      return !cancelled_;
+    }
+
+    ///
+    /// Returns the point in time the operation should be scheduled at.
+    ///
+    /// @return Deadline.
+    ///
+    [[nodiscard]] Clock::time_point Deadline() const noexcept
+    {
+      return deadline_;
+    }
+
+  private:
+    friend class ThreadPool;
+
+    ///
+    /// Cancels the timer when cancellation is requested.
+    ///
+    struct Canceller
+    {
+      void operator()() const
+      {
+        operation->pool_->CancelTimer(operation);
+      }
+
+      TimerOperation* operation;
+    };
+
+  private:
+    Clock::time_point deadline_;
+
+    CancellationToken token_;
+    bool cancelled_;
+
+    std::optional<CancellationCallback<Canceller>> canceller_;
+  };
+
+  ///
+  /// Represents an operation that only a specific worker can execute.
+  ///
+  class PinnedOperation : public Operation
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] pool Thread pool to schedule on.
+    /// @param[in] worker_index Index of the worker to execute on.
+    ///
+    PinnedOperation(ThreadPool* pool, size_t worker_index) noexcept : Operation(pool), worker_index_(worker_index)
+    {
+      ASSERT(worker_index < pool->ThreadCount(), "Worker index out of range");
+    }
+
+    ///
+    /// Called after suspension. Enqueues the operation into the mailbox of the worker.
+    ///
+    /// @param[in] awaiting Awaiting coroutine.
+    ///
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+      handle_ = awaiting;
+
+      pool_->EnqueueOn(this, worker_index_);
+    }
+
+  private:
+    size_t worker_index_;
+  };
+
+  class WorkQueue
+  {
+  public:
+    ///
+    /// Default constructor.
+    ///
+    constexpr WorkQueue() noexcept : head_(nullptr), tail_(&head_) {}
+
+    WorkQueue(WorkQueue& other) = delete;
+    WorkQueue& operator=(WorkQueue& other) = delete;
+
+    ///
+    /// Adds an operation to the back of the queue.
+    ///
+    /// @param[in] task Task to add.
+    ///
+    void Enqueue(Operation* task) noexcept
+    {
+      ASSERT(!task->next_, "Task next must be nullptr");
+
+      tail_.load(std::memory_order_acquire)->next_ = task;
+      tail_ = task;
+    }
+
+    ///
+    /// Adds a chain of operations to the back of the queue.
+    ///
+    /// @param[in] first First operation of the chain.
+    /// @param[in] last Last operation of the chain.
+    ///
+    void EnqueueChain(Operation* first, Operation* last) noexcept
+    {
+      ASSERT(!last->next_, "Last next must be nullptr");
+
+      tail_.load(std::memory_order_acquire)->next_ = first;
+      tail_ = last;
+    }
+
+    ///
+    /// Removes the operation from the front of the queue.
+    ///
+    void Dequeue() noexcept
+    {
+      ASSERT(!Empty(), "Queue cannot be empty");
+
+      head_.next_ = head_.next_->next_;
+
+      if (head_.next_ == nullptr) tail_.store(&head_, std::memory_order_release);
+    }
+
+    ///
+    /// Returns the operation at the front of the queue.
+    ///
+    /// @warning Will return the sentinel node if list is empty.
+    ///
+    /// @return Operation at the front of the queue, nullptr if the queue is empty.
+    ///
+    [[nodiscard]] constexpr Operation* Front() const noexcept
+    {
+      return head_.next_;
+    }
+
+    ///
+    /// Returns whether or not the queue is empty.
+    ///
+    /// @return True if the queue is empty, false otherwise.
+    ///
+    [[nodiscard]] constexpr bool Empty() const noexcept
+    {
+      return !head_.next_;
+    }
+
+    ///
+    /// Returns approximately whether or not the queue has work.
+    ///
+    /// @return True if the queue might have work, false otherwise.
+    ///
+    [[nodiscard]] bool HasWorkApprox() const noexcept
+    {
+      return tail_.load(std::memory_order_acquire) != &head_;
+    }
+
+  private:
+    Operation head_; // Sentinel Node
+    std::atomic<Operation*> tail_;
+  };
+
+  ///
+  /// Unbounded lock-free multi-producer multi-consumer queue of operations, linked through the operations themselves.
+  ///
+  /// Producers push with a single compare and swap. Consumers take every queued operation at once with a single
+  /// exchange, which avoids the ABA problem of popping nodes one by one. Taken operations are returned in the order
+  /// they were pushed.
+  ///
+  /// Consumers that take operations one at a time leave the rest in a second list that is already in push order, so
+  /// that every operation is only reordered once.
+  ///
+  class alignas(CACHE_LINE_SIZE) InjectionQueue
+  {
+  public:
+    ///
+    /// Default constructor.
+    ///
+    constexpr InjectionQueue() noexcept : head_(nullptr), ready_(nullptr) {}
+
+    InjectionQueue(InjectionQueue& other) = delete;
+    InjectionQueue& operator=(InjectionQueue& other) = delete;
+
+    ///
+    /// Pushes an operation into the queue.
+    ///
+    /// Can be called by any thread.
+    ///
+    /// @param[in] operation Operation to push.
+    ///
+    void Push(Operation* operation) noexcept
+    {
+      Operation* head = head_.load(std::memory_order_relaxed);
+
+      do
+      {
+        operation->next_ = head;
+      }
+      while (!head_.compare_exchange_weak(head, operation, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    ///
+    /// Pushes a chain of operations into the queue with a single compare and swap.
+    ///
+    /// Can be called by any thread.
+    ///
+    /// @param[in] first First operation of the chain, linked in push order.
+    ///
+    void PushChain(Operation* first) noexcept
+    {
+      // The queue is stacked, reverse the chain so that it comes back out in push order.
+      Operation* last = first;
+      Operation* stack = nullptr;
+
+      while (first != nullptr)
+      {
+        Operation* next = first->next_;
+        first->next_ = stack;
+        stack = first;
+        first = next;
+      }
+
+      Operation* head = head_.load(std::memory_order_relaxed);
+
+      do
+      {
+        last->next_ = head;
+      }
+      while (!head_.compare_exchange_weak(head, stack, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    ///
+    /// Takes every operation currently in the queue.
+    ///
+    /// Can be called by any thread.
+    ///
+    /// @return First of the taken operations linked in push order, nullptr if the queue was empty.
+    ///
+    [[nodiscard]] Operation* TakeAll() noexcept
+    {
+      if (!HasWorkApprox()) return nullptr; // Avoid writing to the cache line when empty
+
+      // Ready operations were pushed before the stacked ones.
+      Operation* ready = ready_.load(std::memory_order_relaxed) ? ready_.exchange(nullptr, std::memory_order_acquire)
+                                                                 : nullptr;
+      Operation* list = TakeStacked();
+
+      if (ready == nullptr) return list;
+
+      Operation* last = ready;
+
+      while (last->next_ != nullptr) last = last->next_;
+
+      last->next_ = list;
+
+      return ready;
+    }
+
+    ///
+    /// Takes the oldest operation in the queue.
+    ///
+    /// Can be called by any thread. Amortized constant time, the operations taken along with it are left in push order
+    /// for the next consumers.
+    ///
+    /// @return Taken operation, nullptr if the queue was empty.
+    ///
+    [[nodiscard]] Operation* TakeOne() noexcept
+    {
+      if (!HasWorkApprox()) return nullptr; // Avoid writing to the cache line when empty
+
+      Operation* list = ready_.load(std::memory_order_relaxed) ? ready_.exchange(nullptr, std::memory_order_acquire)
+                                                                : nullptr;
+
+      if (list == nullptr) list = TakeStacked();
+
+      if (list == nullptr) return nullptr;
+
+      Operation* rest = Unlink(list);
+
+      if (rest != nullptr)
+      {
+        Operation* expected = nullptr;
+
+        // Only fails when another consumer left operations at the same time, which then go back on the stack.
+        if (!ready_.compare_exchange_strong(expected, rest, std::memory_order_release, std::memory_order_relaxed))
+        {
+          PushChain(rest);
+        }
+      }
+
+      return list;
+    }
+
+    ///
+    /// Returns the operation following another in a list returned by TakeAll and unlinks it.
+    ///
+    /// @param[in] operation Operation to unlink.
+    ///
+    /// @return Next operation in the list, nullptr if it was the last.
+    ///
+    [[nodiscard]] static Operation* Unlink(Operation* operation) noexcept
+    {
+      Operation* next = operation->next_;
+      operation->next_ = nullptr;
+      return next;
+    }
+
+    ///
+    /// Returns approximately whether or not the queue has work.
+    ///
+    /// @return True if the queue might have work, false otherwise.
+    ///
+    [[nodiscard]] bool HasWorkApprox() const noexcept
+    {
+      return head_.load(std::memory_order_relaxed) != nullptr || ready_.load(std::memory_order_relaxed) != nullptr;
+    }
+
+  private:
+    ///
+    /// Takes every stacked operation.
+    ///
+    /// @return First of the taken operations linked in push order, nullptr if there were none.
+    ///
+    [[nodiscard]] Operation* TakeStacked() noexcept
+    {
+      if (head_.load(std::memory_order_relaxed) == nullptr) return nullptr;
+
+      Operation* stack = head_.exchange(nullptr, std::memory_order_acquire);
+
+      // The operations are stacked, reverse them to get them back in push order.
+      Operation* list = nullptr;
+
+      while (stack != nullptr)
+      {
+        Operation* next = stack->next_;
+        stack->next_ = list;
+        list = stack;
+        stack = next;
+      }
+
+      return list;
+    }
+
+  private:
+    std::atomic<Operation*> head_; // Stacked, most recently pushed first
+    std::atomic<Operation*> ready_; // In push order, older than every stacked operation
+  };
+
+private:
+  ///
+  /// Executed by every worker thread to enter work loop.
+  ///
+  /// Loops and waits for work to be processed until flagged to finish.
+  ///
+  /// @param[in] index Index of the worker.
+  ///
+  void RunWorker(size_t index);
+
+  ///
+  /// Work loop of a worker when using the shared mode.
+  ///
+  /// @param[in] index Index of the worker running the loop.
+  ///
+  void RunSharedWorker(size_t index);
+
+  ///
+  /// Removes the next operation to execute from the shared queues.
+  ///
+  /// @warning The mutex must be locked.
+  ///
+  /// @param[in] lowest_first Whether or not to look at the lowest priority lane first.
+  ///
+  /// @return Operation to execute, nullptr if the queues are empty.
+  ///
+  Operation* DequeueShared(bool lowest_first) noexcept;
+
+  ///
+  /// Work loop of a worker when using the work stealing mode.
+  ///
+  /// @param[in] worker The worker running the loop.
+  ///
+  void RunStealingWorker(Worker& worker);
+
+  ///
+  /// Tries to find an operation for the worker to execute.
+  ///
+  /// Looks at the lanes from highest to lowest priority, except once every starvation interval where the order is
+  /// reversed.
+  ///
+  /// @param[in] worker Worker looking for work.
+  ///
+  /// @return Operation to execute, nullptr if no work was found.
+  ///
+  Operation* FindWork(Worker& worker);
+
+  ///
+  /// Tries to find an operation for the worker to execute in a single lane.
+  ///
+  /// Looks in order: the worker's own deque, the injection queue and finally the deques of other workers.
+  ///
+  /// @param[in] worker Worker looking for work.
+  /// @param[in] lane Index of the lane to look in.
+  ///
+  /// @return Operation to execute, nullptr if no work was found.
+  ///
+  Operation* FindWorkInLane(Worker& worker, size_t lane);
+
+  ///
+  /// Takes every operation from the injection queue of a group lane and moves them into the worker's deque of that
+  /// lane.
+  ///
+  /// @param[in] worker Worker taking the operations.
+  /// @param[in] group Group to take from.
+  /// @param[in] lane Index of the lane to take from.
+  ///
+  /// @return First taken operation that the worker should execute, nullptr if the queue was empty.
+  ///
+  Operation* TakeInjected(Worker& worker, Group& group, size_t lane);
+
+  ///
+  /// Tries to find an operation for a thread that is not a worker, when using the work stealing mode.
+  ///
+  /// Looks at the lanes from highest to lowest priority, taking from the injection queues first and then stealing from
+  /// the workers.
+  ///
+  /// @return Operation to execute, nullptr if no work was found.
+  ///
+  Operation* FindExternalWork() noexcept;
+
+  ///
+  /// Called by a worker that could not find work. Spins for a while then parks the worker until new work arrives.
+  ///
+  /// The spin budget adapts to how often work arrives: it grows when spinning finds work and shrinks when the worker
+  /// ends up parking anyway.
+  ///
+  /// @param[in,out] spin_limit Spin budget of the worker.
+  /// @param[in] index Index of the worker.
+  ///
+  /// @return True if the worker should keep looking for work, false if it should exit.
+  ///
+  bool Idle(size_t& spin_limit, size_t index);
+
+  ///
+  /// Takes the next operation pinned to a worker. Operations are taken from the mailbox of the worker all at once and
+  /// then executed one by one in the order they were scheduled.
+  ///
+  /// @param[in] index Index of the worker.
+  /// @param[in,out] pinned Operations taken from the mailbox that were not executed yet.
+  ///
+  /// @return Operation to execute, nullptr if nothing is pinned to the worker.
+  ///
+  Operation* TakePinned(size_t index, Operation*& pinned) noexcept;
+
+  ///
+  /// Claims a parked worker, so that no other notifier wakes it up for other work.
+  ///
+  /// @return Index of the claimed worker, the amount of workers if none is parked.
+  ///
+  size_t ClaimParkedWorker() noexcept;
+
+  ///
+  /// Adds a helping thread to the parked helping threads.
+  ///
+  /// @param[in] flag Flag the helping thread waits for.
+  ///
+  void ParkHelper(HelpFlag& flag);
+
+  ///
+  /// Removes a helping thread from the parked helping threads, unless a notifier already did. The flag can be destroyed
+  /// afterwards.
+  ///
+  /// @param[in] flag Flag the helping thread waits for.
+  ///
+  void UnparkHelper(HelpFlag& flag);
+
+  ///
+  /// Wakes up parked helping threads for new work.
+  ///
+  /// @param[in] count Amount of helping threads to wake up.
+  ///
+  void WakeHelpers(size_t count) noexcept;
+
+  ///
+  /// Wakes up one parked worker, or a parked helping thread when no worker is parked.
+  ///
+  /// @warning Must be called after enqueueing the work to wake up for.
+  ///
+  void WakeOne() noexcept;
+
+  ///
+  /// Wakes up as many parked workers as requested, then parked helping threads for the rest.
+  ///
+  /// @warning Must be called after enqueueing the work to wake up for.
+  ///
+  /// @param[in] count Amount of threads to wake up.
+  ///
+  void WakeMany(size_t count) noexcept;
+
+  ///
+  /// Wakes up every parked worker.
+  ///
+  void WakeAll() noexcept;
+
+  ///
+  /// Tries to steal an operation from other workers within a range of the thief's victims.
+  ///
+  /// Victims are ordered by distance: workers of the same group, then of the same NUMA node, then all others.
+  ///
+  /// @param[in] thief Worker that is stealing.
+  /// @param[in] lane Index of the lane to steal from.
+  /// @param[in] begin First victim index.
+  /// @param[in] end Last victim index (exclusive).
+  ///
+  /// @return Stolen operation, nullptr if nothing was stolen.
+  ///
+  Operation* Steal(Worker& thief, size_t lane, size_t begin, size_t end);
+
+  ///
+  /// Returns the group whose injection queue an operation should be pushed into.
+  ///
+  /// @param[in] operation Operation to find group for.
+  /// @param[in] worker Worker of this pool scheduling the operation, nullptr if scheduled from another thread.
+  ///
+  /// @return Group of the operation.
+  ///
+  Group& TargetGroup(const Operation* operation, const Worker* worker) noexcept;
+
+  ///
+  /// Creates the worker groups. Workers sharing a L3 cache, or a NUMA node when the cache is unknown, are grouped.
+  ///
+  /// @param[in] use_topology Whether or not to use the CPU topology, otherwise a single group is created.
+  ///
+  void CreateGroups(bool use_topology);
+
+  ///
+  /// Returns approximately whether or not there is work for a worker to find.
+  ///
+  /// @return True if there might be work, false otherwise.
+  ///
+  bool HasWorkApprox() const noexcept;
+
+  ///
+  /// Enqueues the operation to be executed on a worker thread.
+  ///
+  /// @param[in] operation Operation to enqueue.
+  ///
+  void Enqueue(Operation* operation);
+
+  ///
+  /// Enqueues a chain of operations of the same lane to be executed on worker threads, when using the work stealing
+  /// mode.
+  ///
+  /// @param[in] first First operation of the chain.
+  /// @param[in] amount Amount of operations in the chain.
+  ///
+  void EnqueueChain(Operation* first, size_t amount);
+
+  ///
+  /// Enqueues the operation into the mailbox of a worker, to be executed by that worker only.
+  ///
+  /// @param[in] operation Operation to enqueue.
+  /// @param[in] worker_index Index of the worker.
+  ///
+  void EnqueueOn(Operation* operation, size_t worker_index);
+
+  ///
+  /// Adds a timer operation to the timers, starting the timer thread if needed.
+  ///
+  /// @param[in] operation Timer operation to add.
+  ///
+  void AddTimer(TimerOperation* operation);
+
+  ///
+  /// Removes a timer operation from the timers and schedules it right away, if it did not expire yet.
+  ///
+  /// @param[in] operation Timer operation to cancel.
+  ///
+  void CancelTimer(TimerOperation* operation);
+
+  ///
+  /// Executed by the timer thread. Waits for the earliest timer to expire and schedules every expired timer.
+  ///
+  void RunTimers();
+
+  ///
+  /// Stops the timer thread, if it was started.
+  ///
+  void DestroyTimers();
+
+  ///
+  /// Returns a reference to the worker running on the current thread.
+  ///
+  /// @return Reference to the current worker pointer, nullptr if the current thread is not a worker.
+  ///
+  static Worker*& CurrentWorker() noexcept;
+
+  ///
+  /// Creates and initializes all the worker threads.
+  ///
+  /// @param[in] lock_threads Whether or not workers will be locked to processors. Worker groups are only formed from
+  /// the CPU topology when they are.
+  ///
+  void CreateWorkers(bool lock_threads);
+
+  ///
+  /// Tries to set the worker thread affinity so that every worker can only run on
+  /// one physical processor.
+  ///
+  /// If the amount of worker threads is greater than the amount of physical processors,
+  /// multiple worker threads can be assigned per physical processor.
+  ///
+  void SetWorkerThreadAffinity();
+
+  ///
+  /// Destroys all the worker threads.
+  ///
+  /// @warning There should not be any work being scheduled while destroying workers.
+  ///
+  void DestroyWorkers();
+
 private:
   std::mutex mutex_;
 
-  bool running_;
-  std::condition_variable condition_;
+  std::atomic_bool running_;
 
-  WorkQueue queue_;
+  std::mutex helpers_mutex_; // Protects the list of parked helping threads
+  HelpFlag* parked_helpers_;
+  std::atomic_size_t parked_helper_count_; // Lets notifiers skip the lock when no helping thread is parked
+
+  WorkQueue queues_[cLaneCount];
 
   std::thread* threads_;
   size_t thread_count_;
+
+  ThreadPoolMode mode_;
+
+  Worker* workers_;
+  WorkerCounters* counters_; // One per worker, in both modes
+  InjectionQueue* mailboxes_; // One per worker, in both modes. Holds the operations pinned to the worker
+  Parker* parkers_; // One per worker, in both modes. Lets a worker be woken up alone
+  std::atomic_uint64_t* parked_; // Bit per worker, set while the worker is parked or about to park
+
+  Group* groups_;
+  size_t group_count_;
+  std::atomic_size_t next_group_; // Round robin for external operations without a locality hint
+
+  // Amount of operations waiting in every lane, except the normal lane which is the hot path and is not counted. Lets
+  // workers skip looking at lanes that are empty.
+  std::atomic_size_t pending_[cLaneCount];
+
+  std::mutex timer_mutex_;
+  std::condition_variable timer_condition_;
+  std::vector<TimerOperation*> timers_; // Min heap on the deadline
+  std::thread timer_thread_;
+  bool timers_running_;
 };
 
 template<>
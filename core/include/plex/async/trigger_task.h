@@ -27,7 +27,7 @@ namespace details
   /// @tparam Trigger Trigger used to fire events.
   ///
   template<Trigger Trigger>
-  class TriggerTaskPromiseBase
+  class TriggerTaskPromiseBase : public TaskContextCarrier
   {
   public:
     ///
@@ -69,13 +69,14 @@ namespace details
     };
 
     ///
-    /// Initially suspended to allow setting the trigger before manually resuming.
+    /// Initially suspended to allow setting the trigger before manually resuming. Takes the task context of the thread
+    /// that starts it.
     ///
-    /// @return Always suspend.
+    /// @return Initial awaiter.
     ///
-    std::suspend_always initial_suspend() const noexcept
+    InitialAwaiter initial_suspend() noexcept
     {
-      return {};
+      return InitialSuspend();
     }
 
     ///
@@ -100,6 +101,8 @@ namespace details
 
     COROUTINE_UNHANDLED_EXCEPTION;
 
+    COROUTINE_FRAME_ALLOCATOR
+
   private:
     Trigger* trigger_;
   };
@@ -229,7 +232,7 @@ public:
   void Start(Trigger& trigger) const noexcept
   {
     Handle<promise_type>().promise().SetTrigger(&trigger);
-    Handle<promise_type>().resume();
+    details::ResumeIsolated(Handle<promise_type>());
   }
 
   ///
@@ -103,7 +103,7 @@ public:
   bool TryAwait(std::coroutine_handle<> awaiting) noexcept
   {
     continuation_ = awaiting;
-    return counter_.fetch_sub(1, std::memory_order_release) != 0;
+    return counter_.fetch_sub(1, std::memory_order_acq_rel) != 0;
   }
 
   ///
@@ -111,7 +111,9 @@ public:
   ///
   void Fire() noexcept
   {
-    if (counter_.fetch_sub(1, std::memory_order_acquire) == 0) continuation_.resume();
+    // Needs release so that the writes of every fired awaitable are visible to the continuation.
+    // Needs acquire to see the continuation and the writes of the other fired awaitables.
+    if (counter_.fetch_sub(1, std::memory_order_acq_rel) == 0) details::ResumeIsolated(continuation_);
   }
 
 private:
@@ -152,7 +154,7 @@ public:
   bool TryAwait(std::coroutine_handle<> awaiting) noexcept
   {
     continuation_ = awaiting;
-    return !flag_.exchange(true, std::memory_order_release);
+    return !flag_.exchange(true, std::memory_order_acq_rel);
   }
 
   ///
@@ -160,7 +162,8 @@ public:
   ///
   void Fire()
   {
-    if (flag_.exchange(true, std::memory_order_acquire)) continuation_.resume();
+    // Needs release so that the writes of the fired awaitable are visible to the continuation.
+    if (flag_.exchange(true, std::memory_order_acq_rel)) details::ResumeIsolated(continuation_);
   }
 
 private:
@@ -0,0 +1,192 @@
+#ifndef PLEX_ASYNC_WHEN_ANY_H
+#define PLEX_ASYNC_WHEN_ANY_H
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <variant>
+
+#include "plex/async/cancellation.h"
+#include "plex/async/trigger_task.h"
+#include "plex/async/when_all.h"
+
+namespace plex
+{
+///
+/// Result of a when any. Holds the result of the awaitable that completed first, the index of the alternative is the
+/// index of the awaitable.
+///
+/// @note If an awaitable has a void result, the alternative for that awaitable is VoidAwaitResult.
+///
+/// @tparam Awaitables All the awaitables types.
+///
+template<typename... Awaitables>
+using AnyAwaitResult =
+  std::variant<std::conditional_t<std::is_void_v<typename AwaitableTraits<Awaitables>::AwaitResultType>,
+    VoidAwaitResult,
+    typename std::remove_reference_t<typename AwaitableTraits<Awaitables>::AwaitResultType>>...>;
+
+namespace details
+{
+  ///
+  /// Shared state of a when any. Remembers which awaitable completed first and counts down the awaitables left.
+  ///
+  class WhenAnyState
+  {
+  public:
+    ///
+    /// Constructor.
+    ///
+    /// @param[in] source Source to request cancellation on once the first awaitable completes.
+    /// @param[in] amount Amount of awaitables.
+    ///
+    WhenAnyState(CancellationSource source, size_t amount) noexcept
+      : source_(std::move(source)), counter_(amount), winner_(cNoWinner)
+    {}
+
+    ///
+    /// Sets the awaiter as the continuation and awaits until every awaitable completed.
+    ///
+    /// @return Awaiter.
+    ///
+    auto operator co_await() noexcept
+    {
+      return counter_.operator co_await();
+    }
+
+    ///
+    /// Marks an awaitable as completed. The first one requests cancellation of the others, the last one resumes the
+    /// continuation.
+    ///
+    /// @param[in] index Index of the completed awaitable.
+    ///
+    void Complete(size_t index) noexcept
+    {
+      size_t expected = cNoWinner;
+
+      if (winner_.compare_exchange_strong(expected, index, std::memory_order_relaxed)) source_.Cancel();
+
+      counter_.Fire();
+    }
+
+    ///
+    /// Returns the index of the awaitable that completed first.
+    ///
+    /// @return Index of the first completed awaitable.
+    ///
+    [[nodiscard]] size_t Winner() const noexcept
+    {
+      return winner_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr size_t cNoWinner = std::numeric_limits<size_t>::max();
+
+    CancellationSource source_;
+
+    WhenAllCounter counter_;
+
+    std::atomic_size_t winner_;
+  };
+
+  ///
+  /// Trigger fired by the awaitable at a given index of a when any.
+  ///
+  struct WhenAnyTrigger
+  {
+    ///
+    /// Marks the awaitable as completed.
+    ///
+    void Fire() noexcept
+    {
+      state->Complete(index);
+    }
+
+    WhenAnyState* state;
+    size_t index;
+  };
+
+  ///
+  /// Starts a trigger task for every awaitable and waits for all of them, then returns the result of the first one to
+  /// complete.
+  ///
+  /// @tparam Indices Indices of the awaitables.
+  /// @tparam Awaitables All awaitable types to co_await.
+  ///
+  /// @param[in] source Source to request cancellation on once the first awaitable completes.
+  /// @param[in] awaitables All awaitables to co_await.
+  ///
+  /// @return Task that returns the result of the first awaitable to complete.
+  ///
+  template<size_t... Indices, Awaitable... Awaitables>
+  Task<AnyAwaitResult<Awaitables...>> WhenAny(
+    std::index_sequence<Indices...>, CancellationSource source, Awaitables&&... awaitables)
+  {
+    WhenAnyState state(std::move(source), sizeof...(Awaitables));
+
+    std::array<WhenAnyTrigger, sizeof...(Awaitables)> triggers { WhenAnyTrigger { &state, Indices }... };
+
+    auto trigger_tasks = std::make_tuple(
+      [&triggers](Awaitables&& awaitable, size_t index)
+      {
+        auto trigger_task = MakeTriggerTask<WhenAnyTrigger>(std::forward<Awaitables>(awaitable));
+        trigger_task.Start(triggers[index]);
+        return trigger_task;
+      }(std::forward<Awaitables>(awaitables), Indices)...);
+
+    co_await state;
+
+    std::optional<AnyAwaitResult<Awaitables...>> result;
+
+    const size_t winner = state.Winner();
+
+    (
+      [&]()
+      {
+        if (Indices != winner) return;
+
+        if constexpr (std::is_void_v<typename AwaitableTraits<Awaitables>::AwaitResultType>)
+          result.emplace(std::in_place_index<Indices>, VoidAwaitResult {});
+        else
+          result.emplace(std::in_place_index<Indices>, std::move(std::get<Indices>(trigger_tasks)).Result());
+      }(),
+      ...);
+
+    co_return std::move(*result);
+  }
+} // namespace details
+
+///
+/// Creates a new awaitable that completes with the result of the first input awaitable to complete. If the awaitables
+/// complete asynchronously, they will all be executed concurrently.
+///
+/// As soon as the first awaitable completes, cancellation is requested on the source. The awaitable still completes
+/// only once every input awaitable completed, so the other awaitables should observe a token of the source to stop
+/// early. This keeps every awaitable alive for as long as it runs.
+///
+/// @code
+/// CancellationSource source;
+///
+/// auto result = co_await WhenAny(source, FindPath(source.Token()), pool.SleepFor(budget, source.Token()));
+///
+/// if (result.index() == 0) Follow(std::get<0>(result));
+/// @endcode
+///
+/// @tparam Awaitables All awaitable types to co_await.
+///
+/// @param[in] source Source to request cancellation on once the first awaitable completes.
+/// @param[in] awaitables All awaitables to co_await.
+///
+/// @return Task that returns the result of the first awaitable to complete.
+///
+template<Awaitable... Awaitables>
+requires(sizeof...(Awaitables) > 0)
+Task<AnyAwaitResult<Awaitables...>> WhenAny(CancellationSource source, Awaitables&&... awaitables)
+{
+  return details::WhenAny(
+    std::index_sequence_for<Awaitables...> {}, std::move(source), std::forward<Awaitables>(awaitables)...);
+}
+} // namespace plex
+
+#endif
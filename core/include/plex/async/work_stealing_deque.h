@@ -0,0 +1,190 @@
+#ifndef PLEX_ASYNC_WORK_STEALING_DEQUE_H
+#define PLEX_ASYNC_WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "plex/debug/assertion.h"
+#include "plex/os/cpu_info.h"
+
+namespace plex
+{
+///
+/// Bounded lock-free Chase-Lev work-stealing deque of pointers.
+///
+/// The deque has a single owner that pushes and pops at the bottom (LIFO), while any amount of other threads can steal
+/// from the top (FIFO). The owner side is wait-free, stealing is lock-free.
+///
+/// Unlike the original algorithm the buffer never grows. Pushing into a full deque fails and the caller is expected to
+/// overflow somewhere else. This avoids having to reclaim old buffers while thieves may still be reading them.
+///
+/// @note Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli).
+///
+/// @tparam Type Type of the pointed elements.
+/// @tparam Capacity Maximum amount of elements, must be a power of two.
+///
+template<typename Type, size_t Capacity>
+class WorkStealingDeque
+{
+public:
+  static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+  ///
+  /// Default constructor.
+  ///
+  WorkStealingDeque() noexcept : top_(0), bottom_(0), buffer_ {} {}
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  ///
+  /// Pushes an element at the bottom of the deque.
+  ///
+  /// @warning Must only be called by the owner.
+  ///
+  /// @param[in] item Element to push.
+  ///
+  /// @return True if the element was pushed, false if the deque is full.
+  ///
+  bool Push(Type* item) noexcept
+  {
+    ASSERT(item != nullptr, "Cannot push nullptr");
+
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+
+    if (bottom - top >= static_cast<int64_t>(Capacity)) return false;
+
+    buffer_[Index(bottom)].store(item, std::memory_order_relaxed);
+
+    // Needs release so that the element (and what it points to) is visible to thieves that see the new bottom.
+    bottom_.store(bottom + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  ///
+  /// Pops the element at the bottom of the deque (Last pushed).
+  ///
+  /// @warning Must only be called by the owner.
+  ///
+  /// @return Popped element, nullptr if the deque was empty.
+  ///
+  Type* Pop() noexcept
+  {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+
+    bottom_.store(bottom, std::memory_order_relaxed);
+
+    // Reserve the bottom element before looking at the top, pairs with the fence in Steal.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) // Empty
+    {
+      bottom_.store(bottom + 1, std::memory_order_release);
+      return nullptr;
+    }
+
+    Type* item = buffer_[Index(bottom)].load(std::memory_order_relaxed);
+
+    if (top == bottom)
+    {
+      // Last element, race against thieves for it.
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      {
+        item = nullptr;
+      }
+
+      bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    return item;
+  }
+
+  ///
+  /// Steals the element at the top of the deque (First pushed).
+  ///
+  /// Can be called by any thread.
+  ///
+  /// @note May spuriously fail and return nullptr when racing with other thieves or the owner.
+  ///
+  /// @return Stolen element, nullptr if nothing was stolen.
+  ///
+  Type* Steal() noexcept
+  {
+    int64_t top = top_.load(std::memory_order_acquire);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+    if (top >= bottom) return nullptr; // Empty
+
+    Type* item = buffer_[Index(top)].load(std::memory_order_relaxed);
+
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+      return nullptr; // Lost the race
+    }
+
+    return item;
+  }
+
+  ///
+  /// Returns approximately the amount of elements in the deque.
+  ///
+  /// @return Approximate amount of elements.
+  ///
+  [[nodiscard]] size_t SizeApprox() const noexcept
+  {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_relaxed);
+
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  ///
+  /// Returns approximately whether or not the deque is empty.
+  ///
+  /// @return True if the deque might be empty, false otherwise.
+  ///
+  [[nodiscard]] bool EmptyApprox() const noexcept
+  {
+    return SizeApprox() == 0;
+  }
+
+  ///
+  /// Returns the maximum amount of elements the deque can hold.
+  ///
+  /// @return Capacity of the deque.
+  ///
+  [[nodiscard]] static constexpr size_t MaxSize() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+  ///
+  /// Returns the buffer index for a position.
+  ///
+  /// @param[in] position Position to wrap.
+  ///
+  /// @return Buffer index.
+  ///
+  [[nodiscard]] static constexpr size_t Index(int64_t position) noexcept
+  {
+    return static_cast<size_t>(position) & (Capacity - 1);
+  }
+
+private:
+  // Top and bottom are on separate cache lines since they are written by different threads.
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_;
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_;
+  alignas(CACHE_LINE_SIZE) std::atomic<Type*> buffer_[Capacity];
+};
+} // namespace plex
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef PLEX_CONTAINERS_BIT_SET_H
+#define PLEX_CONTAINERS_BIT_SET_H
+
+#include <bit>
+#include <cstdint>
+
+#include "plex/containers/vector.h"
+
+namespace plex
+{
+///
+/// Dynamically sized set of bits.
+///
+/// Grows when bits past its size are set. Bits past the size are considered to be zero, so sets of different sizes can
+/// be combined without resizing first.
+///
+/// Operations over whole sets are simple loops over words that the compiler vectorizes.
+///
+class BitSet
+{
+public:
+  using IsTriviallyRelocatable = std::true_type;
+
+  using Word = uint64_t;
+
+  static constexpr size_t cWordBits = sizeof(Word) * 8;
+
+  ///
+  /// Default constructor. Every bit is zero.
+  ///
+  BitSet() noexcept = default;
+
+  ///
+  /// Constructs a set able to hold the amount of bits without growing. Every bit is zero.
+  ///
+  /// @param[in] bits Amount of bits.
+  ///
+  explicit BitSet(size_t bits)
+  {
+    words_.resize((bits + cWordBits - 1) / cWordBits);
+  }
+
+  ///
+  /// Sets a bit to one. Grows the set if needed.
+  ///
+  /// @param[in] index Index of the bit.
+  ///
+  void Set(size_t index)
+  {
+    const size_t word = index / cWordBits;
+
+    if (word >= words_.size()) words_.resize(word + 1);
+
+    words_[word] |= Word { 1 } << (index % cWordBits);
+  }
+
+  ///
+  /// Sets a bit to zero.
+  ///
+  /// @param[in] index Index of the bit.
+  ///
+  void Reset(size_t index) noexcept
+  {
+    const size_t word = index / cWordBits;
+
+    if (word < words_.size()) words_[word] &= ~(Word { 1 } << (index % cWordBits));
+  }
+
+  ///
+  /// Sets every bit to zero.
+  ///
+  void Clear() noexcept
+  {
+    for (Word& word : words_)
+    {
+      word = 0;
+    }
+  }
+
+  ///
+  /// Returns whether or not a bit is one.
+  ///
+  /// @param[in] index Index of the bit.
+  ///
+  /// @return True if the bit is one, false otherwise.
+  ///
+  [[nodiscard]] bool Test(size_t index) const noexcept
+  {
+    const size_t word = index / cWordBits;
+
+    return word < words_.size() && (words_[word] >> (index % cWordBits)) & 1;
+  }
+
+  ///
+  /// Returns whether or not both sets have a bit that is one at the same index.
+  ///
+  /// @param[in] other Other set.
+  ///
+  /// @return True if the sets intersect, false otherwise.
+  ///
+  [[nodiscard]] bool Intersects(const BitSet& other) const noexcept
+  {
+    const size_t size = words_.size() < other.words_.size() ? words_.size() : other.words_.size();
+
+    Word intersection = 0;
+
+    // No early exit, so that the loop is vectorized. Sets are usually only a few words long.
+    for (size_t i = 0; i < size; i++)
+    {
+      intersection |= words_[i] & other.words_[i];
+    }
+
+    return intersection != 0;
+  }
+
+  ///
+  /// Returns whether or not every bit is zero.
+  ///
+  /// @return True if no bit is one, false otherwise.
+  ///
+  [[nodiscard]] bool None() const noexcept
+  {
+    Word bits = 0;
+
+    for (const Word word : words_)
+    {
+      bits |= word;
+    }
+
+    return bits == 0;
+  }
+
+  ///
+  /// Returns the amount of bits that are one.
+  ///
+  /// @return Amount of bits that are one.
+  ///
+  [[nodiscard]] size_t Count() const noexcept
+  {
+    size_t count = 0;
+
+    for (const Word word : words_)
+    {
+      count += static_cast<size_t>(std::popcount(word));
+    }
+
+    return count;
+  }
+
+  ///
+  /// Sets every bit that is one in the other set. Grows the set if needed.
+  ///
+  /// @param[in] other Other set.
+  ///
+  /// @return Reference to this set.
+  ///
+  BitSet& operator|=(const BitSet& other)
+  {
+    if (other.words_.size() > words_.size()) words_.resize(other.words_.size());
+
+    for (size_t i = 0; i < other.words_.size(); i++)
+    {
+      words_[i] |= other.words_[i];
+    }
+
+    return *this;
+  }
+
+  ///
+  /// Returns the amount of bits the set can hold without growing.
+  ///
+  /// @return Capacity in bits.
+  ///
+  [[nodiscard]] size_t Size() const noexcept
+  {
+    return words_.size() * cWordBits;
+  }
+
+private:
+  Vector<Word> words_;
+};
+} // namespace plex
+
+#endif
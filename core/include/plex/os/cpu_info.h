@@ -2,14 +2,17 @@
 #define PLEX_OS_CPU_INFO_H
 
 #include <atomic>
+#include <cstdint>
+#include <new>
 #include <vector>
 
 namespace plex
 {
 // Cache line size.
 // Sometimes this is not implemented, so we assume 64 bytes. (64 bytes on x86-64)
-#ifdef __cpp_lib_hardware_interference_size
-#define CACHE_LINE_SIZE = std::hardware_destructive_interference_size
+// GCC warns about using the standard value in headers since it depends on tuning flags, so we also assume 64 bytes.
+#if defined(__cpp_lib_hardware_interference_size) && !(defined(__GNUC__) && !defined(__clang__))
+#define CACHE_LINE_SIZE std::hardware_destructive_interference_size
 #else
 #define CACHE_LINE_SIZE 64
 #endif
@@ -19,7 +22,10 @@ namespace plex
 ///
 struct ProcessorInfo
 {
-  uint64_t mask;
+  uint64_t mask; // Logical processors of the physical processor (SMT siblings)
+
+  uint32_t package; // Physical package (socket) the processor is in
+  uint32_t numa_node; // NUMA node the processor is in
 };
 
 ///
@@ -42,16 +48,34 @@ struct CacheInfo
   uint32_t level;
   uint32_t size;
   uint32_t line_size;
+
+  uint64_t mask; // Logical processors sharing the cache
 };
 
 ///
-/// Holds information about a physical processor.
+/// Holds information about a NUMA node.
+///
+struct NumaNodeInfo
+{
+  uint32_t id;
+  uint64_t mask; // Logical processors in the node
+};
+
+///
+/// Holds information about the CPU.
+///
+/// Every cache is listed once per instance, a L1 cache per physical processor will be listed once for every physical
+/// processor.
+///
+/// @note Logical processors are represented with 64 bit masks, only the first 64 logical processors are listed.
 ///
 struct CPUInfo
 {
   std::vector<ProcessorInfo> processors;
 
   std::vector<CacheInfo> caches;
+
+  std::vector<NumaNodeInfo> numa_nodes;
 };
 
 ///
@@ -81,6 +105,17 @@ size_t GetAmountPhysicalProcessors();
 ///
 size_t GetAmountLogicalProcessors();
 
+///
+/// Tries to return the size of the data cache at a level for the first processor.
+///
+/// Useful to size chunks of data so that they fit in cache.
+///
+/// @param[in] level Cache level (1, 2 or 3).
+///
+/// @return Size in bytes of the cache, 0 if unknown.
+///
+size_t GetCacheSize(uint32_t level);
+
 } // namespace plex
 
 #endif
@@ -29,13 +29,21 @@ enum class ThreadSchedulerPolicy
   ///
   Idle,
 
-  /// For time critical threads.
+  /// For time critical threads. Threads of the same priority take turns.
   /// Priorities 1 to 31 must be used.
   ///
-  /// Linux: same as SCHED_RR
+  /// Linux: same as SCHED_RR, priorities are spread over the SCHED_RR range
   /// Windows: Uses priorities 1 to 15 (THREAD_PRIORITY_TIME_CRITICAL)
   ///
-  Realtime
+  Realtime,
+
+  /// For time critical threads. Threads run until they block or yield, even with other threads of the same priority.
+  /// Priorities 1 to 31 must be used.
+  ///
+  /// Linux: same as SCHED_FIFO, priorities are spread over the SCHED_FIFO range
+  /// Windows: Same as Realtime
+  ///
+  RealtimeFifo
 };
 
 constexpr size_t MinRealtimePriority = 1; // Min priority for realtime scheduling policy
@@ -50,6 +58,9 @@ constexpr size_t MaxRealtimePriority = 31; // Max priority for realtime scheduli
 /// @param[in] policy The scheduler policy to use for the thread.
 /// @param[in] priority The thread priority.
 ///
+/// @note Realtime policies usually require privileges (CAP_SYS_NICE or RLIMIT_RTPRIO on Linux). Without them nothing
+/// is changed and false is returned, the thread keeps running with its previous policy.
+///
 /// @return True if the priority was successfully set.
 ///
 bool SetThreadPriority(std::thread::native_handle_type handle, ThreadSchedulerPolicy policy, int priority);
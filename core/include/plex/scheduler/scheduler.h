@@ -1,9 +1,13 @@
 #ifndef PLEX_SCHEDULER_SCHEDULER_H
 #define PLEX_SCHEDULER_SCHEDULER_H
 
-#include "plex/async/shared_task.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "plex/async/task.h"
 #include "plex/async/thread_pool.h"
-#include "plex/async/when_all.h"
+#include "plex/scheduler/scheduler_profiler.h"
 #include "plex/scheduler/stage.h"
 #include "plex/system/system.h"
 #include "plex/utilities/ref.h"
@@ -21,8 +25,12 @@ public:
   ///
   /// Runs all the scheduled stages.
   ///
-  /// Creates an aggregate task of update tasks for every system in the phase with proper order and parallelism
-  /// potential.
+  /// Executes the compiled plan of the scheduled sequence of stages. A system is started as soon as every system it
+  /// depends on is done, on the thread that finished the last of them.
+  ///
+  /// When multiple systems are ready at once, the one with the longest path to the end of the frame is started first.
+  /// Paths are measured from the execution times of the systems in previous runs, and systems are only reordered once
+  /// a path grows past the jitter of execution times.
   ///
   /// @param[in] context The context to run systems with.
   ///
@@ -30,6 +38,20 @@ public:
   ///
   Task<> RunAll(Context& context);
 
+  ///
+  /// Sets the profiler that records the execution of every system of the following runs.
+  ///
+  /// Profiling is disabled by default.
+  ///
+  /// @warning Cannot be changed while running.
+  ///
+  /// @param[in] profiler Profiler to record into, or nullptr to disable profiling.
+  ///
+  void SetProfiler(SchedulerProfiler* profiler) noexcept
+  {
+    profiler_ = profiler;
+  }
+
   ///
   /// Schedules the stage to be run.
   ///
@@ -76,15 +98,258 @@ public:
 
 private:
   ///
-  /// Creates a shared task from a step. Will first wait for all its dependencies to finish, then will
-  /// execute the system update.
+  /// Execution plan compiled from the scheduler steps of a sequence of stages.
   ///
-  /// @param[in] step Information about the system to execute.
-  /// @param[in] context The context to run systems with.
+  /// Holds a dependency counter and the list of successors of every step, so that running the plan only resets the
+  /// counters and starts steps as their counters reach zero. Nothing is allocated to run systems that are not
+  /// coroutines, and coroutine systems only need their own task. Every coroutine step has a runner coroutine created
+  /// with the plan that awaits the task of the system, and is reused by every run.
+  ///
+  /// Ready steps are pushed on a worklist that the thread completing a step drains in a loop, so that long chains of
+  /// steps done without suspending do not grow the stack.
   ///
-  /// @return Shared task that waits for its dependencies then executes system update.
+  /// Steps ready at the same time are started by the longest critical path first, which is the longest sum of
+  /// execution times from the step to the end of the plan.
   ///
-  SharedTask<> MakeSystemTask(const Step& step, Context& context);
+  class Plan
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    ///
+    /// Compiles the plan.
+    ///
+    /// @param[in] steps Scheduler steps, in topological order.
+    ///
+    explicit Plan(const Vector<Step>& steps);
+
+    ///
+    /// Destructor. Destroys the runners.
+    ///
+    ~Plan();
+
+    Plan(const Plan&) = delete;
+    Plan& operator=(const Plan&) = delete;
+
+    ///
+    /// Returns an awaiter that runs every step of the plan, then resumes the awaiting coroutine.
+    ///
+    /// @warning The plan cannot be run again before the previous run is done.
+    ///
+    /// @param[in] context The context to run systems with.
+    /// @param[in] profiler Profiler to record system executions into, nullptr if not profiling.
+    ///
+    /// @return Plan awaiter.
+    ///
+    auto Run(Context& context, SchedulerProfiler* profiler) noexcept
+    {
+      struct Awaiter
+      {
+        bool await_ready() const noexcept
+        {
+          return plan->nodes_.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) const
+        {
+          return plan->Start(*context, profiler, awaiting);
+        }
+
+        void await_resume() const noexcept {}
+
+        Plan* plan;
+        Context* context;
+        SchedulerProfiler* profiler;
+      };
+
+      return Awaiter { this, &context, profiler };
+    }
+
+    ///
+    /// Returns the amount of steps in the plan.
+    ///
+    /// @return Amount of steps.
+    ///
+    [[nodiscard]] size_t Size() const noexcept
+    {
+      return nodes_.size();
+    }
+
+  private:
+    ///
+    /// Coroutine running the task of a coroutine step every time it is resumed, then completing the step.
+    ///
+    struct StepRunner
+    {
+      struct promise_type
+      {
+        StepRunner get_return_object() noexcept
+        {
+          return { std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+          return {};
+        }
+
+        std::suspend_always final_suspend() const noexcept
+        {
+          return {};
+        }
+
+        void return_void() const noexcept {}
+
+        COROUTINE_UNHANDLED_EXCEPTION;
+      };
+
+      std::coroutine_handle<promise_type> handle;
+    };
+
+    ///
+    /// Awaited by a runner once the task of its step is done. Completes the step after suspending, so that the runner
+    /// can be resumed again by the next run as soon as the step is complete.
+    ///
+    struct StepDone
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<>) const
+      {
+        // Copied, the awaiter lives in the frame of the runner and cannot be used once the step is complete.
+        Plan* const done_plan = plan;
+        const size_t done_index = index;
+
+        done_plan->Complete(done_index);
+      }
+
+      void await_resume() const noexcept {}
+
+      Plan* plan;
+      size_t index;
+    };
+
+    ///
+    /// Stack of ready steps, linked through the next ready step of every step.
+    ///
+    struct Worklist
+    {
+      Plan* plan;
+      size_t ready; // Top of the stack, cNoStep if empty
+    };
+
+    static constexpr size_t cNoStep = static_cast<size_t>(-1);
+
+    static constexpr int64_t cReorderThreshold = 8; // Steps are reordered when a path is longer by an eighth
+
+    ///
+    /// Compiled step.
+    ///
+    struct Node
+    {
+      SystemObject* system;
+      size_t dependency_count;
+      size_t successors_begin; // Range in the successors of the plan
+      size_t successors_end;
+    };
+
+    ///
+    /// Computes the critical path of every step from the latest execution times, and sorts the steps without
+    /// dependencies and the successors of every step by longest critical path first.
+    ///
+    void Prioritize();
+
+    ///
+    /// Sorts a range of steps by longest critical path first, unless no step has a path longer than any step before it
+    /// by more than 1 / cReorderThreshold.
+    ///
+    /// @param[in] begin First step of the range.
+    /// @param[in] end Past the last step of the range.
+    ///
+    void SortByCriticalPath(size_t* begin, size_t* end);
+
+    ///
+    /// Resets the counters and starts the steps without dependencies.
+    ///
+    /// @param[in] context The context to run systems with.
+    /// @param[in] profiler Profiler to record system executions into, nullptr if not profiling.
+    /// @param[in] awaiting Coroutine to resume once every step is done.
+    ///
+    /// @return False if every step was done before returning and the awaiting coroutine must not suspend.
+    ///
+    bool Start(Context& context, SchedulerProfiler* profiler, std::coroutine_handle<> awaiting);
+
+    ///
+    /// Runs the coroutine of a coroutine step.
+    ///
+    /// @param[in] plan Plan of the step.
+    /// @param[in] index Index of the step.
+    ///
+    /// @return Runner, initially suspended.
+    ///
+    static StepRunner RunStep(Plan& plan, size_t index);
+
+    ///
+    /// Returns the worklist of the runner being resumed by the thread, nullptr if none.
+    ///
+    /// @return Reference to the worklist of the thread.
+    ///
+    static Worklist*& ActiveWorklist() noexcept;
+
+    ///
+    /// Dispatches the steps of the worklist until it is empty, including the steps that become ready meanwhile.
+    ///
+    /// @param[in] worklist Worklist to drain.
+    ///
+    void Execute(Worklist& worklist);
+
+    ///
+    /// Executes the system of a step whose dependencies are all done.
+    ///
+    /// @param[in] index Index of the step.
+    /// @param[in] worklist Worklist to push the steps that become ready on.
+    ///
+    void Dispatch(size_t index, Worklist& worklist);
+
+    ///
+    /// Called by the runner of a coroutine step when its task is done. Executes the steps that become ready, unless
+    /// the thread is already dispatching steps of the plan.
+    ///
+    /// @param[in] index Index of the step.
+    ///
+    void Complete(size_t index);
+
+    ///
+    /// Records the execution of a step and pushes the successors that became ready on the worklist.
+    ///
+    /// @param[in] index Index of the step.
+    /// @param[in] worklist Worklist to push the ready successors on.
+    ///
+    void Finish(size_t index, Worklist& worklist);
+
+  private:
+    Vector<Node> nodes_;
+    Vector<size_t> successors_;
+    Vector<size_t> roots_; // Steps without dependencies
+
+    Vector<std::chrono::nanoseconds> critical_paths_; // Per step
+    Vector<Clock::time_point> start_times_; // Per step, of the current run
+
+    std::unique_ptr<std::atomic_size_t[]> counters_; // Dependencies left per step
+    std::atomic_size_t remaining_; // Steps left, plus one for the start
+
+    Vector<size_t> next_ready_; // Per step, the step below it on the worklist
+    Vector<Task<>> system_tasks_; // Tasks of coroutine systems, kept until the next run
+    Vector<std::coroutine_handle<>> runners_; // Per coroutine step, null for other steps
+
+    Context* context_;
+    TaskContext* task_context_; // Of the coroutine running the plan
+    SchedulerProfiler* profiler_;
+    std::coroutine_handle<> continuation_;
+  };
 
 private:
   ///
@@ -101,21 +366,21 @@ private:
     ~Cache();
 
     ///
-    /// Returns the scheduler steps for the current sequence of added stages.
+    /// Returns the execution plan for the current sequence of added stages.
     ///
-    /// Will first attempt to retrieve the cached steps, if none, the steps will be built.
+    /// Will first attempt to retrieve the cached plan, if none, the plan will be built.
     ///
-    /// @return Scheduler steps for the current sequence of added stages.
+    /// @return Execution plan for the current sequence of added stages.
     ///
-    const Vector<Scheduler::Step>& Build()
+    Plan& Build()
     {
       ASSERT(current_ != nullptr, "Builder not prepared");
 
-      const auto& steps = current_->baked ? current_->steps : Bake();
+      Plan& plan = current_->plan ? *current_->plan : Bake();
 
       current_ = &root_;
 
-      return steps;
+      return plan;
     }
 
     ///
@@ -147,17 +412,15 @@ private:
 
       Stage* stage;
 
-      bool baked;
-
-      Vector<Scheduler::Step> steps;
+      std::unique_ptr<Plan> plan; // Nullptr until baked
     };
 
     ///
-    /// Creates the scheduler steps and caches them.
+    /// Creates the scheduler steps, compiles them and caches the plan.
     ///
-    /// @return The scheduler steps.
+    /// @return The execution plan.
     ///
-    const Vector<Scheduler::Step>& Bake();
+    Plan& Bake();
 
     ///
     /// Recursively destroys the node and its children.
@@ -195,12 +458,11 @@ private:
     Node* current_;
   };
 
-  Vector<SharedTask<>> tasks_;
-  Vector<TriggerTask<void, WhenAllCounter>> triggers_;
-
   TypeMap<Stage> stages_;
 
   Cache cache_;
+
+  SchedulerProfiler* profiler_ = nullptr;
 };
 
 ///
@@ -0,0 +1,147 @@
+#ifndef PLEX_SCHEDULER_SCHEDULER_PROFILER_H
+#define PLEX_SCHEDULER_SCHEDULER_PROFILER_H
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+
+#include "plex/containers/vector.h"
+#include "plex/system/system.h"
+
+namespace plex
+{
+///
+/// Execution of a system recorded by a scheduler profiler.
+///
+struct SystemSample
+{
+  SystemHandle system;
+  size_t run; // Index of the scheduler run
+  size_t thread; // Index of the thread that finished the system, in order of first record
+  std::chrono::steady_clock::time_point start; // Time the system was started
+  std::chrono::steady_clock::time_point end; // Time the system was done
+  std::chrono::nanoseconds dependency_wait; // Time from the start of the run until every dependency was done
+};
+
+///
+/// Statistics of the recorded executions of a system.
+///
+struct SystemStatistics
+{
+  SystemHandle system;
+  size_t executions;
+
+  std::chrono::nanoseconds mean;
+  std::chrono::nanoseconds p50;
+  std::chrono::nanoseconds p99;
+  std::chrono::nanoseconds max;
+
+  std::chrono::nanoseconds dependency_wait_p50;
+  std::chrono::nanoseconds dependency_wait_p99;
+};
+
+///
+/// Records the execution of every system run by the schedulers it is attached to.
+///
+/// Every thread records into its own buffer, so recording takes no lock. A thread only takes a lock the first time it
+/// records into a profiler.
+///
+/// @warning Samples can only be read and cleared while no scheduler attached to the profiler is running.
+///
+class SchedulerProfiler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ///
+  /// Constructor.
+  ///
+  SchedulerProfiler();
+
+  ///
+  /// Destructor.
+  ///
+  /// Threads that recorded into the profiler drop their buffer the next time they record into a new profiler.
+  ///
+  ~SchedulerProfiler();
+
+  SchedulerProfiler(const SchedulerProfiler&) = delete;
+  SchedulerProfiler& operator=(const SchedulerProfiler&) = delete;
+
+  ///
+  /// Marks the start of a scheduler run. Dependency waits of the following records are measured from it.
+  ///
+  /// @param[in] start Time the run started.
+  ///
+  void BeginRun(Clock::time_point start) noexcept
+  {
+    run_start_ = start;
+    run_++;
+  }
+
+  ///
+  /// Records an execution of a system of the current run, into the buffer of the calling thread.
+  ///
+  /// @param[in] system The system executed.
+  /// @param[in] start Time the system was started, when every dependency was done.
+  /// @param[in] end Time the system was done.
+  ///
+  void Record(SystemHandle system, Clock::time_point start, Clock::time_point end);
+
+  ///
+  /// Returns every recorded sample, ordered by start time.
+  ///
+  /// @return Recorded samples.
+  ///
+  [[nodiscard]] Vector<SystemSample> Samples() const;
+
+  ///
+  /// Computes the statistics of every recorded system, ordered by slowest median first.
+  ///
+  /// @return Statistics per system.
+  ///
+  [[nodiscard]] Vector<SystemStatistics> Summary() const;
+
+  ///
+  /// Writes every recorded sample in the Chrome Trace Event JSON format, which can be opened in chrome://tracing or
+  /// Perfetto. Systems are named after their handles.
+  ///
+  /// @param[in] stream Stream to write to.
+  ///
+  void WriteChromeTrace(std::ostream& stream) const;
+
+  ///
+  /// Removes every recorded sample.
+  ///
+  void Clear();
+
+private:
+  ///
+  /// Samples recorded by a single thread. Only written by that thread.
+  ///
+  struct ThreadBuffer
+  {
+    size_t thread;
+    Vector<SystemSample> samples;
+  };
+
+  ///
+  /// Returns the buffer of the calling thread, creating it if it is the first time the thread records.
+  ///
+  /// @return Buffer of the calling thread.
+  ///
+  ThreadBuffer& LocalBuffer();
+
+private:
+  const uint64_t id_; // Unique id, never reused so that threads cannot mistake buffers of a destroyed profiler
+
+  Clock::time_point run_start_;
+  size_t run_;
+
+  mutable std::mutex mutex_; // Protects the list of buffers, not their content
+  Vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+} // namespace plex
+
+#endif
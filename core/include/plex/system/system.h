@@ -1,7 +1,10 @@
 #ifndef PLEX_SYSTEM_SYSTEM_H
 #define PLEX_SYSTEM_SYSTEM_H
 
+#include <chrono>
+
 #include "plex/async/task.h"
+#include "plex/containers/bit_set.h"
 #include "plex/system/context.h"
 #include "plex/system/query.h"
 #include "plex/utilities/ref.h"
@@ -142,6 +145,20 @@ public:
     }
   }
 
+  ///
+  /// Invokes a system that is not a coroutine with the context, without creating a task.
+  ///
+  /// @param[in] system The system to invoke.
+  /// @param[in] global_context The global context to use, contains all global state.
+  /// @param[in] local_context The local context of the system.
+  ///
+  static void Call(SystemType* system, Context& global_context, Context& local_context) requires(!IsCoroutine)
+  {
+    [[maybe_unused]] const SystemHandle handle = std::bit_cast<SystemHandle>(system);
+
+    system(Fetch<Queries>(handle, global_context, local_context)...);
+  }
+
   ///
   /// Returns the data accesses of the system at compile-time.
   ///
@@ -178,8 +195,11 @@ public:
   ///
   template<System SystemType>
   constexpr SystemExecutor(SystemType system) noexcept
-    : system_(std::bit_cast<SystemHandle>(system)), executor_(SystemExecutor::Execute<decltype(system)>)
-  {}
+    : system_(std::bit_cast<SystemHandle>(system)), executor_(SystemExecutor::Execute<decltype(system)>),
+      caller_(nullptr)
+  {
+    if constexpr (!SystemTraits<decltype(system)>::IsCoroutine) caller_ = SystemExecutor::Call<decltype(system)>;
+  }
 
   SystemExecutor(const SystemExecutor&) = default;
 
@@ -196,6 +216,31 @@ public:
     return executor_(system_, global_context, local_context);
   }
 
+  ///
+  /// Executes a system that is not a coroutine synchronously, without creating a task.
+  ///
+  /// @warning The system must not be a coroutine.
+  ///
+  /// @param[in] global_context The global context.
+  /// @param[in] local_context The local context.
+  ///
+  void Call(Context& global_context, Context& local_context) const
+  {
+    ASSERT(caller_, "Coroutine systems cannot be called synchronously");
+
+    caller_(system_, global_context, local_context);
+  }
+
+  ///
+  /// Returns whether or not the system is a coroutine.
+  ///
+  /// @return True if the system is a coroutine, false otherwise.
+  ///
+  [[nodiscard]] bool IsCoroutine() const noexcept
+  {
+    return caller_ == nullptr;
+  }
+
   ///
   /// Handle to the system.
   ///
@@ -224,9 +269,25 @@ private:
     return SystemTraits<SystemType>::Invoke(std::bit_cast<SystemType>(system), global_context, local_context);
   }
 
+  ///
+  /// Template function that knows how to synchronously invoke the typed erased system.
+  ///
+  /// @tparam SystemType The system type.
+  ///
+  /// @param[in] system The system to invoke.
+  /// @param[in] global_context The global context.
+  /// @param[in] local_context The local context.
+  ///
+  template<typename SystemType>
+  static void Call(SystemHandle system, Context& global_context, Context& local_context)
+  {
+    SystemTraits<SystemType>::Call(std::bit_cast<SystemType>(system), global_context, local_context);
+  }
+
 private:
   SystemHandle system_;
   Task<> (*executor_)(SystemHandle, Context&, Context&);
+  void (*caller_)(SystemHandle, Context&, Context&); // Only for systems that are not coroutines
 };
 
 ///
@@ -248,7 +309,7 @@ public:
   ///
   template<System SystemType>
   explicit SystemObject(SystemType system) noexcept
-    : executor_(system), data_access_(SystemTraits<SystemType>::GetDataAccess())
+    : executor_(system), data_access_(InternDataAccess(SystemTraits<SystemType>::GetDataAccess()))
   {}
 
   ///
@@ -263,11 +324,60 @@ public:
     return executor_(global_context, local_context_);
   }
 
+  ///
+  /// Executes a system that is not a coroutine synchronously, without creating a task.
+  ///
+  /// @warning The system must not be a coroutine.
+  ///
+  /// @param[in] global_context The global context.
+  ///
+  void Call(Context& global_context)
+  {
+    executor_.Call(global_context, local_context_);
+  }
+
+  ///
+  /// Returns whether or not the system is a coroutine. Systems that are not can be called synchronously.
+  ///
+  /// @return True if the system is a coroutine, false otherwise.
+  ///
+  [[nodiscard]] bool IsCoroutine() const noexcept
+  {
+    return executor_.IsCoroutine();
+  }
+
+  ///
+  /// Records how long an execution of the system took.
+  ///
+  /// Executions are averaged with an exponential moving average, so that the estimate follows changes of workload
+  /// without jumping on every outlier.
+  ///
+  /// @param[in] time Time the execution took.
+  ///
+  void RecordExecutionTime(std::chrono::nanoseconds time) noexcept
+  {
+    // The first execution is taken as is, the following ones weigh for an eighth.
+    if (execution_time_.count() == 0) execution_time_ = time;
+    else execution_time_ += (time - execution_time_) / 8;
+  }
+
+  ///
+  /// Returns the estimated execution time of the system, zero if it was never recorded.
+  ///
+  /// @return Estimated execution time.
+  ///
+  [[nodiscard]] std::chrono::nanoseconds ExecutionTime() const noexcept
+  {
+    return execution_time_;
+  }
+
   ///
   /// Checks whether or not one system object has a data dependency on another.
   ///
   /// If there is a dependency, that means that the two systems cannot be executed in parallel.
   ///
+  /// Data accesses are interned when the system object is created, so this is only a few bitset intersections.
+  ///
   /// @param[in] system The system to check.
   ///
   /// @return Whether or not there is a dependency.
@@ -324,10 +434,39 @@ public:
     return !(lhs == rhs);
   }
 
+private:
+  ///
+  /// Data accesses of a system, as sets of interned ids. Thread safe data accesses are left out since they cannot form
+  /// a dependency.
+  ///
+  /// Sections and whole data sources are interned in the same id space, a whole data source being interned as its
+  /// empty section.
+  ///
+  struct DataAccessSets
+  {
+    BitSet read_sections; // Sections read
+    BitSet written_sections; // Sections written
+    BitSet accessed_sections; // Sections read or written
+    BitSet read_sources; // Data sources read as a whole
+    BitSet written_sources; // Data sources written as a whole
+    BitSet written_to; // Data sources written, as a whole or in part
+    BitSet accessed; // Data sources read or written, as a whole or in part
+  };
+
+  ///
+  /// Interns the data accesses of a system.
+  ///
+  /// @param[in] data_access Data accesses of the system.
+  ///
+  /// @return Interned data accesses.
+  ///
+  static DataAccessSets InternDataAccess(const Vector<QueryDataAccess>& data_access);
+
 private:
   SystemExecutor executor_;
   Context local_context_;
-  Vector<QueryDataAccess> data_access_;
+  DataAccessSets data_access_;
+  std::chrono::nanoseconds execution_time_ { 0 }; // Moving average
 };
 } // namespace plex
 
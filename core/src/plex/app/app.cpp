@@ -7,6 +7,7 @@ namespace plex
 App::App()
 {
   global_context_.Insert(&work_pool_, [](void*) {});
+  global_context_.Insert(&main_thread_executor_, [](void*) {});
 }
 
 void App::AddPackage(const Package& package)
@@ -18,4 +19,9 @@ Task<void> App::RunScheduler()
 {
   return scheduler_.RunAll(global_context_);
 }
+
+void App::RunFrame()
+{
+  main_thread_executor_.RunUntilComplete(work_pool_, RunScheduler());
+}
 } // namespace plex
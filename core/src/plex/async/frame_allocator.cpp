@@ -0,0 +1,470 @@
+#include "plex/async/frame_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "plex/debug/assertion.h"
+
+namespace plex
+{
+namespace
+{
+  constexpr size_t cMinClassSize = 64;
+  constexpr size_t cClassCount = 7; // From 64 to 4096 bytes
+  constexpr size_t cMaxClassSize = cMinClassSize << (cClassCount - 1);
+
+  // Amount of frames moved at once between a thread cache and the global pool, or allocated at once from the heap.
+  constexpr size_t cBatchSize = 32;
+
+  // Amount of free frames per size class a thread cache can hold before giving a batch back to the global pool.
+  constexpr size_t cMaxCachedFrames = 2 * cBatchSize;
+
+  ///
+  /// Free frames are linked through their own memory.
+  ///
+  struct FreeFrame
+  {
+    FreeFrame* next;
+  };
+
+  ///
+  /// Returns the index of the size class that fits the size.
+  ///
+  /// @param[in] size Size to fit.
+  ///
+  /// @return Size class index.
+  ///
+  constexpr size_t ClassIndex(size_t size) noexcept
+  {
+    if (size <= cMinClassSize) return 0;
+
+    // Same as the difference of bit widths, countl_zero returns an int on every standard library version.
+    return static_cast<size_t>(std::countl_zero(cMinClassSize - 1) - std::countl_zero(size - 1));
+  }
+
+  ///
+  /// Returns the size of the frames in a size class.
+  ///
+  /// @param[in] index Size class index.
+  ///
+  /// @return Size of the frames.
+  ///
+  constexpr size_t ClassSize(size_t index) noexcept
+  {
+    return cMinClassSize << index;
+  }
+
+  static_assert(ClassSize(ClassIndex(cMaxClassSize)) == cMaxClassSize);
+  static_assert(ClassSize(ClassIndex(cMinClassSize + 1)) == 2 * cMinClassSize);
+
+  ///
+  /// Increments a counter that is only written by one thread but may be read by others.
+  ///
+  /// @param[in] counter Counter to increment.
+  /// @param[in] amount Amount to add.
+  ///
+  void Increment(std::atomic<uint64_t>& counter, uint64_t amount = 1) noexcept
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Allocates a batch of frames of a size class from the heap.
+  ///
+  /// @note The memory is never given back to the heap, frames are recycled forever.
+  ///
+  /// @param[in] index Size class index.
+  ///
+  /// @return Linked list of the new frames.
+  ///
+  FreeFrame* AllocateBatch(size_t index)
+  {
+    const size_t size = ClassSize(index);
+
+    auto memory = static_cast<std::byte*>(::operator new(size * cBatchSize));
+
+    FreeFrame* list = nullptr;
+
+    for (size_t i = cBatchSize; i-- > 0;)
+    {
+      auto frame = reinterpret_cast<FreeFrame*>(memory + i * size);
+      frame->next = list;
+      list = frame;
+    }
+
+    return list;
+  }
+
+  class ThreadCache;
+
+  ///
+  /// Free frames shared by every thread, along with the registry of thread caches for the counters.
+  ///
+  struct GlobalPool
+  {
+    std::mutex mutex;
+
+    FreeFrame* lists[cClassCount] {};
+
+    std::vector<const ThreadCache*> caches; // Live thread caches
+
+    FrameAllocatorStats retired {}; // Counters of threads that exited, or that had no cache
+  };
+
+  ///
+  /// Returns the global pool.
+  ///
+  /// @note Never destroyed, frames can be deallocated during static destruction.
+  ///
+  /// @return Global pool.
+  ///
+  GlobalPool& Global()
+  {
+    static auto* pool = new GlobalPool();
+    return *pool;
+  }
+
+  ///
+  /// Free frames cached by a single thread.
+  ///
+  class ThreadCache
+  {
+  public:
+    ///
+    /// Default constructor.
+    ///
+    ThreadCache()
+    {
+      GlobalPool& global = Global();
+
+      std::lock_guard lock(global.mutex);
+
+      global.caches.push_back(this);
+    }
+
+    ///
+    /// Destructor. Gives every cached frame back to the global pool.
+    ///
+    ~ThreadCache()
+    {
+      GlobalPool& global = Global();
+
+      std::lock_guard lock(global.mutex);
+
+      for (size_t i = 0; i != cClassCount; i++)
+      {
+        while (FreeFrame* frame = lists_[i])
+        {
+          lists_[i] = frame->next;
+
+          frame->next = global.lists[i];
+          global.lists[i] = frame;
+        }
+      }
+
+      const FrameAllocatorStats stats = Stats();
+
+      global.retired.allocations += stats.allocations;
+      global.retired.deallocations += stats.deallocations;
+      global.retired.cache_misses += stats.cache_misses;
+      global.retired.heap_allocations += stats.heap_allocations;
+
+      global.caches.erase(std::find(global.caches.begin(), global.caches.end(), this));
+    }
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    ///
+    /// Allocates a frame of a size class.
+    ///
+    /// @param[in] index Size class index.
+    ///
+    /// @return Pointer to the frame memory.
+    ///
+    void* Allocate(size_t index)
+    {
+      Increment(allocations_);
+
+      if (lists_[index] == nullptr)
+      {
+        Increment(cache_misses_);
+        Refill(index);
+      }
+
+      FreeFrame* frame = lists_[index];
+
+      lists_[index] = frame->next;
+      counts_[index]--;
+
+      return frame;
+    }
+
+    ///
+    /// Deallocates a frame of a size class. The frame may have been allocated by any thread.
+    ///
+    /// @param[in] pointer Pointer to the frame memory.
+    /// @param[in] index Size class index.
+    ///
+    void Deallocate(void* pointer, size_t index) noexcept
+    {
+      Increment(deallocations_);
+
+      auto frame = static_cast<FreeFrame*>(pointer);
+
+      frame->next = lists_[index];
+      lists_[index] = frame;
+
+      // Threads that free more than they allocate, give back to threads that allocate more than they free.
+      if (++counts_[index] > cMaxCachedFrames) Release(index);
+    }
+
+    ///
+    /// Counts an allocation that bypassed the cache because it was too large.
+    ///
+    void CountLargeAllocation() noexcept
+    {
+      Increment(allocations_);
+      Increment(heap_allocations_);
+    }
+
+    ///
+    /// Counts a deallocation that bypassed the cache because it was too large.
+    ///
+    void CountLargeDeallocation() noexcept
+    {
+      Increment(deallocations_);
+    }
+
+    ///
+    /// Returns the counters of the thread. Can be called by any thread.
+    ///
+    /// @return Counters of the thread.
+    ///
+    [[nodiscard]] FrameAllocatorStats Stats() const noexcept
+    {
+      return { allocations_.load(std::memory_order_relaxed),
+        deallocations_.load(std::memory_order_relaxed),
+        cache_misses_.load(std::memory_order_relaxed),
+        heap_allocations_.load(std::memory_order_relaxed) };
+    }
+
+  private:
+    ///
+    /// Refills the cache of a size class with a batch of frames from the global pool, or from the heap if the global
+    /// pool has none.
+    ///
+    /// @param[in] index Size class index.
+    ///
+    void Refill(size_t index)
+    {
+      {
+        GlobalPool& global = Global();
+
+        std::lock_guard lock(global.mutex);
+
+        for (size_t i = 0; i != cBatchSize && global.lists[index] != nullptr; i++)
+        {
+          FreeFrame* frame = global.lists[index];
+          global.lists[index] = frame->next;
+
+          frame->next = lists_[index];
+          lists_[index] = frame;
+          counts_[index]++;
+        }
+      }
+
+      if (lists_[index] == nullptr)
+      {
+        Increment(heap_allocations_);
+
+        lists_[index] = AllocateBatch(index);
+        counts_[index] = cBatchSize;
+      }
+    }
+
+    ///
+    /// Gives a batch of frames of a size class back to the global pool.
+    ///
+    /// @param[in] index Size class index.
+    ///
+    void Release(size_t index) noexcept
+    {
+      FreeFrame* first = lists_[index];
+      FreeFrame* last = first;
+
+      for (size_t i = 1; i != cBatchSize; i++)
+      {
+        last = last->next;
+      }
+
+      lists_[index] = last->next;
+      counts_[index] -= cBatchSize;
+
+      GlobalPool& global = Global();
+
+      std::lock_guard lock(global.mutex);
+
+      last->next = global.lists[index];
+      global.lists[index] = first;
+    }
+
+  private:
+    FreeFrame* lists_[cClassCount] {};
+    size_t counts_[cClassCount] {};
+
+    std::atomic<uint64_t> allocations_ {};
+    std::atomic<uint64_t> deallocations_ {};
+    std::atomic<uint64_t> cache_misses_ {};
+    std::atomic<uint64_t> heap_allocations_ {};
+  };
+
+  // Trivially destructible, so they can still be used after the cache of the thread is destroyed.
+  thread_local ThreadCache* current_cache = nullptr;
+  thread_local bool current_cache_destroyed = false;
+
+  ///
+  /// Returns the cache of the current thread.
+  ///
+  /// @return Cache of the current thread, nullptr if the thread is exiting and its cache was already destroyed.
+  ///
+  ThreadCache* CurrentCache()
+  {
+    if (current_cache != nullptr || current_cache_destroyed) return current_cache;
+
+    ///
+    /// Owns the cache of the thread and flags it when destroyed.
+    ///
+    struct CacheOwner
+    {
+      ~CacheOwner()
+      {
+        current_cache = nullptr;
+        current_cache_destroyed = true;
+      }
+
+      ThreadCache cache;
+    };
+
+    thread_local CacheOwner owner;
+
+    current_cache = &owner.cache;
+
+    return current_cache;
+  }
+} // namespace
+
+void* AllocateFrame(size_t size)
+{
+  ThreadCache* cache = CurrentCache();
+
+  if (size > cMaxClassSize)
+  {
+    if (cache != nullptr) cache->CountLargeAllocation();
+    else
+    {
+      GlobalPool& global = Global();
+
+      std::lock_guard lock(global.mutex);
+
+      global.retired.allocations++;
+      global.retired.heap_allocations++;
+    }
+
+    return ::operator new(size);
+  }
+
+  const size_t index = ClassIndex(size);
+
+  if (cache != nullptr) return cache->Allocate(index);
+
+  // The thread is exiting, go straight to the global pool.
+
+  GlobalPool& global = Global();
+
+  std::lock_guard lock(global.mutex);
+
+  global.retired.allocations++;
+  global.retired.cache_misses++;
+
+  if (global.lists[index] == nullptr)
+  {
+    global.retired.heap_allocations++;
+    global.lists[index] = AllocateBatch(index);
+  }
+
+  FreeFrame* frame = global.lists[index];
+  global.lists[index] = frame->next;
+
+  return frame;
+}
+
+void DeallocateFrame(void* pointer, size_t size) noexcept
+{
+  ASSERT(pointer != nullptr, "Cannot deallocate nullptr frame");
+
+  ThreadCache* cache = CurrentCache();
+
+  if (size > cMaxClassSize)
+  {
+    if (cache != nullptr) cache->CountLargeDeallocation();
+    else
+    {
+      GlobalPool& global = Global();
+
+      std::lock_guard lock(global.mutex);
+
+      global.retired.deallocations++;
+    }
+
+    ::operator delete(pointer);
+    return;
+  }
+
+  const size_t index = ClassIndex(size);
+
+  if (cache != nullptr)
+  {
+    cache->Deallocate(pointer, index);
+    return;
+  }
+
+  // The thread is exiting, go straight to the global pool.
+
+  GlobalPool& global = Global();
+
+  std::lock_guard lock(global.mutex);
+
+  global.retired.deallocations++;
+
+  auto frame = static_cast<FreeFrame*>(pointer);
+
+  frame->next = global.lists[index];
+  global.lists[index] = frame;
+}
+
+FrameAllocatorStats GetFrameAllocatorStats()
+{
+  GlobalPool& global = Global();
+
+  std::lock_guard lock(global.mutex);
+
+  FrameAllocatorStats total = global.retired;
+
+  for (const ThreadCache* cache : global.caches)
+  {
+    const FrameAllocatorStats stats = cache->Stats();
+
+    total.allocations += stats.allocations;
+    total.deallocations += stats.deallocations;
+    total.cache_misses += stats.cache_misses;
+    total.heap_allocations += stats.heap_allocations;
+  }
+
+  return total;
+}
+} // namespace plex
@@ -0,0 +1,24 @@
+#include "plex/async/task_local.h"
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+
+namespace plex::details
+{
+size_t AllocateTaskLocalSlot() noexcept
+{
+  static std::atomic_size_t next_slot = 0;
+
+  const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+
+  // Checked in every build, slots past the limit would be written out of the bounds of every task context.
+  if (slot >= TaskContext::cMaxLocals) [[unlikely]]
+  {
+    std::fputs("Too many task locals, TaskContext::cMaxLocals must be increased\n", stderr);
+    std::terminate();
+  }
+
+  return slot;
+}
+} // namespace plex::details
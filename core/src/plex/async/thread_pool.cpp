@@ -1,11 +1,220 @@
 #include "plex/async/thread_pool.h"
 
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <vector>
+
 #include "plex/async/exponential_backoff.h"
+#include "plex/async/work_stealing_deque.h"
 #include "plex/os/cpu_info.h"
 #include "plex/os/thread.h"
+#include "plex/random/pcg.h"
 
 namespace plex
 {
+namespace
+{
+  // Bounds of the adaptive amount of backoff iterations a worker spins before parking.
+  constexpr size_t cMinSpinLimit = 2;
+  constexpr size_t cInitialSpinLimit = 16;
+  constexpr size_t cMaxSpinLimit = 64;
+
+  // Amount of workers per word of the parked workers mask.
+  constexpr size_t cParkedBits = 64;
+
+  ///
+  /// Orders timers so that the earliest deadline is at the top of a heap.
+  ///
+  /// @param[in] lhs First timer operation.
+  /// @param[in] rhs Second timer operation.
+  ///
+  /// @return True if the first deadline is later than the second.
+  ///
+  constexpr auto EarlierDeadline = [](const auto* lhs, const auto* rhs) noexcept
+  { return lhs->Deadline() > rhs->Deadline(); };
+
+  ///
+  /// Where a worker runs.
+  ///
+  struct WorkerPlacement
+  {
+    uint64_t mask; // Logical processors the worker runs on
+    uint32_t numa_node;
+    size_t domain; // Shared L3 cache, or NUMA node when the L3 cache is unknown
+  };
+
+  ///
+  /// Places every worker on a physical processor. Workers are placed in order of NUMA node then cache domain, so
+  /// that workers close to each other get placed close to each other.
+  ///
+  /// If there are more workers than physical processors, multiple workers are placed per physical processor.
+  ///
+  /// @param[in] thread_count Amount of workers.
+  ///
+  /// @return Placement of every worker, empty if the CPU topology is unknown.
+  ///
+  std::vector<WorkerPlacement> PlaceWorkers(size_t thread_count)
+  {
+    const CPUInfo info = GetCPUInfo();
+
+    if (info.processors.empty()) return {};
+
+    std::vector<WorkerPlacement> processors;
+
+    for (const auto& processor : info.processors)
+    {
+      WorkerPlacement placement { processor.mask, processor.numa_node, info.caches.size() + processor.numa_node };
+
+      for (size_t i = 0; i != info.caches.size(); i++)
+      {
+        const CacheInfo& cache = info.caches[i];
+
+        if (cache.level == 3 && cache.type != CacheType::Instruction && (cache.mask & processor.mask))
+        {
+          placement.domain = i;
+          break;
+        }
+      }
+
+      processors.push_back(placement);
+    }
+
+    std::sort(processors.begin(),
+      processors.end(),
+      [](const WorkerPlacement& lhs, const WorkerPlacement& rhs)
+      {
+        if (lhs.numa_node != rhs.numa_node) return lhs.numa_node < rhs.numa_node;
+        if (lhs.domain != rhs.domain) return lhs.domain < rhs.domain;
+        return std::countr_zero(lhs.mask) < std::countr_zero(rhs.mask);
+      });
+
+    std::vector<WorkerPlacement> placements;
+    placements.reserve(thread_count);
+
+    for (size_t i = 0; i < thread_count; i++)
+    {
+      placements.push_back(processors[i % processors.size()]);
+    }
+
+    return placements;
+  }
+} // namespace
+
+///
+/// State owned by a single worker thread in the work stealing mode.
+///
+struct ThreadPool::Worker
+{
+  // Operations that do not fit in the deque overflow into the injection queue.
+  static constexpr size_t cLocalCapacity = 256;
+
+  WorkStealingDeque<Operation, cLocalCapacity> deques[cLaneCount]; // One per lane
+
+  ThreadPool* pool;
+  WorkerCounters* counters;
+  size_t index; // Index of the worker in the pool
+  PCG random; // Used to pick steal victims
+
+  size_t ticks; // Amount of times the worker looked for work, used for the starvation guard
+
+  size_t group; // Index of the group of the worker
+
+  // Other workers ordered by distance: same group, then same NUMA node, then all others.
+  std::vector<size_t> victims;
+  size_t victims_group_end;
+  size_t victims_node_end;
+};
+
+///
+/// Counters of a single worker. Only written by the worker, read by anyone taking a snapshot.
+///
+/// Padded to a cache line so that workers never share the lines they write to.
+///
+struct alignas(CACHE_LINE_SIZE) ThreadPool::WorkerCounters
+{
+  enum State : size_t
+  {
+    Busy,
+    Spinning,
+    Parked,
+    StateCount
+  };
+
+  std::atomic_uint64_t executed { 0 };
+  std::atomic_uint64_t steals { 0 };
+  std::atomic_uint64_t wake_ups { 0 };
+  std::atomic_uint64_t max_queue_depth { 0 };
+  std::atomic_int64_t nanoseconds[StateCount] {}; // Time spent in every state
+
+  Clock::time_point since; // Start of the current state
+  State state = Busy;
+
+  ///
+  /// Increments a counter. Only one thread writes, so no read-modify-write is needed.
+  ///
+  /// @param[in] counter Counter to increment.
+  ///
+  static void Increment(std::atomic_uint64_t& counter) noexcept
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Raises the queue depth high-water mark.
+  ///
+  /// @param[in] depth Current queue depth.
+  ///
+  void RecordQueueDepth(size_t depth) noexcept
+  {
+    if (depth > max_queue_depth.load(std::memory_order_relaxed))
+    {
+      max_queue_depth.store(depth, std::memory_order_relaxed);
+    }
+  }
+
+  ///
+  /// Accounts the time spent in the current state and enters another one.
+  ///
+  /// @param[in] next State to enter.
+  ///
+  void Enter(State next) noexcept
+  {
+    const Clock::time_point now = Clock::now();
+
+    std::atomic_int64_t& spent = nanoseconds[state];
+    spent.store(spent.load(std::memory_order_relaxed) + (now - since).count(), std::memory_order_relaxed);
+
+    since = now;
+    state = next;
+  }
+};
+
+///
+/// Where a worker parks. Every worker has its own, so that work pinned to a worker only wakes up that worker and
+/// other work wakes up a single claimed worker.
+///
+/// Padded to a cache line so that waking up a worker never touches the line of another.
+///
+struct alignas(CACHE_LINE_SIZE) ThreadPool::Parker
+{
+  EventCount event_count;
+};
+
+///
+/// Workers that are close to each other, sharing a L3 cache or a NUMA node.
+///
+struct ThreadPool::Group
+{
+  InjectionQueue injection_queues[cLaneCount]; // One per lane
+
+  uint32_t numa_node;
+
+  // Groups ordered by distance: this group, then groups of the same NUMA node, then all others.
+  std::vector<size_t> nearby;
+  size_t nearby_node_end;
+};
+
 size_t GetDefaultAmountOfWorkerThreads()
 {
   size_t physical_processors = GetAmountPhysicalProcessors();
@@ -26,12 +235,14 @@ size_t GetDefaultAmountOfWorkerThreads()
   return physical_processors;
 }
 
-ThreadPool::ThreadPool(const size_t thread_count, bool lock_threads)
-  : running_(false), threads_(nullptr), thread_count_(thread_count)
+ThreadPool::ThreadPool(const size_t thread_count, bool lock_threads, ThreadPoolMode mode)
+  : running_(false), parked_helpers_(nullptr), parked_helper_count_(0), threads_(nullptr), thread_count_(thread_count),
+    mode_(mode), workers_(nullptr), counters_(nullptr), mailboxes_(nullptr), parkers_(nullptr), parked_(nullptr),
+    groups_(nullptr), group_count_(1), next_group_(0), timers_running_(true)
 {
   ASSERT(thread_count > 0, "Thread pool cannot have 0 threads");
 
-  CreateWorkers();
+  CreateWorkers(lock_threads);
 
   if (lock_threads) SetWorkerThreadAffinity();
 }
@@ -40,113 +251,914 @@ ThreadPool::ThreadPool() : ThreadPool(GetDefaultAmountOfWorkerThreads(), true) {
 
 ThreadPool::~ThreadPool()
 {
+  DestroyTimers(); // Expiring timers enqueue operations, stop them before the workers
   DestroyWorkers();
 }
 
-void ThreadPool::RunWorker()
+void ThreadPool::RunWorker(size_t index)
 {
   this_thread::SetName("Worker");
 
-  std::unique_lock lock(mutex_);
+  if constexpr (cStatsEnabled) counters_[index].since = Clock::now();
+
+  if (mode_ == ThreadPoolMode::WorkStealing) RunStealingWorker(workers_[index]);
+  else
+  {
+    RunSharedWorker(index);
+  }
+}
+
+void ThreadPool::RunSharedWorker(size_t index)
+{
+  WorkerCounters& counters = counters_[index];
+
+  size_t spin_limit = cInitialSpinLimit;
+  size_t ticks = 0;
+
+  Operation* pinned = nullptr;
+
+  for (;;)
+  {
+    Operation* op = TakePinned(index, pinned);
+
+    if (op == nullptr && HasWorkApprox())
+    {
+      std::lock_guard lock(mutex_);
+
+      op = DequeueShared(++ticks % cStarvationInterval == 0);
+    }
+
+    if (op != nullptr)
+    {
+      if constexpr (cStatsEnabled) WorkerCounters::Increment(counters.executed);
+
+      op->Execute(); // Unlocked for task execution
+    }
+    else if (!Idle(spin_limit, index))
+    {
+      break;
+    }
+  }
+}
+
+ThreadPool::Operation* ThreadPool::DequeueShared(bool lowest_first) noexcept
+{
+  for (size_t i = 0; i != cLaneCount; i++)
+  {
+    WorkQueue& queue = queues_[lowest_first ? cLaneCount - 1 - i : i];
+
+    if (Operation* op = queue.Front())
+    {
+      queue.Dequeue();
+      return op;
+    }
+  }
+
+  return nullptr;
+}
+
+void ThreadPool::RunStealingWorker(Worker& worker)
+{
+  CurrentWorker() = &worker;
+
+  size_t spin_limit = cInitialSpinLimit;
+
+  Operation* pinned = nullptr;
+
+  for (;;)
+  {
+    Operation* op = TakePinned(worker.index, pinned);
+
+    if (op == nullptr) op = FindWork(worker);
+
+    if (op != nullptr)
+    {
+      if constexpr (cStatsEnabled) WorkerCounters::Increment(worker.counters->executed);
+
+      op->Execute();
+    }
+    else if (!Idle(spin_limit, worker.index))
+    {
+      break;
+    }
+  }
+
+  CurrentWorker() = nullptr;
+}
+
+bool ThreadPool::Idle(size_t& spin_limit, size_t index)
+{
+  WorkerCounters& counters = counters_[index];
+
+  // Work pinned to other workers is not ours to find.
+  const auto has_work = [this, index]() { return mailboxes_[index].HasWorkApprox() || HasWorkApprox(); };
+
+  if constexpr (cStatsEnabled) counters.Enter(WorkerCounters::Spinning);
+
+  // Spin for a little while until we think we have more work to do.
+  // Avoids putting the worker to sleep only to wake up again.
+  ExponentialBackoff backoff;
+
+  for (size_t i = 0; i != spin_limit; i++)
+  {
+    if (has_work())
+    {
+      if constexpr (cStatsEnabled) counters.Enter(WorkerCounters::Busy);
+
+      // Work arrives often, spin longer next time.
+      spin_limit = std::min(spin_limit * 2, cMaxSpinLimit);
+      return true;
+    }
+
+    backoff.Wait();
+  }
+
+  // Work arrives rarely, stop wasting CPU on spinning sooner next time.
+  spin_limit = std::max(spin_limit / 2, cMinSpinLimit);
+
+  EventCount& parker = parkers_[index].event_count;
+
+  std::atomic_uint64_t& parked = parked_[index / cParkedBits];
+  const uint64_t bit = uint64_t { 1 } << (index % cParkedBits);
+
+  // Prepared before being marked as parked, so that a notifier claiming us always finds us waiting.
+  const auto key = parker.PrepareWait();
 
-  Operation* op;
+  parked.fetch_or(bit, std::memory_order_seq_cst);
 
-  while (running_ || !queue_.Empty()) // Always locked when doing an iteration
+  // Pairs with the fence in WakeOne. Either we see the new work or the enqueuer sees us parked and wakes us up.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // Check one last time after announcing that we are going to wait.
+  if (has_work())
+  {
+    parker.CancelWait();
+    parked.fetch_and(~bit, std::memory_order_relaxed);
+
+    if constexpr (cStatsEnabled) counters.Enter(WorkerCounters::Busy);
+
+    return true;
+  }
+
+  if (!running_.load(std::memory_order_relaxed))
+  {
+    parker.CancelWait();
+    parked.fetch_and(~bit, std::memory_order_relaxed);
+
+    if constexpr (cStatsEnabled) counters.Enter(WorkerCounters::Busy);
+
+    return false;
+  }
+
+  if constexpr (cStatsEnabled) counters.Enter(WorkerCounters::Parked);
+
+  parker.Wait(key);
+
+  // Already cleared by the notifier, unless woken up for pinned work.
+  parked.fetch_and(~bit, std::memory_order_relaxed);
+
+  if constexpr (cStatsEnabled)
+  {
+    WorkerCounters::Increment(counters.wake_ups);
+    counters.Enter(WorkerCounters::Busy);
+  }
+
+  return true;
+}
+
+ThreadPool::Operation* ThreadPool::TakePinned(size_t index, Operation*& pinned) noexcept
+{
+  if (pinned == nullptr) pinned = mailboxes_[index].TakeAll();
+
+  Operation* op = pinned;
+
+  if (op != nullptr) pinned = InjectionQueue::Unlink(op);
+
+  return op;
+}
+
+size_t ThreadPool::ClaimParkedWorker() noexcept
+{
+  for (size_t i = 0; i != (thread_count_ + cParkedBits - 1) / cParkedBits; i++)
   {
-    op = queue_.Front();
+    uint64_t parked = parked_[i].load(std::memory_order_relaxed);
+
+    while (parked != 0)
+    {
+      const int bit_index = std::countr_zero(parked);
+      const uint64_t bit = uint64_t { 1 } << bit_index;
+
+      // Clearing the bit claims the worker, another notifier may have claimed it first.
+      parked = parked_[i].fetch_and(~bit, std::memory_order_acq_rel);
+
+      if ((parked & bit) != 0) return i * cParkedBits + static_cast<size_t>(bit_index);
+
+      parked &= ~bit;
+    }
+  }
+
+  return thread_count_;
+}
+
+void ThreadPool::WakeOne() noexcept
+{
+  // Pairs with the fence in Idle.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const size_t index = ClaimParkedWorker();
+
+  if (index != thread_count_) parkers_[index].event_count.NotifyOne();
+  else
+  {
+    WakeHelpers(1);
+  }
+}
+
+void ThreadPool::WakeMany(size_t count) noexcept
+{
+  // Pairs with the fence in Idle.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (; count != 0; count--)
+  {
+    const size_t index = ClaimParkedWorker();
+
+    if (index == thread_count_) break;
+
+    parkers_[index].event_count.NotifyOne();
+  }
+
+  WakeHelpers(count);
+}
+
+void ThreadPool::WakeAll() noexcept
+{
+  // Pairs with the fence in Idle.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (size_t index = ClaimParkedWorker(); index != thread_count_; index = ClaimParkedWorker())
+  {
+    parkers_[index].event_count.NotifyOne();
+  }
+}
+
+void ThreadPool::ParkHelper(HelpFlag& flag)
+{
+  std::lock_guard lock(helpers_mutex_);
+
+  flag.next_ = parked_helpers_;
+  parked_helpers_ = &flag;
+
+  parked_helper_count_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void ThreadPool::UnparkHelper(HelpFlag& flag)
+{
+  std::lock_guard lock(helpers_mutex_);
+
+  for (HelpFlag** link = &parked_helpers_; *link != nullptr; link = &(*link)->next_)
+  {
+    if (*link == &flag)
+    {
+      *link = flag.next_;
+      parked_helper_count_.fetch_sub(1, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+void ThreadPool::WakeHelpers(size_t count) noexcept
+{
+  if (count == 0 || parked_helper_count_.load(std::memory_order_relaxed) == 0) return;
+
+  std::lock_guard lock(helpers_mutex_);
+
+  // Removed from the list so that the next notifier wakes up another one. The helping thread takes the lock before
+  // its flag goes away, so the flag stays alive while we hold it.
+  for (; count != 0 && parked_helpers_ != nullptr; count--)
+  {
+    HelpFlag* helper = parked_helpers_;
+
+    parked_helpers_ = helper->next_;
+    parked_helper_count_.fetch_sub(1, std::memory_order_relaxed);
+
+    helper->state_.fetch_add(HelpFlag::cWakeUp, std::memory_order_release);
+    helper->state_.notify_one();
+  }
+}
+
+ThreadPool::Operation* ThreadPool::FindWork(Worker& worker)
+{
+  const bool lowest_first = ++worker.ticks % cStarvationInterval == 0;
+
+  for (size_t i = 0; i != cLaneCount; i++)
+  {
+    if (Operation* op = FindWorkInLane(worker, lowest_first ? cLaneCount - 1 - i : i)) return op;
+  }
+
+  return nullptr;
+}
+
+ThreadPool::Operation* ThreadPool::FindWorkInLane(Worker& worker, size_t lane)
+{
+  constexpr size_t normal_lane = static_cast<size_t>(SchedulePriority::Normal);
+
+  const bool counted = lane != normal_lane;
+
+  if (counted && pending_[lane].load(std::memory_order_relaxed) == 0) return nullptr;
+
+  Operation* op = worker.deques[lane].Pop();
+
+  // Look further and further away, only crossing cache and NUMA domains as a last resort.
+  const Group& group = groups_[worker.group];
+
+  const size_t group_ends[] = { 1, group.nearby_node_end, group.nearby.size() };
+  const size_t victim_ends[] = { worker.victims_group_end, worker.victims_node_end, worker.victims.size() };
+
+  size_t group_begin = 0;
+  size_t victim_begin = 0;
+
+  for (size_t tier = 0; op == nullptr && tier != std::size(group_ends); tier++)
+  {
+    for (size_t i = group_begin; op == nullptr && i != group_ends[tier]; i++)
+    {
+      op = TakeInjected(worker, groups_[group.nearby[i]], lane);
+    }
+
+    if (op == nullptr) op = Steal(worker, lane, victim_begin, victim_ends[tier]);
+
+    group_begin = group_ends[tier];
+    victim_begin = victim_ends[tier];
+  }
+
+  if (op != nullptr && counted) pending_[lane].fetch_sub(1, std::memory_order_relaxed);
+
+  return op;
+}
+
+ThreadPool::Operation* ThreadPool::TakeInjected(Worker& worker, Group& group, size_t lane)
+{
+  InjectionQueue& injection_queue = group.injection_queues[lane];
+
+  Operation* first = injection_queue.TakeAll();
+
+  if (first == nullptr) return nullptr;
+
+  Operation* op = InjectionQueue::Unlink(first);
+
+  // Move the rest into our deque where other workers can steal them. Whatever does not fit goes back.
+  // When helping another group, workers of that group can still steal them back before workers of other groups.
+  while (op != nullptr)
+  {
+    Operation* next = InjectionQueue::Unlink(op);
+
+    if (!worker.deques[lane].Push(op)) injection_queue.Push(op);
+
+    op = next;
+  }
+
+  if constexpr (cStatsEnabled) worker.counters->RecordQueueDepth(worker.deques[lane].SizeApprox());
+
+  return first;
+}
+
+ThreadPool::Operation* ThreadPool::FindExternalWork() noexcept
+{
+  constexpr size_t normal_lane = static_cast<size_t>(SchedulePriority::Normal);
+
+  for (size_t lane = 0; lane != cLaneCount; lane++)
+  {
+    const bool counted = lane != normal_lane;
+
+    if (counted && pending_[lane].load(std::memory_order_relaxed) == 0) continue;
+
+    Operation* op = nullptr;
+
+    // There is no deque to move the operations into, take a single one and leave the rest for the workers.
+    for (size_t i = 0; op == nullptr && i != group_count_; i++)
+    {
+      op = groups_[i].injection_queues[lane].TakeOne();
+    }
+
+    for (size_t i = 0; op == nullptr && i != thread_count_; i++)
+    {
+      op = workers_[i].deques[lane].Steal();
+    }
 
     if (op != nullptr)
     {
-      do
+      if (counted) pending_[lane].fetch_sub(1, std::memory_order_relaxed);
+
+      return op;
+    }
+  }
+
+  return nullptr;
+}
+
+ThreadPool::Operation* ThreadPool::Steal(Worker& thief, size_t lane, size_t begin, size_t end)
+{
+  if (begin == end) return nullptr;
+
+  // Start at a random victim so that thieves spread out instead of all hammering the same worker.
+  const size_t count = end - begin;
+  const size_t start = thief.random(static_cast<uint32_t>(count));
+
+  for (size_t i = 0; i != count; i++)
+  {
+    Worker& victim = workers_[thief.victims[begin + (start + i) % count]];
+
+    if (Operation* op = victim.deques[lane].Steal())
+    {
+      if constexpr (cStatsEnabled) WorkerCounters::Increment(thief.counters->steals);
+
+      return op;
+    }
+  }
+
+  return nullptr;
+}
+
+ThreadPool::Group& ThreadPool::TargetGroup(const Operation* operation, const Worker* worker) noexcept
+{
+  if (group_count_ == 1) return groups_[0];
+
+  if (operation->Locality() != cNoLocality) return groups_[operation->Locality() % group_count_];
+
+  if (worker != nullptr) return groups_[worker->group];
+
+  // Spread operations from outside of the pool between groups.
+  return groups_[next_group_.fetch_add(1, std::memory_order_relaxed) % group_count_];
+}
+
+bool ThreadPool::HasWorkApprox() const noexcept
+{
+  for (size_t lane = 0; lane != cLaneCount; lane++)
+  {
+    if (queues_[lane].HasWorkApprox()) return true;
+  }
+
+  if (workers_ != nullptr)
+  {
+    for (size_t i = 0; i != group_count_; i++)
+    {
+      for (const auto& injection_queue : groups_[i].injection_queues)
+      {
+        if (injection_queue.HasWorkApprox()) return true;
+      }
+    }
+
+    for (size_t i = 0; i != thread_count_; i++)
+    {
+      for (const auto& deque : workers_[i].deques)
       {
-        queue_.Dequeue();
+        if (!deque.EmptyApprox()) return true;
+      }
+    }
+  }
 
-        // Make sure we are unlocked for task execution
-        lock.unlock();
+  return false;
+}
 
-        op->Execute();
+void ThreadPool::Enqueue(Operation* operation)
+{
+  if (mode_ == ThreadPoolMode::WorkStealing)
+  {
+    const size_t lane = operation->Lane();
 
-        // Spin for a little while until we think we have more work to do.
-        // Avoids putting the worker to sleep only to wake up again.
-        ExponentialBackoff backoff;
+    // Counted before being pushed so that the count never goes below zero.
+    if (lane != static_cast<size_t>(SchedulePriority::Normal)) pending_[lane].fetch_add(1, std::memory_order_relaxed);
 
-        for (size_t i = 0; i != 16 && !queue_.HasWorkApprox(); i++)
-        {
-          backoff.Wait();
-        }
+    Worker* worker = CurrentWorker();
 
-        lock.lock();
+    if (worker != nullptr && worker->pool != this) worker = nullptr; // Worker of another pool
+
+    const bool local = worker != nullptr
+                       && (operation->Locality() == cNoLocality
+                           || operation->Locality() % group_count_ == worker->group);
+
+    // Operations resumed from one of our workers stay on that worker, unless hinted to another group. The deque only
+    // fails when full, in which case we overflow into the injection queue. Operations from other threads never take
+    // the lock.
+    if (!local || !worker->deques[lane].Push(operation))
+    {
+      TargetGroup(operation, worker).injection_queues[lane].Push(operation);
+    }
+    else if constexpr (cStatsEnabled)
+    {
+      worker->counters->RecordQueueDepth(worker->deques[lane].SizeApprox());
+    }
+  }
+  else
+  {
+    ASSERT(running_.load(std::memory_order_relaxed), "Cannot enqueue operation when thread pool not running");
+
+    std::lock_guard lock(mutex_);
+
+    queues_[operation->Lane()].Enqueue(operation);
+  }
+
+  // Every time we enqueue an operation, we try to wake up one worker. This guarantees that either all workers are
+  // active or one worker per operation. Waking up is free when no worker is parked, so busy pools never make a system
+  // call here.
+  WakeOne();
+}
+
+void ThreadPool::Submit(Batch& batch)
+{
+  const size_t amount = batch.Size();
 
-        op = queue_.Front();
+  if (amount == 0) return;
+
+  if (mode_ == ThreadPoolMode::WorkStealing)
+  {
+    for (size_t lane = 0; lane != cLaneCount; lane++)
+    {
+      if (batch.heads_[lane] != nullptr) EnqueueChain(batch.heads_[lane], batch.sizes_[lane]);
+    }
+  }
+  else
+  {
+    ASSERT(running_.load(std::memory_order_relaxed), "Cannot submit batch when thread pool not running");
+
+    std::lock_guard lock(mutex_);
+
+    for (size_t lane = 0; lane != cLaneCount; lane++)
+    {
+      if (batch.heads_[lane] != nullptr) queues_[lane].EnqueueChain(batch.heads_[lane], batch.tails_[lane]);
+    }
+  }
+
+  batch.Clear();
+
+  // Wake up one worker per operation, at most every parked worker.
+  WakeMany(amount);
+}
+
+void ThreadPool::EnqueueChain(Operation* first, size_t amount)
+{
+  const size_t lane = first->Lane();
+
+  if (lane != static_cast<size_t>(SchedulePriority::Normal))
+  {
+    pending_[lane].fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  Worker* worker = CurrentWorker();
+
+  if (worker != nullptr && worker->pool != this) worker = nullptr; // Worker of another pool
+
+  InjectionQueue& injection_queue = TargetGroup(first, worker).injection_queues[lane];
+
+  if (worker != nullptr)
+  {
+    // Fill our deque like for single operations, whatever does not fit overflows into the injection queue.
+    while (first != nullptr)
+    {
+      Operation* next = InjectionQueue::Unlink(first);
+
+      if (!worker->deques[lane].Push(first))
+      {
+        injection_queue.Push(first);
+        first = next;
+        break;
       }
-      while (op != nullptr);
+
+      first = next;
+    }
+
+    if constexpr (cStatsEnabled) worker->counters->RecordQueueDepth(worker->deques[lane].SizeApprox());
+
+    if (first == nullptr) return;
+  }
+
+  injection_queue.PushChain(first);
+}
+
+bool ThreadPool::TryRunOne()
+{
+  Operation* op = nullptr;
+
+  if (mode_ == ThreadPoolMode::WorkStealing) op = FindExternalWork();
+  else if (HasWorkApprox())
+  {
+    std::lock_guard lock(mutex_);
+
+    op = DequeueShared(false);
+  }
+
+  if (op == nullptr) return false;
+
+  op->Execute();
+
+  return true;
+}
+
+void ThreadPool::HelpUntil(HelpFlag& flag)
+{
+  while (!flag.IsDone())
+  {
+    if (TryRunOne()) continue;
+
+    // Spin for a little while before parking, like workers do. The work we wait for often completes soon.
+    ExponentialBackoff backoff;
+
+    for (size_t i = 0; i != cInitialSpinLimit && !flag.IsDone() && !HasWorkApprox(); i++)
+    {
+      backoff.Wait();
+    }
+
+    const uint32_t state = flag.state_.load(std::memory_order_acquire);
+
+    ParkHelper(flag);
+
+    // Pairs with the fence in WakeOne. Either we see the flag or the new work, or the notifier sees us parked and wakes
+    // us up. Firing or waking up after loading the state makes the wait return right away.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if ((state & HelpFlag::cDone) == 0 && !HasWorkApprox()) flag.state_.wait(state, std::memory_order_acquire);
+
+    UnparkHelper(flag);
+  }
+}
+
+void ThreadPool::EnqueueOn(Operation* operation, size_t worker_index)
+{
+  ASSERT(running_.load(std::memory_order_relaxed), "Cannot enqueue operation when thread pool not running");
+
+  mailboxes_[worker_index].Push(operation);
+
+  // Only the target worker can execute it. Free when that worker is not parked.
+  parkers_[worker_index].event_count.NotifyOne();
+}
+
+void ThreadPool::AddTimer(TimerOperation* operation)
+{
+  std::lock_guard lock(timer_mutex_);
+
+  ASSERT(timers_running_, "Cannot add timer when thread pool not running");
+
+  // Cancellation requested while registering found nothing to cancel, the flag is always set before.
+  if (operation->token_.IsCancellationRequested())
+  {
+    operation->cancelled_ = true;
+    Enqueue(operation);
+    return;
+  }
+
+  if (!timer_thread_.joinable()) timer_thread_ = std::thread(&ThreadPool::RunTimers, this);
+
+  timers_.push_back(operation);
+  std::push_heap(timers_.begin(), timers_.end(), EarlierDeadline);
+
+  // Only the earliest timer changes how long the timer thread has to wait.
+  if (timers_.front() == operation) timer_condition_.notify_one();
+}
+
+void ThreadPool::CancelTimer(TimerOperation* operation)
+{
+  {
+    std::lock_guard lock(timer_mutex_);
+
+    auto it = std::find(timers_.begin(), timers_.end(), operation);
+
+    // Already expired, or not added yet in which case adding it notices the cancellation.
+    if (it == timers_.end()) return;
+
+    *it = timers_.back();
+    timers_.pop_back();
+
+    std::make_heap(timers_.begin(), timers_.end(), EarlierDeadline);
+
+    operation->cancelled_ = true;
+  }
+
+  // Waking up the timer thread is not needed, at worst it wakes up for a deadline that is no longer there.
+  Enqueue(operation);
+}
+
+void ThreadPool::RunTimers()
+{
+  this_thread::SetName("Timer");
+
+  std::unique_lock lock(timer_mutex_);
+
+  while (timers_running_)
+  {
+    if (timers_.empty())
+    {
+      timer_condition_.wait(lock);
+      continue;
     }
-    else
+
+    const Clock::time_point now = Clock::now();
+
+    if (timers_.front()->Deadline() > now)
     {
-      // Unlocks, sleeps then locks again when woke.
+      timer_condition_.wait_until(lock, timers_.front()->Deadline());
+      continue;
+    }
+
+    // Every timer that expired is scheduled together.
+    Batch batch;
 
-      // It is possible that we are sleeping and there are tasks in the queue. This is because
-      // the scheduler is not required to wake up more threads than it needs to execute the tasks.
-      // See the schedule method.
-      condition_.wait(lock);
+    while (!timers_.empty() && timers_.front()->Deadline() <= now)
+    {
+      std::pop_heap(timers_.begin(), timers_.end(), EarlierDeadline);
+
+      batch.Add(timers_.back());
+      timers_.pop_back();
     }
+
+    lock.unlock();
+
+    Submit(batch);
+
+    lock.lock();
   }
 }
 
-void ThreadPool::Enqueue(Operation* operation)
+void ThreadPool::DestroyTimers()
 {
-  mutex_.lock();
+  {
+    std::lock_guard lock(timer_mutex_);
 
-  ASSERT(running_, "Cannot enqueue operation when thread pool not running");
+    ASSERT(timers_.empty(), "There are still timers left");
 
-  queue_.Enqueue(operation);
+    timers_running_ = false;
+  }
 
-  // Manual unlocking is done before notifying, to avoid waking up
-  // the waiting thread only to block again.
-  // https://en.cppreference.com/w/cpp/thread/condition_variable
-  mutex_.unlock();
+  timer_condition_.notify_one();
 
-  // Every time we enqueue an operation, we compulsively try to wake up one worker. This guarantees that either all
-  // workers are active or one worker per operation. This still allows the possibility for some workers to stay asleep
-  // if there is not enough work to be done, reducing resource usage and contention.
-  condition_.notify_one();
+  if (timer_thread_.joinable()) timer_thread_.join();
 }
 
-void ThreadPool::CreateWorkers()
+std::vector<ThreadPoolWorkerStats> ThreadPool::Stats() const
+{
+  std::vector<ThreadPoolWorkerStats> stats(thread_count_);
+
+  for (size_t i = 0; i < thread_count_; i++)
+  {
+    const WorkerCounters& counters = counters_[i];
+
+    stats[i].executed = counters.executed.load(std::memory_order_relaxed);
+    stats[i].steals = counters.steals.load(std::memory_order_relaxed);
+    stats[i].wake_ups = counters.wake_ups.load(std::memory_order_relaxed);
+    stats[i].max_queue_depth = counters.max_queue_depth.load(std::memory_order_relaxed);
+    stats[i].busy =
+      std::chrono::nanoseconds(counters.nanoseconds[WorkerCounters::Busy].load(std::memory_order_relaxed));
+    stats[i].spinning =
+      std::chrono::nanoseconds(counters.nanoseconds[WorkerCounters::Spinning].load(std::memory_order_relaxed));
+    stats[i].parked =
+      std::chrono::nanoseconds(counters.nanoseconds[WorkerCounters::Parked].load(std::memory_order_relaxed));
+  }
+
+  return stats;
+}
+
+bool ThreadPool::SetWorkerPriority(size_t worker_index, ThreadSchedulerPolicy policy, int priority)
+{
+  ASSERT(worker_index < thread_count_, "Worker index out of range");
+
+  return SetThreadPriority(threads_[worker_index].native_handle(), policy, priority);
+}
+
+ThreadPool::Worker*& ThreadPool::CurrentWorker() noexcept
+{
+  thread_local Worker* worker = nullptr;
+  return worker;
+}
+
+void ThreadPool::CreateWorkers(bool lock_threads)
 {
   ASSERT(!running_, "Thread pool already running");
 
   running_ = true;
 
+  counters_ = new WorkerCounters[thread_count_];
+  mailboxes_ = new InjectionQueue[thread_count_];
+  parkers_ = new Parker[thread_count_];
+  parked_ = new std::atomic_uint64_t[(thread_count_ + cParkedBits - 1) / cParkedBits] {};
+
+  if (mode_ == ThreadPoolMode::WorkStealing)
+  {
+    workers_ = new Worker[thread_count_];
+
+    for (size_t i = 0; i < thread_count_; i++)
+    {
+      workers_[i].pool = this;
+      workers_[i].counters = counters_ + i;
+      workers_[i].index = i;
+      workers_[i].random = PCG(i);
+      workers_[i].ticks = 0;
+    }
+
+    // Without locking, the operating system can move workers anywhere so grouping them would be meaningless.
+    CreateGroups(lock_threads);
+  }
+
   threads_ = new std::thread[thread_count_];
 
   for (size_t i = 0; i < thread_count_; i++)
   {
-    new (threads_ + i) std::thread(&ThreadPool::RunWorker, this);
+    new (threads_ + i) std::thread(&ThreadPool::RunWorker, this, i);
   }
 }
 
-void ThreadPool::SetWorkerThreadAffinity()
+void ThreadPool::CreateGroups(bool use_topology)
 {
-  const CPUInfo info = GetCPUInfo();
+  const auto placements = use_topology ? PlaceWorkers(thread_count_) : std::vector<WorkerPlacement> {};
+
+  // Every distinct domain becomes a group.
+  std::vector<size_t> domains;
+
+  for (size_t i = 0; i < thread_count_; i++)
+  {
+    const size_t domain = placements.empty() ? 0 : placements[i].domain;
 
-  const auto core_count = info.processors.size();
+    auto it = std::find(domains.begin(), domains.end(), domain);
+
+    workers_[i].group = static_cast<size_t>(it - domains.begin());
+
+    if (it == domains.end()) domains.push_back(domain);
+  }
+
+  group_count_ = domains.size();
+  groups_ = new Group[group_count_];
 
   for (size_t i = 0; i < thread_count_; i++)
   {
-    SetThreadAffinity(threads_[i].native_handle(), info.processors[i % core_count].mask);
+    groups_[workers_[i].group].numa_node = placements.empty() ? 0 : placements[i].numa_node;
+  }
+
+  // Order everything by distance.
+
+  for (size_t i = 0; i < group_count_; i++)
+  {
+    Group& group = groups_[i];
+
+    group.nearby.push_back(i);
+
+    for (size_t j = 0; j < group_count_; j++)
+    {
+      if (j != i && groups_[j].numa_node == group.numa_node) group.nearby.push_back(j);
+    }
+
+    group.nearby_node_end = group.nearby.size();
+
+    for (size_t j = 0; j < group_count_; j++)
+    {
+      if (groups_[j].numa_node != group.numa_node) group.nearby.push_back(j);
+    }
+  }
+
+  for (size_t i = 0; i < thread_count_; i++)
+  {
+    Worker& worker = workers_[i];
+
+    const uint32_t numa_node = groups_[worker.group].numa_node;
+
+    for (size_t j = 0; j < thread_count_; j++)
+    {
+      if (j != i && workers_[j].group == worker.group) worker.victims.push_back(j);
+    }
+
+    worker.victims_group_end = worker.victims.size();
+
+    for (size_t j = 0; j < thread_count_; j++)
+    {
+      if (workers_[j].group != worker.group && groups_[workers_[j].group].numa_node == numa_node)
+      {
+        worker.victims.push_back(j);
+      }
+    }
+
+    worker.victims_node_end = worker.victims.size();
+
+    for (size_t j = 0; j < thread_count_; j++)
+    {
+      if (groups_[workers_[j].group].numa_node != numa_node) worker.victims.push_back(j);
+    }
   }
 }
 
-void ThreadPool::DestroyWorkers()
+void ThreadPool::SetWorkerThreadAffinity()
 {
-  mutex_.lock();
+  const auto placements = PlaceWorkers(thread_count_);
 
-  running_ = false;
+  if (placements.empty()) return; // No processor information on this platform
 
-  mutex_.unlock();
+  for (size_t i = 0; i < thread_count_; i++)
+  {
+    SetThreadAffinity(threads_[i].native_handle(), placements[i].mask);
+  }
+}
+
+void ThreadPool::DestroyWorkers()
+{
+  running_.store(false, std::memory_order_relaxed);
 
-  condition_.notify_all();
+  WakeAll();
 
   for (size_t i = 0; i < thread_count_; i++)
   {
@@ -156,12 +1168,31 @@ void ThreadPool::DestroyWorkers()
 #ifndef NDEBUG
   mutex_.lock();
 
-  ASSERT(queue_.Empty(), "There is still work left");
+  for (size_t lane = 0; lane != cLaneCount; lane++)
+  {
+    ASSERT(queues_[lane].Empty(), "There is still work left");
+
+    for (size_t i = 0; i != (groups_ ? group_count_ : 0); i++)
+    {
+      ASSERT(!groups_[i].injection_queues[lane].HasWorkApprox(), "There is still work left");
+    }
+  }
 
   mutex_.unlock();
+
+  for (size_t i = 0; i < thread_count_; i++)
+  {
+    ASSERT(!mailboxes_[i].HasWorkApprox(), "There is still work left");
+  }
 #endif
 
   delete[] threads_;
+  delete[] workers_;
+  delete[] counters_;
+  delete[] mailboxes_;
+  delete[] parkers_;
+  delete[] parked_;
+  delete[] groups_;
 }
 
-} // namespace plex
\ No newline at end of file
+} // namespace plex
@@ -3,7 +3,9 @@
 #include "plex/config/compiler.h"
 #include "plex/debug/assertion.h"
 
+#include <bit>
 #include <memory>
+#include <utility>
 
 #if PLATFORM_WINDOWS
 // Lean windows include
@@ -11,12 +13,163 @@
 #define VC_EXTRALEAN
 #include <Windows.h>
 #elif PLATFORM_LINUX
+#include <fstream>
+#include <string>
+#include <string_view>
+
 #include <pthread.h>
 #include <unistd.h>
 #endif
 
 namespace plex
 {
+namespace
+{
+  ///
+  /// Returns the id of the first domain that contains any of the processors in the mask.
+  ///
+  /// @param[in] domains Pairs of domain id and domain processor mask.
+  /// @param[in] mask Processors to look for.
+  ///
+  /// @return Id of the domain, 0 if none contains the processors.
+  ///
+  uint32_t FindDomain(const std::vector<std::pair<uint32_t, uint64_t>>& domains, uint64_t mask)
+  {
+    for (const auto& [id, domain_mask] : domains)
+    {
+      if (domain_mask & mask) return id;
+    }
+
+    return 0;
+  }
+
+#if PLATFORM_LINUX
+  ///
+  /// Reads the first line of a sysfs file.
+  ///
+  /// @param[in] path Path of the file.
+  /// @param[out] line The first line.
+  ///
+  /// @return True if the file could be read, false otherwise.
+  ///
+  bool ReadSysFile(const std::string& path, std::string& line)
+  {
+    std::ifstream file(path);
+
+    return file && std::getline(file, line);
+  }
+
+  ///
+  /// Reads a sysfs file containing a single unsigned integer.
+  ///
+  /// @param[in] path Path of the file.
+  /// @param[in] fallback Value returned if the file could not be read.
+  ///
+  /// @return The integer.
+  ///
+  uint32_t ReadSysInteger(const std::string& path, uint32_t fallback)
+  {
+    std::string line;
+
+    if (!ReadSysFile(path, line) || line.empty()) return fallback;
+
+    return static_cast<uint32_t>(std::stoul(line));
+  }
+
+  ///
+  /// Parses a kernel processor list, for example "0-3,8,10-11", into a mask.
+  ///
+  /// @note Processors past the first 64 are ignored.
+  ///
+  /// @param[in] list Processor list.
+  ///
+  /// @return Processor mask.
+  ///
+  uint64_t ParseProcessorList(std::string_view list)
+  {
+    uint64_t mask = 0;
+
+    while (!list.empty())
+    {
+      const size_t comma = list.find(',');
+      const std::string_view range = list.substr(0, comma);
+
+      const size_t dash = range.find('-');
+
+      const auto first = std::stoul(std::string(range.substr(0, dash)));
+      const auto last = dash == std::string_view::npos ? first : std::stoul(std::string(range.substr(dash + 1)));
+
+      for (auto i = first; i <= last && i < 64; i++)
+      {
+        mask |= uint64_t { 1 } << i;
+      }
+
+      list = comma == std::string_view::npos ? std::string_view {} : list.substr(comma + 1);
+    }
+
+    return mask;
+  }
+
+  ///
+  /// Parses a sysfs cache size, for example "32K", into bytes.
+  ///
+  /// @param[in] size Cache size.
+  ///
+  /// @return Size in bytes.
+  ///
+  uint32_t ParseCacheSize(std::string_view size)
+  {
+    if (size.empty()) return 0;
+
+    uint32_t multiplier = 1;
+
+    switch (size.back())
+    {
+    case 'K': multiplier = 1024; break;
+    case 'M': multiplier = 1024 * 1024; break;
+    case 'G': multiplier = 1024 * 1024 * 1024; break;
+    default: break;
+    }
+
+    if (multiplier != 1) size.remove_suffix(1);
+
+    return static_cast<uint32_t>(std::stoul(std::string(size))) * multiplier;
+  }
+
+  ///
+  /// Parses a sysfs cache type.
+  ///
+  /// @param[in] type Cache type.
+  ///
+  /// @return Cache type.
+  ///
+  CacheType ParseCacheType(std::string_view type)
+  {
+    if (type == "Data") return CacheType::Data;
+    if (type == "Instruction") return CacheType::Instruction;
+
+    return CacheType::Unified;
+  }
+
+  ///
+  /// Reads a processor list sysfs file into a mask.
+  ///
+  /// @param[in] path Path of the file.
+  /// @param[in] fallback Value returned if the file could not be read.
+  ///
+  /// @return Processor mask.
+  ///
+  uint64_t ReadSysProcessorList(const std::string& path, uint64_t fallback)
+  {
+    std::string line;
+
+    if (!ReadSysFile(path, line)) return fallback;
+
+    return ParseProcessorList(line);
+  }
+#endif
+} // namespace
+
 CPUInfo GetCPUInfo()
 {
   CPUInfo cpu_info;
@@ -35,6 +188,8 @@ CPUInfo GetCPUInfo()
 
   ASSERT(result2 != FALSE, "Failed to get processor information");
 
+  std::vector<std::pair<uint32_t, uint64_t>> packages;
+
   size_t offset = 0;
 
   do
@@ -58,6 +213,7 @@ CPUInfo GetCPUInfo()
       cache.level = current->Cache.Level;
       cache.size = current->Cache.CacheSize;
       cache.line_size = current->Cache.LineSize;
+      cache.mask = current->Cache.GroupMask.Mask;
 
       cpu_info.caches.push_back(cache);
 
@@ -73,10 +229,119 @@ CPUInfo GetCPUInfo()
 
       break;
     }
+    case RelationProcessorPackage:
+    {
+      packages.emplace_back(static_cast<uint32_t>(packages.size()), current->Processor.GroupMask->Mask);
+
+      break;
+    }
+    case RelationNumaNode:
+    {
+      NumaNodeInfo node;
+
+      node.id = current->NumaNode.NodeNumber;
+      node.mask = current->NumaNode.GroupMask.Mask;
+
+      cpu_info.numa_nodes.push_back(node);
+
+      break;
+    }
     }
     offset += current->Size;
   }
   while (offset < length);
+
+  std::vector<std::pair<uint32_t, uint64_t>> nodes;
+
+  for (const auto& node : cpu_info.numa_nodes)
+  {
+    nodes.emplace_back(node.id, node.mask);
+  }
+
+  for (auto& processor : cpu_info.processors)
+  {
+    processor.package = FindDomain(packages, processor.mask);
+    processor.numa_node = FindDomain(nodes, processor.mask);
+  }
+#elif PLATFORM_LINUX
+  const std::string cpu_path = "/sys/devices/system/cpu/";
+  const std::string node_path = "/sys/devices/system/node/";
+
+  const uint64_t online = ReadSysProcessorList(cpu_path + "online", 0);
+
+  if (online == 0) return cpu_info; // No sysfs
+
+  // NUMA nodes
+
+  const uint64_t online_nodes = ReadSysProcessorList(node_path + "online", 0);
+
+  std::vector<std::pair<uint32_t, uint64_t>> nodes;
+
+  for (uint32_t id = 0; id != 64; id++)
+  {
+    if (!(online_nodes & (uint64_t { 1 } << id))) continue;
+
+    const uint64_t mask = ReadSysProcessorList(node_path + "node" + std::to_string(id) + "/cpulist", 0) & online;
+
+    if (mask != 0) cpu_info.numa_nodes.push_back(NumaNodeInfo { id, mask });
+  }
+
+  // Kernels without NUMA support do not have nodes, everything is in a single node.
+  if (cpu_info.numa_nodes.empty()) cpu_info.numa_nodes.push_back(NumaNodeInfo { 0, online });
+
+  for (const auto& node : cpu_info.numa_nodes)
+  {
+    nodes.emplace_back(node.id, node.mask);
+  }
+
+  // Physical processors and caches
+
+  uint64_t listed = 0; // Logical processors that already belong to a listed physical processor
+
+  for (uint32_t cpu = 0; cpu != 64; cpu++)
+  {
+    const uint64_t cpu_mask = uint64_t { 1 } << cpu;
+
+    if (!(online & cpu_mask)) continue;
+
+    const std::string path = cpu_path + "cpu" + std::to_string(cpu) + "/";
+
+    if (!(listed & cpu_mask))
+    {
+      ProcessorInfo processor;
+
+      processor.mask = (ReadSysProcessorList(path + "topology/thread_siblings_list", cpu_mask) & online) | cpu_mask;
+      processor.package = ReadSysInteger(path + "topology/physical_package_id", 0);
+      processor.numa_node = FindDomain(nodes, processor.mask);
+
+      listed |= processor.mask;
+
+      cpu_info.processors.push_back(processor);
+    }
+
+    for (uint32_t index = 0;; index++)
+    {
+      const std::string cache_path = path + "cache/index" + std::to_string(index) + "/";
+
+      std::string type;
+
+      if (!ReadSysFile(cache_path + "type", type)) break;
+
+      CacheInfo cache;
+
+      cache.type = ParseCacheType(type);
+      cache.level = ReadSysInteger(cache_path + "level", 0);
+      cache.line_size = ReadSysInteger(cache_path + "coherency_line_size", 0);
+      cache.mask = (ReadSysProcessorList(cache_path + "shared_cpu_list", cpu_mask) & online) | cpu_mask;
+
+      std::string size;
+
+      cache.size = ReadSysFile(cache_path + "size", size) ? ParseCacheSize(size) : 0;
+
+      // Shared caches are listed by every processor sharing them, only keep them once.
+      if (static_cast<uint32_t>(std::countr_zero(cache.mask)) == cpu) cpu_info.caches.push_back(cache);
+    }
+  }
 #endif
 
   return cpu_info;
@@ -103,4 +368,23 @@ size_t GetAmountLogicalProcessors()
   return std::thread::hardware_concurrency(); // Should be considered a hint according to standard
 #endif
 }
+
+size_t GetCacheSize(uint32_t level)
+{
+  const auto cpu_info = GetCPUInfo();
+
+  if (cpu_info.processors.empty()) return 0;
+
+  const uint64_t first_processor = cpu_info.processors.front().mask;
+
+  for (const auto& cache : cpu_info.caches)
+  {
+    if (cache.level == level && cache.type != CacheType::Instruction && (cache.mask & first_processor))
+    {
+      return cache.size;
+    }
+  }
+
+  return 0;
+}
 } // namespace plex
@@ -10,6 +10,7 @@
 #include <Windows.h>
 #elif PLATFORM_LINUX
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #endif
 
@@ -25,7 +26,7 @@ bool SetThreadAffinity([[maybe_unused]] std::thread::native_handle_type handle,
 
   for (size_t i = 0; i < 64; i++)
   {
-    if (mask & (1 << i)) CPU_SET(i, &cpuset)
+    if (mask & (uint64_t { 1 } << i)) CPU_SET(i, &cpuset);
   }
 
   return !pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
@@ -50,6 +51,7 @@ bool SetThreadPriority(std::thread::native_handle_type handle, ThreadSchedulerPo
     return ::SetThreadPriority(handle, THREAD_PRIORITY_IDLE);
   }
   case ThreadSchedulerPolicy::Realtime:
+  case ThreadSchedulerPolicy::RealtimeFifo:
   {
     ASSERT(priority >= 1 && priority <= 31, "Prority must be between 1 & 31 for realtime scheduler policy");
 
@@ -69,7 +71,50 @@ bool SetThreadPriority(std::thread::native_handle_type handle, ThreadSchedulerPo
   default: return false;
   }
 #elif PLATFORM_LINUX
-  return false;
+  int native_policy;
+
+  switch (policy)
+  {
+  case ThreadSchedulerPolicy::Normal:
+  {
+    ASSERT(priority == 0, "Priority must be 0 for normal scheduler policy");
+
+    native_policy = SCHED_OTHER;
+    break;
+  }
+  case ThreadSchedulerPolicy::Idle:
+  {
+    ASSERT(priority == 0, "Priority must be 0 for idle scheduler policy");
+
+    native_policy = SCHED_IDLE;
+    break;
+  }
+  case ThreadSchedulerPolicy::Realtime:
+  case ThreadSchedulerPolicy::RealtimeFifo:
+  {
+    ASSERT(priority >= 1 && priority <= 31, "Prority must be between 1 & 31 for realtime scheduler policy");
+
+    native_policy = policy == ThreadSchedulerPolicy::Realtime ? SCHED_RR : SCHED_FIFO;
+    break;
+  }
+  default: return false;
+  }
+
+  sched_param param {};
+
+  if (native_policy == SCHED_RR || native_policy == SCHED_FIFO)
+  {
+    const int min = sched_get_priority_min(native_policy);
+    const int max = sched_get_priority_max(native_policy);
+
+    if (min == -1 || max == -1) return false;
+
+    // Spread our priorities over the whole native range (Usually 1 to 99).
+    param.sched_priority = min + (priority - 1) * (max - min) / (static_cast<int>(MaxRealtimePriority) - 1);
+  }
+
+  // Fails with EPERM without the privileges required by realtime policies, in which case nothing is changed.
+  return !pthread_setschedparam(handle, native_policy, &param);
 #endif
 }
 
@@ -1,42 +1,268 @@
 #include "plex/scheduler/scheduler.h"
 
-#include "plex/containers/deque.h"
+#include <algorithm>
+#include <utility>
+
+#include "plex/containers/bit_set.h"
 
 namespace plex
 {
 Task<> Scheduler::RunAll(Context& context)
 {
-  tasks_.clear();
-  triggers_.clear();
+  co_await cache_.Build().Run(context, profiler_);
+}
+
+Scheduler::Plan::Plan(const Vector<Step>& steps)
+  : remaining_(0), context_(nullptr), task_context_(nullptr), profiler_(nullptr)
+{
+  const size_t size = steps.size();
+
+  nodes_.reserve(size);
+  system_tasks_.reserve(size);
+  runners_.reserve(size);
 
-  const auto& steps = cache_.Build();
+  // Successors are stored contiguously per step, so count them first.
+
+  Vector<size_t> successor_counts;
+  successor_counts.resize(size);
 
   for (const auto& step : steps)
   {
-    tasks_.push_back(MakeSystemTask(step, context));
+    for (const size_t dependency : step.dependencies)
+    {
+      successor_counts[dependency]++;
+    }
+  }
+
+  size_t offset = 0;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    nodes_.push_back({ steps[i].system, steps[i].dependencies.size(), offset, offset });
+
+    offset += successor_counts[i];
+  }
+
+  successors_.resize(offset);
+
+  for (size_t i = 0; i < size; i++) // Successors end up in step order
+  {
+    for (const size_t dependency : steps[i].dependencies)
+    {
+      successors_[nodes_[dependency].successors_end++] = i;
+    }
+
+    if (steps[i].dependencies.empty()) roots_.push_back(i);
+
+    system_tasks_.push_back(Task<>(Task<>::handle_type {}));
+    runners_.push_back(steps[i].system->IsCoroutine() ? RunStep(*this, i).handle : std::coroutine_handle<> {});
   }
 
-  co_await WhenAll(tasks_);
+  critical_paths_.resize(size);
+  start_times_.resize(size);
+  next_ready_.resize(size);
+
+  counters_ = std::make_unique<std::atomic_size_t[]>(size);
+}
+
+Scheduler::Plan::~Plan()
+{
+  for (const std::coroutine_handle<> runner : runners_)
+  {
+    if (runner) runner.destroy();
+  }
 }
 
-SharedTask<> Scheduler::MakeSystemTask(const Step& step, Context& context)
+void Scheduler::Plan::Prioritize()
 {
-  const size_t amount = step.dependencies.size();
+  // Steps are in topological order, so going backwards the successors of a step are always computed before it.
 
-  if (amount != 0)
+  for (size_t i = nodes_.size(); i-- != 0;)
   {
-    WhenAllCounter counter(amount);
+    const Node& node = nodes_[i];
 
-    for (const size_t dependency : step.dependencies)
+    std::chrono::nanoseconds longest_successor { 0 };
+
+    for (size_t j = node.successors_begin; j != node.successors_end; j++)
     {
-      triggers_.push_back(MakeTriggerTask<WhenAllCounter>(tasks_[dependency]));
-      triggers_.back().Start(counter);
+      longest_successor = std::max(longest_successor, critical_paths_[successors_[j]]);
     }
 
-    co_await counter;
+    // Systems never measured count for the smallest time, so that longer chains still go first.
+    critical_paths_[i] = std::max(node.system->ExecutionTime(), std::chrono::nanoseconds { 1 }) + longest_successor;
+  }
+
+  SortByCriticalPath(roots_.data(), roots_.data() + roots_.size());
+
+  for (const Node& node : nodes_)
+  {
+    SortByCriticalPath(successors_.data() + node.successors_begin, successors_.data() + node.successors_end);
+  }
+}
+
+void Scheduler::Plan::SortByCriticalPath(size_t* begin, size_t* end)
+{
+  // Execution times vary from run to run, steps are only reordered once a path is longer than a path before it by
+  // more than the jitter. Comparing against the shortest path so far catches ranges drifting in ascending order by
+  // steps within the jitter. Ranges still in order, which is most of them every run, are only scanned.
+  if (begin == end) return;
+
+  std::chrono::nanoseconds shortest = critical_paths_[*begin];
+
+  const size_t* step = begin + 1;
+
+  for (; step != end; step++)
+  {
+    const std::chrono::nanoseconds path = critical_paths_[*step];
+
+    if (path - shortest > shortest / cReorderThreshold) break;
+
+    shortest = std::min(shortest, path);
+  }
+
+  if (step == end) [[likely]]
+    return;
+
+  std::sort(begin,
+    end,
+    [this](size_t lhs, size_t rhs)
+    {
+      if (critical_paths_[lhs] != critical_paths_[rhs]) return critical_paths_[lhs] > critical_paths_[rhs];
+      return lhs < rhs; // Keep the step order between equal paths
+    });
+}
+
+bool Scheduler::Plan::Start(Context& context, SchedulerProfiler* profiler, std::coroutine_handle<> awaiting)
+{
+  context_ = &context;
+  task_context_ = details::CurrentTaskContext();
+  profiler_ = profiler;
+  continuation_ = awaiting;
+
+  Prioritize(); // Nothing runs, so execution times of the previous run are all recorded
+
+  for (size_t i = 0; i < nodes_.size(); i++)
+  {
+    counters_[i].store(nodes_[i].dependency_count, std::memory_order_relaxed);
+  }
+
+  // The extra count keeps the last step from resuming the awaiting coroutine before it is suspended.
+  remaining_.store(nodes_.size() + 1, std::memory_order_relaxed);
+
+  if (profiler_) profiler_->BeginRun(Clock::now());
+
+  Worklist worklist { this, cNoStep };
+
+  for (size_t i = roots_.size(); i-- != 0;) // The first root ends up on top
+  {
+    next_ready_[roots_[i]] = worklist.ready;
+    worklist.ready = roots_[i];
   }
 
-  co_await step.system->operator()(context);
+  Execute(worklist);
+
+  return remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1;
+}
+
+Scheduler::Plan::StepRunner Scheduler::Plan::RunStep(Plan& plan, size_t index)
+{
+  for (;;)
+  {
+    // Replaced by the next run only once done, the task is kept alive until then.
+    co_await plan.system_tasks_[index];
+    co_await StepDone { &plan, index };
+  }
+}
+
+Scheduler::Plan::Worklist*& Scheduler::Plan::ActiveWorklist() noexcept
+{
+  thread_local Worklist* worklist = nullptr;
+  return worklist;
+}
+
+void Scheduler::Plan::Execute(Worklist& worklist)
+{
+  // A non empty worklist holds steps that are not done, so the plan cannot have been destroyed.
+  while (worklist.ready != cNoStep)
+  {
+    const size_t index = worklist.ready;
+    worklist.ready = next_ready_[index];
+
+    Dispatch(index, worklist);
+  }
+}
+
+void Scheduler::Plan::Dispatch(size_t index, Worklist& worklist)
+{
+  SystemObject& system = *nodes_[index].system;
+
+  start_times_[index] = Clock::now();
+
+  if (!system.IsCoroutine())
+  {
+    system.Call(*context_);
+    Finish(index, worklist);
+  }
+  else
+  {
+    // Tasks of the previous run are done, they are only destroyed here.
+    system_tasks_[index] = system(*context_);
+
+    // Steps completed before the runner suspends are pushed on this worklist instead of being executed recursively.
+    Worklist*& active = ActiveWorklist();
+    Worklist* const previous = std::exchange(active, &worklist);
+
+    details::ResumeIsolated(runners_[index]);
+
+    active = previous;
+  }
+}
+
+void Scheduler::Plan::Complete(size_t index)
+{
+  // Successors run in the context of the plan, whatever context the system task left.
+  details::CurrentTaskContext() = task_context_;
+
+  Worklist* active = ActiveWorklist();
+
+  if (active != nullptr && active->plan == this)
+  {
+    Finish(index, *active);
+    return;
+  }
+
+  Worklist worklist { this, cNoStep };
+
+  Finish(index, worklist);
+  Execute(worklist);
+}
+
+void Scheduler::Plan::Finish(size_t index, Worklist& worklist)
+{
+  const Node& node = nodes_[index];
+
+  // Coroutine systems are measured until their task is done, including the time they were suspended.
+  const Clock::time_point end = Clock::now();
+
+  node.system->RecordExecutionTime(end - start_times_[index]);
+
+  if (profiler_) profiler_->Record(node.system->Handle(), start_times_[index], end);
+
+  // Pushed backwards, so that the successor with the longest critical path is dispatched first.
+  for (size_t i = node.successors_end; i-- != node.successors_begin;)
+  {
+    const size_t successor = successors_[i];
+
+    // Needs release so that the writes of the system are visible to its successors.
+    // Needs acquire to see the writes of the other dependencies of the successor.
+    if (counters_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      next_ready_[successor] = worklist.ready;
+      worklist.ready = successor;
+    }
+  }
+
+  if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) details::ResumeIsolated(continuation_);
 }
 
 Scheduler::Cache::Cache()
@@ -50,7 +276,7 @@ Scheduler::Cache::~Cache()
   DestroyNode(&root_);
 }
 
-const Vector<Scheduler::Step>& Scheduler::Cache::Bake()
+Scheduler::Plan& Scheduler::Cache::Bake()
 {
   Vector<Stage*> stages;
 
@@ -65,10 +291,9 @@ const Vector<Scheduler::Step>& Scheduler::Cache::Bake()
 
   std::reverse(stages.begin(), stages.end()); // TODO Optimization: Try to avoid this
 
-  current_->steps = ComputeSchedulerData(stages);
-  current_->baked = true;
+  current_->plan = std::make_unique<Plan>(ComputeSchedulerData(stages));
 
-  return current_->steps;
+  return *current_->plan;
 }
 
 void Scheduler::Cache::DestroyNode(Node* node)
@@ -91,7 +316,6 @@ void Scheduler::Cache::NewPath(Stage* stage)
   Node* node = new Node;
   node->parent = current_;
   node->stage = stage;
-  node->baked = false;
 
   current_->children.push_back(node);
 
@@ -108,60 +332,78 @@ struct IntermediateStep
   Vector<size_t> dependants;
 };
 
-Vector<IntermediateStep> ComputeDependencyGraph(const Vector<Stage*>& stages)
+Vector<SystemObject*> GatherSystems(const Vector<Stage*>& stages, Vector<size_t>& stage_indices)
 {
-  Vector<IntermediateStep> steps;
+  Vector<SystemObject*> systems;
 
-  size_t step_index = 0;
-
-  for (auto stage_it = stages.begin(); stage_it != stages.end(); ++stage_it)
+  for (size_t i = 0; i < stages.size(); i++)
   {
-    const auto& stage = **stage_it;
-
-    const auto& systems = stage.GetSystemObjects();
-
-    for (auto system_it = systems.begin(); system_it != systems.end(); ++system_it)
+    for (const auto& system : stages[i]->GetSystemObjects())
     {
-      const auto& system = **system_it;
+      systems.push_back(system.get());
+      stage_indices.push_back(i);
+    }
+  }
 
-      size_t other_step_index = 0;
+  return systems;
+}
 
-      // Find all dependencies in earlier stages
+Vector<BitSet> ComputeConflictMatrix(const Vector<SystemObject*>& systems)
+{
+  // Dense adjacency matrix of the systems that cannot run in parallel. Symmetric, so only half is computed.
 
-      for (auto other_stage_it = stages.begin(); other_stage_it != stage_it; ++other_stage_it)
-      {
-        const auto& other_systems = (*other_stage_it)->GetSystemObjects();
+  const size_t size = systems.size();
 
-        for (auto other_system_it = other_systems.begin(); other_system_it != other_systems.end(); ++other_system_it)
-        {
-          const auto& other_system = **other_system_it;
+  Vector<BitSet> conflicts;
+  conflicts.reserve(size);
 
-          if (system.HasDependency(other_system))
-          {
-            steps[other_step_index].dependants.push_back(step_index);
-          }
+  for (size_t i = 0; i < size; i++)
+  {
+    conflicts.push_back(BitSet(size));
+  }
 
-          other_step_index++;
-        }
+  for (size_t i = 0; i < size; i++)
+  {
+    for (size_t j = 0; j < i; j++)
+    {
+      if (systems[i]->HasDependency(*systems[j]))
+      {
+        conflicts[i].Set(j);
+        conflicts[j].Set(i);
       }
+    }
+  }
 
-      // Find all explicit dependencies in same stage
+  return conflicts;
+}
 
-      for (auto other_system_it = systems.begin(); other_system_it != systems.end(); ++other_system_it)
-      {
-        const auto& other_system = **other_system_it;
+Vector<IntermediateStep> ComputeDependencyGraph(const Vector<Stage*>& stages,
+  const Vector<SystemObject*>& systems,
+  const Vector<size_t>& stage_indices,
+  const Vector<BitSet>& conflicts)
+{
+  Vector<IntermediateStep> steps;
+  steps.reserve(systems.size());
+
+  for (SystemObject* system : systems)
+  {
+    steps.push_back({ system, {} });
+  }
 
-        if (stage.HasExplicitOrder(other_system, system) && system.HasDependency(other_system))
-        {
-          steps[other_step_index].dependants.push_back(step_index);
-        }
+  for (size_t i = 0; i < systems.size(); i++)
+  {
+    const Stage& stage = *stages[stage_indices[i]];
 
-        other_step_index++;
-      }
+    for (size_t j = 0; j < systems.size(); j++)
+    {
+      if (!conflicts[i].Test(j)) continue;
 
-      steps.push_back({ system_it->get() });
+      // Systems of earlier stages always run first, systems of the same stage only when explicitly ordered.
+      const bool earlier_stage = stage_indices[j] < stage_indices[i];
+      const bool explicit_order =
+        stage_indices[j] == stage_indices[i] && stage.HasExplicitOrder(*systems[j], *systems[i]);
 
-      step_index++;
+      if (earlier_stage || explicit_order) steps[j].dependants.push_back(i);
     }
   }
 
@@ -170,7 +412,7 @@ Vector<IntermediateStep> ComputeDependencyGraph(const Vector<Stage*>& stages)
 
 Vector<size_t> TopologicalSort(const Vector<IntermediateStep>& steps)
 {
-  // Kahn's algorithm
+  // Kahn's algorithm, using the order itself as the queue
 
   Vector<size_t> in_degree;
   in_degree.resize(steps.size());
@@ -183,89 +425,66 @@ Vector<size_t> TopologicalSort(const Vector<IntermediateStep>& steps)
     }
   }
 
-  Deque<size_t> queue;
-  queue.reserve(steps.size());
+  Vector<size_t> order;
+  order.reserve(steps.size());
 
   for (size_t i = 0; i < steps.size(); i++)
   {
-    if (in_degree[i] == 0)
-    {
-      queue.push_back(i);
-    }
+    if (in_degree[i] == 0) order.push_back(i);
   }
 
-  [[maybe_unused]] size_t visited_counter = 0;
-
-  Vector<size_t> order;
-  order.reserve(steps.size());
-
-  while (!queue.empty())
+  for (size_t head = 0; head < order.size(); head++)
   {
-    size_t index = queue.front();
-    queue.pop_front();
-    order.push_back(index);
-
-    for (auto dependant : steps[index].dependants)
+    for (auto dependant : steps[order[head]].dependants)
     {
-      if (--in_degree[dependant] == 0)
-      {
-        queue.push_back(dependant);
-      }
+      if (--in_degree[dependant] == 0) order.push_back(dependant);
     }
-
-    visited_counter++;
   }
 
-  ASSERT(visited_counter == steps.size(), "Cycle detected");
+  ASSERT(order.size() == steps.size(), "Cycle detected");
 
   return order;
 }
 
 Vector<Scheduler::Step> ComputeExecutionGraph(
-  const Vector<IntermediateStep>& intermediate_steps, const Vector<size_t>& order)
+  const Vector<IntermediateStep>& intermediate_steps, const Vector<size_t>& order, const Vector<BitSet>& conflicts)
 {
+  // Every pair of conflicting systems is ordered as in the topological order, then the edges are transitively reduced
+  // to give as little dependencies as possible to the scheduler every run.
+  //
+  // Candidates are visited from the latest in the order. A candidate is redundant if it is an ancestor of a later
+  // candidate, and every later candidate is either kept or itself an ancestor of a kept one, so looking into the
+  // ancestors of the kept candidates is enough.
+
+  const size_t size = order.size();
+
   Vector<Scheduler::Step> steps;
-  steps.reserve(intermediate_steps.size());
+  steps.reserve(size);
 
-  // Naive transitive reduction.
-  // This allows us to have as little dependencies as possible, giving a little less work to the scheduler every run.
-  // Probably a lot of potential to optimize if ever this becomes a problem. It may even be possible to remove this
-  // if it doesn't provide any significant performance improvements.
-  struct TransitiveReduction
-  {
-    static bool IsRedundant(
-      const Vector<Scheduler::Step>& steps, const Vector<size_t>& dependencies, size_t new_dependency)
-    {
-      for (auto dependency : dependencies)
-      {
-        if (dependency == new_dependency) return true;
-        else if (IsRedundant(steps, steps[dependency].dependencies, new_dependency))
-          return true;
-      }
-      return false;
-    }
-  };
+  Vector<BitSet> ancestors; // Per position
+  ancestors.reserve(size);
 
-  for (size_t i = 0; i < order.size(); i++)
+  for (size_t i = 0; i < size; i++)
   {
-    const auto& intermediate_step = intermediate_steps[order[i]];
+    const BitSet& step_conflicts = conflicts[order[i]];
 
+    BitSet step_ancestors(size);
     Vector<size_t> dependencies;
 
-    for (size_t j = 0; j != i; j++)
+    for (size_t j = i; j-- != 0;)
     {
-      const auto& other_intermediate_step = intermediate_steps[order[j]];
+      if (!step_conflicts.Test(order[j]) || step_ancestors.Test(j)) continue;
 
-      if (intermediate_step.system->HasDependency(*other_intermediate_step.system))
-      {
-        if (!TransitiveReduction::IsRedundant(steps, dependencies, j))
-        {
-          dependencies.push_back(j);
-        }
-      }
+      dependencies.push_back(j);
+
+      step_ancestors |= ancestors[j];
+      step_ancestors.Set(j);
     }
 
-    steps.push_back({ intermediate_step.system, dependencies });
+    std::reverse(dependencies.begin(), dependencies.end());
+
+    steps.push_back({ intermediate_steps[order[i]].system, std::move(dependencies) });
+    ancestors.push_back(std::move(step_ancestors));
   }
 
   return steps;
@@ -273,9 +492,13 @@ Vector<Scheduler::Step> ComputeExecutionGraph(
 
 Vector<Scheduler::Step> ComputeSchedulerData(const Vector<Stage*>& stages)
 {
-  auto intermediate_steps = ComputeDependencyGraph(stages);
+  Vector<size_t> stage_indices;
+
+  auto systems = GatherSystems(stages, stage_indices);
+  auto conflicts = ComputeConflictMatrix(systems);
+  auto intermediate_steps = ComputeDependencyGraph(stages, systems, stage_indices, conflicts);
   auto order = TopologicalSort(intermediate_steps);
-  auto steps = ComputeExecutionGraph(intermediate_steps, order);
+  auto steps = ComputeExecutionGraph(intermediate_steps, order, conflicts);
 
   return steps;
 }
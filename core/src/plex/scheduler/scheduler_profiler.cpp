@@ -0,0 +1,251 @@
+#include "plex/scheduler/scheduler_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace plex
+{
+namespace
+{
+  ///
+  /// Returns the value at the percentile of sorted durations.
+  ///
+  /// @param[in] sorted Sorted durations, not empty.
+  /// @param[in] percentile Percentile between 0 and 1.
+  ///
+  /// @return Duration at the percentile.
+  ///
+  std::chrono::nanoseconds Percentile(const Vector<std::chrono::nanoseconds>& sorted, double percentile) noexcept
+  {
+    return sorted[static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1))];
+  }
+
+  ///
+  /// Returns a new unique profiler id. Zero is never returned.
+  ///
+  /// @return Profiler id.
+  ///
+  uint64_t NextProfilerId() noexcept
+  {
+    static std::atomic_uint64_t next_id { 1 };
+
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Ids of the profilers that are not destroyed.
+  ///
+  struct LiveProfilers
+  {
+    std::mutex mutex;
+    std::unordered_set<uint64_t> ids;
+  };
+
+  ///
+  /// Returns the ids of the live profilers.
+  ///
+  /// @return Live profilers.
+  ///
+  LiveProfilers& Live() noexcept
+  {
+    static LiveProfilers live;
+
+    return live;
+  }
+
+  ///
+  /// Converts a duration to fractional microseconds, the time unit of the Chrome Trace Event format.
+  ///
+  /// @param[in] duration Duration to convert.
+  ///
+  /// @return Duration in microseconds.
+  ///
+  double Microseconds(std::chrono::nanoseconds duration) noexcept
+  {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  }
+} // namespace
+
+SchedulerProfiler::SchedulerProfiler() : id_(NextProfilerId()), run_(0)
+{
+  LiveProfilers& live = Live();
+
+  std::lock_guard lock(live.mutex);
+  live.ids.insert(id_);
+}
+
+SchedulerProfiler::~SchedulerProfiler()
+{
+  LiveProfilers& live = Live();
+
+  std::lock_guard lock(live.mutex);
+  live.ids.erase(id_);
+}
+
+void SchedulerProfiler::Record(SystemHandle system, Clock::time_point start, Clock::time_point end)
+{
+  ThreadBuffer& buffer = LocalBuffer();
+
+  buffer.samples.push_back({ system, run_, buffer.thread, start, end, start - run_start_ });
+}
+
+Vector<SystemSample> SchedulerProfiler::Samples() const
+{
+  Vector<SystemSample> samples;
+
+  {
+    std::lock_guard lock(mutex_);
+
+    for (const auto& buffer : buffers_)
+    {
+      std::ranges::copy(buffer->samples, std::back_inserter(samples));
+    }
+  }
+
+  std::sort(samples.begin(), samples.end(), [](const auto& lhs, const auto& rhs) { return lhs.start < rhs.start; });
+
+  return samples;
+}
+
+Vector<SystemStatistics> SchedulerProfiler::Summary() const
+{
+  struct Durations
+  {
+    Vector<std::chrono::nanoseconds> executions;
+    Vector<std::chrono::nanoseconds> dependency_waits;
+  };
+
+  std::unordered_map<SystemHandle, Durations> durations;
+
+  for (const SystemSample& sample : Samples())
+  {
+    Durations& system_durations = durations[sample.system];
+
+    system_durations.executions.push_back(sample.end - sample.start);
+    system_durations.dependency_waits.push_back(sample.dependency_wait);
+  }
+
+  Vector<SystemStatistics> summary;
+  summary.reserve(durations.size());
+
+  for (auto& [system, system_durations] : durations)
+  {
+    auto& executions = system_durations.executions;
+    auto& dependency_waits = system_durations.dependency_waits;
+
+    std::sort(executions.begin(), executions.end());
+    std::sort(dependency_waits.begin(), dependency_waits.end());
+
+    std::chrono::nanoseconds total { 0 };
+
+    for (const auto execution : executions)
+    {
+      total += execution;
+    }
+
+    summary.push_back({ system,
+      executions.size(),
+      total / static_cast<int64_t>(executions.size()),
+      Percentile(executions, 0.5),
+      Percentile(executions, 0.99),
+      executions.back(),
+      Percentile(dependency_waits, 0.5),
+      Percentile(dependency_waits, 0.99) });
+  }
+
+  std::sort(summary.begin(), summary.end(), [](const auto& lhs, const auto& rhs) { return lhs.p50 > rhs.p50; });
+
+  return summary;
+}
+
+void SchedulerProfiler::WriteChromeTrace(std::ostream& stream) const
+{
+  const Vector<SystemSample> samples = Samples();
+
+  // Timestamps are relative to the first sample, the earliest start since samples are ordered.
+  const Clock::time_point origin = samples.empty() ? Clock::time_point {} : samples.front().start;
+
+  // Nanosecond precision, without scientific notation for long traces.
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+
+  stream << std::fixed << std::setprecision(3);
+
+  stream << "{\"traceEvents\":[";
+
+  for (size_t i = 0; i < samples.size(); i++)
+  {
+    const SystemSample& sample = samples[i];
+
+    if (i != 0) stream << ',';
+
+    stream << "\n{\"name\":\"System " << sample.system << "\",\"cat\":\"system\",\"ph\":\"X\""
+           << ",\"ts\":" << Microseconds(sample.start - origin) << ",\"dur\":"
+           << Microseconds(sample.end - sample.start)
+           << ",\"pid\":0,\"tid\":" << sample.thread << ",\"args\":{\"run\":" << sample.run
+           << ",\"dependency_wait_us\":" << Microseconds(sample.dependency_wait) << "}}";
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+void SchedulerProfiler::Clear()
+{
+  std::lock_guard lock(mutex_);
+
+  for (const auto& buffer : buffers_)
+  {
+    buffer->samples.clear();
+  }
+}
+
+SchedulerProfiler::ThreadBuffer& SchedulerProfiler::LocalBuffer()
+{
+  // Buffers of the thread for every profiler it recorded into, the last one used is checked first since a thread
+  // usually records into a single profiler.
+  struct LocalBuffers
+  {
+    uint64_t last_id = 0;
+    ThreadBuffer* last_buffer = nullptr;
+    std::unordered_map<uint64_t, ThreadBuffer*> buffers;
+  };
+
+  thread_local LocalBuffers local;
+
+  if (local.last_id == id_) [[likely]]
+    return *local.last_buffer;
+
+  auto iterator = local.buffers.find(id_);
+
+  if (iterator == local.buffers.end())
+  {
+    // Buffers of destroyed profilers are dropped first, so that the thread only points to buffers of live profilers.
+    {
+      LiveProfilers& live = Live();
+
+      std::lock_guard lock(live.mutex);
+      std::erase_if(local.buffers, [&live](const auto& entry) { return !live.ids.contains(entry.first); });
+    }
+
+    std::lock_guard lock(mutex_);
+
+    buffers_.push_back(std::make_unique<ThreadBuffer>(ThreadBuffer { buffers_.size(), {} }));
+    iterator = local.buffers.emplace(id_, buffers_.back().get()).first;
+  }
+
+  ThreadBuffer* buffer = iterator->second;
+
+  local.last_id = id_;
+  local.last_buffer = buffer;
+
+  return *buffer;
+}
+} // namespace plex
@@ -1,32 +1,76 @@
 #include "plex/system/system.h"
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 namespace plex
 {
-[[nodiscard]] bool SystemObject::HasDependency(const SystemObject& system) const noexcept
+namespace
 {
-  static constexpr std::string_view any {};
+  ///
+  /// Returns the dense id of a section of a data source, interning it if it was never seen. The whole data source is
+  /// the empty section.
+  ///
+  /// @param[in] source Name of the data source.
+  /// @param[in] section Section of the data source.
+  ///
+  /// @return Id of the section.
+  ///
+  size_t InternSection(std::string_view source, std::string_view section)
+  {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, size_t> ids;
 
-  if (*this == system) return true; // Depends on itself since the system might access local data.
+    std::string key;
+    key.reserve(source.size() + section.size() + 1);
+    key.append(source).push_back('\0'); // Names never contain a null character
+    key.append(section);
+
+    std::lock_guard lock(mutex); // Systems can be created from any thread
 
-  for (const QueryDataAccess& data : data_access_)
+    return ids.try_emplace(std::move(key), ids.size()).first->second;
+  }
+} // namespace
+
+SystemObject::DataAccessSets SystemObject::InternDataAccess(const Vector<QueryDataAccess>& data_access)
+{
+  DataAccessSets sets;
+
+  for (const QueryDataAccess& data : data_access)
   {
     if (data.thread_safe) continue; // Thread safe data cannot form a dependency
 
-    for (const QueryDataAccess& other : system.data_access_)
+    const size_t source = InternSection(data.source, {});
+
+    if (data.section.empty()) (data.read_only ? sets.read_sources : sets.written_sources).Set(source);
+    else
     {
-      if (other.thread_safe) continue; // Thread safe data cannot form a dependency
-      if (other.read_only && data.read_only) continue; // Two reads cannot form a dependency
-      if (other.source != data.source) continue; // Access from different data sources cannot form a dependency
-
-      // The same section of the data source must be accessed for there to be a dependency.
-      if (other.section == any || data.section == any || other.section == data.section)
-      {
-        return true;
-      }
+      const size_t section = InternSection(data.source, data.section);
+
+      (data.read_only ? sets.read_sections : sets.written_sections).Set(section);
+      sets.accessed_sections.Set(section);
     }
+
+    if (!data.read_only) sets.written_to.Set(source);
+    sets.accessed.Set(source);
   }
 
-  return false;
+  return sets;
+}
+
+[[nodiscard]] bool SystemObject::HasDependency(const SystemObject& system) const noexcept
+{
+  if (*this == system) return true; // Depends on itself since the system might access local data.
+
+  const DataAccessSets& self = data_access_;
+  const DataAccessSets& other = system.data_access_;
+
+  // Two reads cannot form a dependency, and the same section must be accessed unless a whole data source is.
+  return self.written_sections.Intersects(other.accessed_sections)
+         || self.read_sections.Intersects(other.written_sections)
+         || self.written_sources.Intersects(other.accessed) || self.read_sources.Intersects(other.written_to)
+         || self.written_to.Intersects(other.read_sources) || self.accessed.Intersects(other.written_sources);
 }
 
-} // namespace plex
\ No newline at end of file
+} // namespace plex
@@ -0,0 +1,139 @@
+#include "plex/async/async_generator.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace plex::tests
+{
+namespace
+{
+  AsyncGenerator<size_t> Iota(size_t amount)
+  {
+    for (size_t i = 0; i < amount; i++)
+    {
+      co_yield i;
+    }
+  }
+
+  template<typename Type>
+  Task<std::vector<std::remove_const_t<Type>>> Collect(AsyncGenerator<Type>& generator)
+  {
+    std::vector<std::remove_const_t<Type>> values;
+
+    while (Type* value = co_await generator.Next())
+    {
+      values.push_back(*value);
+    }
+
+    co_return values;
+  }
+} // namespace
+
+TEST(AsyncGenerator_Tests, Next_Empty_EndsRightAway)
+{
+  auto generator = Iota(0);
+
+  const auto values = SyncWait(Collect(generator));
+
+  EXPECT_TRUE(values.empty());
+  EXPECT_TRUE(generator.IsDone());
+}
+
+TEST(AsyncGenerator_Tests, Next_Synchronous_AllValuesInOrder)
+{
+  constexpr size_t amount = 100;
+
+  auto generator = Iota(amount);
+
+  EXPECT_FALSE(generator.IsDone());
+
+  const auto values = SyncWait(Collect(generator));
+
+  ASSERT_EQ(values.size(), amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    EXPECT_EQ(values[i], i);
+  }
+
+  EXPECT_TRUE(generator.IsDone());
+}
+
+TEST(AsyncGenerator_Tests, Next_Temporaries_YieldedWithoutCopy)
+{
+  auto generator = []() -> AsyncGenerator<const std::string>
+  {
+    co_yield std::string("first");
+    co_yield std::string("second");
+  }();
+
+  const auto values = SyncWait(Collect(generator));
+
+  ASSERT_EQ(values.size(), 2);
+  EXPECT_EQ(values[0], "first");
+  EXPECT_EQ(values[1], "second");
+}
+
+TEST(AsyncGenerator_Tests, Next_AsynchronousProducer_AllValuesInOrder)
+{
+  ThreadPool pool(4, false);
+
+  constexpr size_t amount = 1000;
+
+  // The lambda must outlive the generator, the coroutine refers to its captures.
+  auto produce = [&]() -> AsyncGenerator<size_t>
+  {
+    for (size_t i = 0; i < amount; i++)
+    {
+      co_await pool.Schedule();
+      co_yield i;
+    }
+  };
+
+  auto generator = produce();
+
+  const auto values = SyncWait(Collect(generator));
+
+  ASSERT_EQ(values.size(), amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(AsyncGenerator_Tests, Destructor_StoppedEarly_LocalsDestroyed)
+{
+  auto counter = std::make_shared<int>(0);
+
+  {
+    auto generator = [](std::shared_ptr<int> owned) -> AsyncGenerator<int>
+    {
+      for (;;)
+      {
+        co_yield (*owned)++;
+      }
+    }(counter);
+
+    int sum = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+      int* value = SyncWait(generator.Next());
+
+      ASSERT_NE(value, nullptr);
+      sum += *value;
+    }
+
+    EXPECT_EQ(sum, 0 + 1 + 2);
+    EXPECT_EQ(counter.use_count(), 2);
+  }
+
+  EXPECT_EQ(counter.use_count(), 1);
+}
+} // namespace plex::tests
@@ -0,0 +1,139 @@
+#include "plex/async/async_mutex.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+
+namespace plex::tests
+{
+TEST(AsyncMutex_Tests, TryLock_NotLocked_Locked)
+{
+  ThreadPool pool(1, false);
+
+  AsyncMutex mutex(pool);
+
+  EXPECT_FALSE(mutex.IsLockedApprox());
+  EXPECT_TRUE(mutex.TryLock());
+  EXPECT_TRUE(mutex.IsLockedApprox());
+
+  mutex.Unlock();
+
+  EXPECT_FALSE(mutex.IsLockedApprox());
+}
+
+TEST(AsyncMutex_Tests, TryLock_Locked_Fails)
+{
+  ThreadPool pool(1, false);
+
+  AsyncMutex mutex(pool);
+
+  ASSERT_TRUE(mutex.TryLock());
+  EXPECT_FALSE(mutex.TryLock());
+
+  mutex.Unlock();
+}
+
+TEST(AsyncMutex_Tests, ScopedLock_Uncontended_UnlockedAfterScope)
+{
+  ThreadPool pool(1, false);
+
+  AsyncMutex mutex(pool);
+
+  auto task = [&]() -> Task<>
+  {
+    {
+      auto guard = co_await mutex.ScopedLock();
+
+      EXPECT_TRUE(mutex.IsLockedApprox());
+    }
+
+    EXPECT_FALSE(mutex.IsLockedApprox());
+  };
+
+  SyncWait(task());
+}
+
+TEST(AsyncMutex_Tests, Lock_Locked_WaiterResumedOnPool)
+{
+  ThreadPool pool(2, false);
+
+  AsyncMutex mutex(pool);
+
+  ASSERT_TRUE(mutex.TryLock());
+
+  std::thread::id thread_id;
+
+  auto waiter = [&]() -> Task<>
+  {
+    co_await mutex.Lock();
+
+    thread_id = std::this_thread::get_id();
+
+    mutex.Unlock();
+  };
+
+  auto unlocker = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    mutex.Unlock();
+  };
+
+  SyncWait(WhenAll(waiter(), unlocker()));
+
+  EXPECT_NE(thread_id, std::this_thread::get_id());
+  EXPECT_FALSE(mutex.IsLockedApprox());
+}
+
+TEST(AsyncMutex_Tests, ScopedLock_ManyContended_MutualExclusion)
+{
+  constexpr size_t amount = 1000;
+  constexpr size_t iterations = 20;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    AsyncMutex mutex(pool);
+
+    size_t counter = 0; // Deliberately not atomic
+    size_t inside = 0;
+    bool overlapped = false;
+
+    auto make_task = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < iterations; i++)
+      {
+        auto guard = co_await mutex.ScopedLock();
+
+        if (inside++ != 0) overlapped = true;
+
+        counter++;
+
+        inside--;
+      }
+    };
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    EXPECT_FALSE(overlapped);
+    EXPECT_EQ(counter, amount * iterations);
+    EXPECT_FALSE(mutex.IsLockedApprox());
+  }
+}
+} // namespace plex::tests
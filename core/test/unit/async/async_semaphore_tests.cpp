@@ -0,0 +1,237 @@
+#include "plex/async/async_semaphore.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "plex/async/cancellation.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+
+namespace plex::tests
+{
+TEST(AsyncSemaphore_Tests, TryAcquire_Permits_TakesUntilEmpty)
+{
+  ThreadPool pool(1, false);
+
+  AsyncSemaphore semaphore(pool, 2);
+
+  EXPECT_EQ(semaphore.AvailableApprox(), 2);
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_FALSE(semaphore.TryAcquire());
+  EXPECT_EQ(semaphore.AvailableApprox(), 0);
+
+  semaphore.Release(2);
+
+  EXPECT_EQ(semaphore.AvailableApprox(), 2);
+}
+
+TEST(AsyncSemaphore_Tests, Acquire_NoPermits_ResumedByRelease)
+{
+  ThreadPool pool(2, false);
+
+  AsyncSemaphore semaphore(pool, 0);
+
+  std::atomic_size_t acquired = 0;
+
+  auto waiter = [&]() -> Task<>
+  {
+    co_await semaphore.Acquire();
+
+    acquired++;
+  };
+
+  auto releaser = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    semaphore.Release(3);
+  };
+
+  SyncWait(WhenAll(waiter(), releaser()));
+
+  EXPECT_EQ(acquired, 1);
+  EXPECT_EQ(semaphore.AvailableApprox(), 2);
+}
+
+TEST(AsyncSemaphore_Tests, Acquire_ManyContended_NeverMoreThanPermits)
+{
+  constexpr size_t amount = 1000;
+  constexpr size_t permits = 3;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    AsyncSemaphore semaphore(pool, permits);
+
+    std::atomic_size_t inside = 0;
+    std::atomic_size_t max_inside = 0;
+    std::atomic_size_t completed = 0;
+
+    auto make_task = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      co_await semaphore.Acquire();
+
+      const size_t current = ++inside;
+
+      size_t max = max_inside.load();
+      while (current > max && !max_inside.compare_exchange_weak(max, current)) {}
+
+      inside--;
+      completed++;
+
+      semaphore.Release();
+    };
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    EXPECT_EQ(completed, amount);
+    EXPECT_LE(max_inside, permits);
+    EXPECT_EQ(semaphore.AvailableApprox(), permits);
+  }
+}
+
+TEST(AsyncSemaphore_Tests, AcquireCancellable_CancelledWhileWaiting_ResumedWithoutPermit)
+{
+  using namespace std::chrono_literals;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(2, false, mode);
+
+    AsyncSemaphore semaphore(pool, 0);
+
+    CancellationSource source;
+
+    auto waiter = [&]() -> Task<bool> { co_return co_await semaphore.Acquire(source.Token()); };
+
+    auto canceller = [&]() -> Task<>
+    {
+      co_await pool.SleepFor(5ms);
+      source.Cancel();
+    };
+
+    auto [acquired, ignored] = SyncWait(CollectAll(waiter(), canceller()));
+
+    EXPECT_FALSE(acquired);
+
+    // The cancelled waiter is gone, the permit is kept.
+    semaphore.Release();
+
+    EXPECT_EQ(semaphore.AvailableApprox(), 1);
+  }
+}
+
+TEST(AsyncSemaphore_Tests, AcquireCancellable_AlreadyCancelled_ReturnsFalse)
+{
+  ThreadPool pool(1, false);
+
+  AsyncSemaphore semaphore(pool, 1);
+
+  CancellationSource source;
+  source.Cancel();
+
+  auto task = [&]() -> Task<bool> { co_return co_await semaphore.Acquire(source.Token()); };
+
+  EXPECT_FALSE(SyncWait(task()));
+  EXPECT_EQ(semaphore.AvailableApprox(), 1);
+}
+
+TEST(AsyncSemaphore_Tests, AcquireCancellable_NotCancelled_ReturnsTrue)
+{
+  ThreadPool pool(2, false);
+
+  AsyncSemaphore semaphore(pool, 0);
+
+  CancellationSource source;
+
+  auto waiter = [&]() -> Task<bool> { co_return co_await semaphore.Acquire(source.Token()); };
+
+  auto releaser = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    semaphore.Release();
+  };
+
+  auto [acquired, ignored] = SyncWait(CollectAll(waiter(), releaser()));
+
+  EXPECT_TRUE(acquired);
+  EXPECT_EQ(semaphore.AvailableApprox(), 0);
+}
+
+TEST(AsyncSemaphore_Tests, AcquireCancellable_ManyCancelledWhileReleasing_PermitsKept)
+{
+  constexpr size_t amount = 1000;
+  constexpr size_t permits = amount / 2;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    AsyncSemaphore semaphore(pool, 0);
+
+    CancellationSource source;
+
+    std::atomic_size_t acquired = 0;
+    std::atomic_size_t cancelled = 0;
+
+    auto make_waiter = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      if (co_await semaphore.Acquire(source.Token())) acquired++;
+      else
+      {
+        cancelled++;
+      }
+    };
+
+    auto releaser = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < permits; i++)
+      {
+        semaphore.Release();
+      }
+    };
+
+    auto canceller = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+      source.Cancel();
+    };
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount + 2);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_waiter());
+    }
+
+    tasks.push_back(releaser());
+    tasks.push_back(canceller());
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    EXPECT_EQ(acquired + cancelled, amount);
+    EXPECT_EQ(acquired + semaphore.AvailableApprox(), permits);
+  }
+}
+} // namespace plex::tests
@@ -0,0 +1,150 @@
+#include "plex/async/async_shared_mutex.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+
+namespace plex::tests
+{
+TEST(AsyncSharedMutex_Tests, TryLockShared_ManyReaders_AllLocked)
+{
+  ThreadPool pool(1, false);
+
+  AsyncSharedMutex mutex(pool);
+
+  EXPECT_TRUE(mutex.TryLockShared());
+  EXPECT_TRUE(mutex.TryLockShared());
+  EXPECT_FALSE(mutex.TryLock());
+
+  mutex.UnlockShared();
+  mutex.UnlockShared();
+
+  EXPECT_FALSE(mutex.IsLockedApprox());
+}
+
+TEST(AsyncSharedMutex_Tests, TryLock_Writer_ExcludesReadersAndWriters)
+{
+  ThreadPool pool(1, false);
+
+  AsyncSharedMutex mutex(pool);
+
+  EXPECT_TRUE(mutex.TryLock());
+  EXPECT_FALSE(mutex.TryLock());
+  EXPECT_FALSE(mutex.TryLockShared());
+
+  mutex.Unlock();
+
+  EXPECT_FALSE(mutex.IsLockedApprox());
+}
+
+TEST(AsyncSharedMutex_Tests, Lock_ReadersHolding_WriterWaitsForLastReader)
+{
+  ThreadPool pool(2, false);
+
+  AsyncSharedMutex mutex(pool);
+
+  ASSERT_TRUE(mutex.TryLockShared());
+  ASSERT_TRUE(mutex.TryLockShared());
+
+  std::atomic_bool written = false;
+
+  auto writer = [&]() -> Task<>
+  {
+    auto guard = co_await mutex.ScopedLock();
+
+    written = true;
+  };
+
+  auto readers = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    // The writer is waiting, new readers must wait behind it.
+    while (mutex.TryLockShared())
+    {
+      mutex.UnlockShared();
+    }
+
+    EXPECT_FALSE(written);
+
+    mutex.UnlockShared();
+
+    EXPECT_FALSE(written);
+
+    mutex.UnlockShared();
+  };
+
+  SyncWait(WhenAll(writer(), readers()));
+
+  EXPECT_TRUE(written);
+  EXPECT_FALSE(mutex.IsLockedApprox());
+}
+
+TEST(AsyncSharedMutex_Tests, ScopedLock_MixedContended_WritersExclusive)
+{
+  constexpr size_t amount = 1000;
+  constexpr size_t iterations = 10;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    AsyncSharedMutex mutex(pool);
+
+    size_t counter = 0; // Deliberately not atomic, only written by writers
+    std::atomic_size_t readers = 0;
+    std::atomic_size_t writers = 0;
+    std::atomic_bool violated = false;
+
+    auto make_task = [&](bool writer) -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < iterations; i++)
+      {
+        if (writer)
+        {
+          auto guard = co_await mutex.ScopedLock();
+
+          if (writers++ != 0 || readers != 0) violated = true;
+
+          counter++;
+
+          writers--;
+        }
+        else
+        {
+          auto guard = co_await mutex.ScopedLockShared();
+
+          readers++;
+
+          if (writers != 0) violated = true;
+
+          [[maybe_unused]] volatile size_t read = counter;
+
+          readers--;
+        }
+      }
+    };
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task(i % 4 == 0));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    EXPECT_FALSE(violated);
+    EXPECT_EQ(counter, (amount / 4) * iterations);
+    EXPECT_FALSE(mutex.IsLockedApprox());
+  }
+}
+} // namespace plex::tests
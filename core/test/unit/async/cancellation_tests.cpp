@@ -0,0 +1,83 @@
+#include "plex/async/cancellation.h"
+
+#include <gtest/gtest.h>
+
+namespace plex::tests
+{
+TEST(Cancellation_Tests, Token_Default_NeverCancelled)
+{
+  CancellationToken token;
+
+  EXPECT_FALSE(token.CanBeCancelled());
+  EXPECT_FALSE(token.IsCancellationRequested());
+}
+
+TEST(Cancellation_Tests, Cancel_Source_ObservedByTokens)
+{
+  CancellationSource source;
+  CancellationToken token = source.Token();
+
+  EXPECT_TRUE(token.CanBeCancelled());
+  EXPECT_FALSE(token.IsCancellationRequested());
+
+  EXPECT_TRUE(source.Cancel());
+  EXPECT_FALSE(source.Cancel());
+
+  EXPECT_TRUE(source.IsCancellationRequested());
+  EXPECT_TRUE(token.IsCancellationRequested());
+  EXPECT_TRUE(source.Token().IsCancellationRequested());
+}
+
+TEST(Cancellation_Tests, Cancel_CopiedSource_SharesState)
+{
+  CancellationSource source;
+  CancellationSource copy = source;
+
+  copy.Cancel();
+
+  EXPECT_TRUE(source.IsCancellationRequested());
+}
+
+TEST(Cancellation_Tests, Callback_Registered_InvokedOnCancel)
+{
+  CancellationSource source;
+
+  size_t invocations = 0;
+
+  CancellationCallback callback(source.Token(), [&]() { invocations++; });
+
+  EXPECT_EQ(invocations, 0);
+
+  source.Cancel();
+  source.Cancel();
+
+  EXPECT_EQ(invocations, 1);
+}
+
+TEST(Cancellation_Tests, Callback_AlreadyCancelled_InvokedOnRegistration)
+{
+  CancellationSource source;
+  source.Cancel();
+
+  size_t invocations = 0;
+
+  CancellationCallback callback(source.Token(), [&]() { invocations++; });
+
+  EXPECT_EQ(invocations, 1);
+}
+
+TEST(Cancellation_Tests, Callback_Destroyed_NotInvoked)
+{
+  CancellationSource source;
+
+  size_t invocations = 0;
+
+  {
+    CancellationCallback callback(source.Token(), [&]() { invocations++; });
+  }
+
+  source.Cancel();
+
+  EXPECT_EQ(invocations, 0);
+}
+} // namespace plex::tests
@@ -0,0 +1,288 @@
+#include "plex/async/channel.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "plex/async/cancellation.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/when_all.h"
+
+namespace plex::tests
+{
+TEST(Channel_Tests, SendReceive_WithinCapacity_FifoOrder)
+{
+  ThreadPool pool(1, false);
+
+  Channel<int, ChannelMode::SingleProducerSingleConsumer> channel(pool, 4);
+
+  auto task = [&]() -> Task<>
+  {
+    co_await channel.Send(1);
+    co_await channel.Send(2);
+    co_await channel.Send(3);
+
+    EXPECT_EQ(co_await channel.Receive(), 1);
+    EXPECT_EQ(co_await channel.Receive(), 2);
+    EXPECT_EQ(co_await channel.Receive(), 3);
+  };
+
+  SyncWait(task());
+}
+
+TEST(Channel_Tests, Receive_Closed_DrainsThenNothing)
+{
+  ThreadPool pool(1, false);
+
+  Channel<int> channel(pool, 4);
+
+  auto task = [&]() -> Task<>
+  {
+    co_await channel.Send(42);
+
+    channel.Close();
+
+    EXPECT_EQ(co_await channel.Receive(), 42);
+    EXPECT_EQ(co_await channel.Receive(), std::nullopt);
+    EXPECT_EQ(co_await channel.Receive(), std::nullopt);
+  };
+
+  SyncWait(task());
+}
+
+TEST(Channel_Tests, SendReceive_MoveOnly_Moved)
+{
+  ThreadPool pool(1, false);
+
+  Channel<std::unique_ptr<int>> channel(pool, 1);
+
+  auto task = [&]() -> Task<std::optional<std::unique_ptr<int>>>
+  {
+    co_await channel.Send(std::make_unique<int>(7));
+
+    co_return co_await channel.Receive();
+  };
+
+  auto value = SyncWait(task());
+
+  ASSERT_TRUE(value);
+  EXPECT_EQ(**value, 7);
+}
+
+TEST(Channel_Tests, Destructor_ValuesLeft_Destroyed)
+{
+  ThreadPool pool(1, false);
+
+  auto shared = std::make_shared<int>(0);
+
+  {
+    Channel<std::shared_ptr<int>, ChannelMode::SingleProducerSingleConsumer> channel(pool, 2);
+
+    auto task = [&]() -> Task<>
+    {
+      co_await channel.Send(shared);
+      co_await channel.Send(shared);
+    };
+
+    SyncWait(task());
+
+    EXPECT_EQ(shared.use_count(), 3);
+  }
+
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(Channel_Tests, SendReceive_SingleProducerSingleConsumerFull_AllInOrder)
+{
+  constexpr int amount = 10000;
+
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  Channel<int, ChannelMode::SingleProducerSingleConsumer> channel(pool, 8);
+
+  bool in_order = true;
+  int received = 0;
+
+  auto producer = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    for (int i = 0; i < amount; i++)
+    {
+      co_await channel.Send(i);
+    }
+
+    channel.Close();
+  };
+
+  auto consumer = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    while (auto value = co_await channel.Receive())
+    {
+      if (*value != received) in_order = false;
+
+      received++;
+    }
+  };
+
+  SyncWait(WhenAll(producer(), consumer()));
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(received, amount);
+}
+
+TEST(Channel_Tests, SendReceive_ManyProducersManyConsumers_EveryValueOnce)
+{
+  constexpr size_t producers = 8;
+  constexpr size_t consumers = 8;
+  constexpr size_t amount = 2000;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    Channel<size_t> channel(pool, 16);
+
+    auto counts = std::make_unique<std::atomic_size_t[]>(producers * amount);
+
+    std::atomic_size_t producing = producers;
+
+    auto make_producer = [&](size_t index) -> Task<>
+    {
+      co_await pool.Schedule();
+
+      for (size_t i = 0; i < amount; i++)
+      {
+        co_await channel.Send(index * amount + i);
+      }
+
+      if (--producing == 0) channel.Close();
+    };
+
+    auto make_consumer = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      while (auto value = co_await channel.Receive())
+      {
+        counts[*value]++;
+      }
+    };
+
+    std::vector<Task<>> tasks;
+
+    for (size_t i = 0; i < producers; i++)
+    {
+      tasks.push_back(make_producer(i));
+    }
+
+    for (size_t i = 0; i < consumers; i++)
+    {
+      tasks.push_back(make_consumer());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    for (size_t i = 0; i < producers * amount; i++)
+    {
+      ASSERT_EQ(counts[i], 1) << "Value " << i;
+    }
+  }
+}
+
+TEST(Channel_Tests, ReceiveCancellable_CancelledWhileEmpty_NothingAndValuesKept)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false);
+
+  Channel<int> channel(pool, 4);
+
+  CancellationSource source;
+
+  auto receiver = [&]() -> Task<std::optional<int>> { co_return co_await channel.Receive(source.Token()); };
+
+  auto canceller = [&]() -> Task<>
+  {
+    co_await pool.SleepFor(5ms);
+    source.Cancel();
+  };
+
+  auto [received, ignored] = SyncWait(CollectAll(receiver(), canceller()));
+
+  EXPECT_EQ(received, std::nullopt);
+
+  // The cancelled receiver does not take the next value.
+  auto task = [&]() -> Task<>
+  {
+    co_await channel.Send(42);
+
+    EXPECT_EQ(co_await channel.Receive(), 42);
+  };
+
+  SyncWait(task());
+}
+
+TEST(Channel_Tests, SendCancellable_CancelledWhileFull_NotSent)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false);
+
+  Channel<int> channel(pool, 1);
+
+  CancellationSource source;
+
+  auto sender = [&]() -> Task<bool>
+  {
+    co_await channel.Send(1);
+
+    co_return co_await channel.Send(2, source.Token());
+  };
+
+  auto canceller = [&]() -> Task<>
+  {
+    co_await pool.SleepFor(5ms);
+    source.Cancel();
+  };
+
+  auto [sent, ignored] = SyncWait(CollectAll(sender(), canceller()));
+
+  EXPECT_FALSE(sent);
+
+  channel.Close();
+
+  auto task = [&]() -> Task<>
+  {
+    EXPECT_EQ(co_await channel.Receive(), 1);
+    EXPECT_EQ(co_await channel.Receive(), std::nullopt);
+  };
+
+  SyncWait(task());
+}
+
+TEST(Channel_Tests, SendReceiveCancellable_NotCancelled_Delivered)
+{
+  ThreadPool pool(1, false);
+
+  Channel<int, ChannelMode::SingleProducerSingleConsumer> channel(pool, 2);
+
+  CancellationSource source;
+
+  auto task = [&]() -> Task<>
+  {
+    EXPECT_TRUE(co_await channel.Send(1, source.Token()));
+    EXPECT_TRUE(co_await channel.Send(2, source.Token()));
+
+    EXPECT_EQ(co_await channel.Receive(source.Token()), 1);
+    EXPECT_EQ(co_await channel.Receive(source.Token()), 2);
+  };
+
+  SyncWait(task());
+}
+} // namespace plex::tests
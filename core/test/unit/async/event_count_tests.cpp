@@ -0,0 +1,162 @@
+#include "plex/async/event_count.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace plex::tests
+{
+TEST(EventCount_Tests, Constructor_Default_NoWaiters)
+{
+  EventCount event_count;
+
+  EXPECT_EQ(event_count.WaitersApprox(), 0);
+}
+
+TEST(EventCount_Tests, PrepareWait_Single_OneWaiter)
+{
+  EventCount event_count;
+
+  [[maybe_unused]] auto key = event_count.PrepareWait();
+
+  EXPECT_EQ(event_count.WaitersApprox(), 1);
+
+  event_count.CancelWait();
+
+  EXPECT_EQ(event_count.WaitersApprox(), 0);
+}
+
+TEST(EventCount_Tests, Wait_NotifiedBeforeWait_DoesNotBlock)
+{
+  EventCount event_count;
+
+  auto key = event_count.PrepareWait();
+
+  event_count.NotifyOne();
+
+  event_count.Wait(key);
+
+  EXPECT_EQ(event_count.WaitersApprox(), 0);
+}
+
+TEST(EventCount_Tests, Wait_NotifiedFromOtherThread_Wakes)
+{
+  EventCount event_count;
+
+  std::atomic_bool condition = false;
+
+  std::thread waiter(
+    [&]()
+    {
+      while (!condition.load(std::memory_order_acquire))
+      {
+        auto key = event_count.PrepareWait();
+
+        if (condition.load(std::memory_order_acquire)) event_count.CancelWait();
+        else
+        {
+          event_count.Wait(key);
+        }
+      }
+    });
+
+  condition.store(true, std::memory_order_release);
+  event_count.NotifyOne();
+
+  waiter.join();
+
+  EXPECT_EQ(event_count.WaitersApprox(), 0);
+}
+
+TEST(EventCount_Tests, NotifyAll_MultipleWaiters_AllWake)
+{
+  constexpr size_t amount = 8;
+
+  EventCount event_count;
+
+  std::atomic_bool condition = false;
+  std::atomic_size_t woken = 0;
+
+  std::vector<std::thread> waiters;
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    waiters.emplace_back(
+      [&]()
+      {
+        while (!condition.load(std::memory_order_acquire))
+        {
+          auto key = event_count.PrepareWait();
+
+          if (condition.load(std::memory_order_acquire)) event_count.CancelWait();
+          else
+          {
+            event_count.Wait(key);
+          }
+        }
+
+        woken++;
+      });
+  }
+
+  condition.store(true, std::memory_order_release);
+  event_count.NotifyAll();
+
+  for (auto& waiter : waiters)
+  {
+    waiter.join();
+  }
+
+  EXPECT_EQ(woken, amount);
+}
+
+TEST(EventCount_Tests, NotifyMany_MultipleWaiters_AllWake)
+{
+  constexpr size_t amount = 8;
+
+  EventCount event_count;
+
+  std::atomic_bool condition = false;
+  std::atomic_size_t woken = 0;
+
+  std::vector<std::thread> waiters;
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    waiters.emplace_back(
+      [&]()
+      {
+        while (!condition.load(std::memory_order_acquire))
+        {
+          auto key = event_count.PrepareWait();
+
+          if (condition.load(std::memory_order_acquire)) event_count.CancelWait();
+          else
+          {
+            event_count.Wait(key);
+          }
+        }
+
+        woken++;
+      });
+  }
+
+  condition.store(true, std::memory_order_release);
+
+  // Only wakes some of them, the others must be woken up by the following notifications.
+  for (size_t i = 0; i < amount; i++)
+  {
+    event_count.NotifyMany(1);
+  }
+
+  event_count.NotifyMany(amount);
+
+  for (auto& waiter : waiters)
+  {
+    waiter.join();
+  }
+
+  EXPECT_EQ(woken, amount);
+}
+} // namespace plex::tests
@@ -0,0 +1,135 @@
+#include "plex/async/frame_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+
+namespace plex::tests
+{
+namespace
+{
+  Task<int> ReturnValue(int value)
+  {
+    co_return value;
+  }
+} // namespace
+
+TEST(FrameAllocator_Tests, AllocateFrame_Single_Writable)
+{
+  void* frame = AllocateFrame(100);
+
+  ASSERT_NE(frame, nullptr);
+
+  std::memset(frame, 0xFF, 100);
+
+  DeallocateFrame(frame, 100);
+}
+
+TEST(FrameAllocator_Tests, AllocateFrame_SameSizeAfterDeallocate_Reused)
+{
+  void* frame1 = AllocateFrame(200);
+  DeallocateFrame(frame1, 200);
+
+  void* frame2 = AllocateFrame(200);
+  DeallocateFrame(frame2, 200);
+
+  EXPECT_EQ(frame1, frame2);
+}
+
+TEST(FrameAllocator_Tests, AllocateFrame_ManySizes_NoOverlap)
+{
+  std::vector<std::pair<std::byte*, size_t>> frames;
+
+  for (size_t size = 1; size <= 8192; size = size * 3 / 2 + 1)
+  {
+    auto frame = static_cast<std::byte*>(AllocateFrame(size));
+
+    std::memset(frame, static_cast<int>(frames.size()), size);
+
+    frames.emplace_back(frame, size);
+  }
+
+  for (size_t i = 0; i != frames.size(); i++)
+  {
+    const auto& [frame, size] = frames[i];
+
+    for (size_t j = 0; j != size; j++)
+    {
+      ASSERT_EQ(frame[j], static_cast<std::byte>(i));
+    }
+
+    DeallocateFrame(frame, size);
+  }
+}
+
+TEST(FrameAllocator_Tests, AllocateFrame_Large_CountsHeapAllocation)
+{
+  const auto before = GetFrameAllocatorStats();
+
+  void* frame = AllocateFrame(1 << 16);
+  DeallocateFrame(frame, 1 << 16);
+
+  const auto after = GetFrameAllocatorStats();
+
+  EXPECT_GE(after.allocations - before.allocations, 1);
+  EXPECT_GE(after.deallocations - before.deallocations, 1);
+  EXPECT_GE(after.heap_allocations - before.heap_allocations, 1);
+}
+
+TEST(FrameAllocator_Tests, DeallocateFrame_OtherThread_Reusable)
+{
+  constexpr size_t amount = 1000;
+
+  std::vector<void*> frames;
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    frames.push_back(AllocateFrame(128));
+  }
+
+  std::thread thread(
+    [&]()
+    {
+      for (void* frame : frames)
+      {
+        DeallocateFrame(frame, 128);
+      }
+    });
+
+  thread.join();
+
+  // Frames given back by the exited thread are reused instead of allocating more.
+  const auto before = GetFrameAllocatorStats();
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    frames[i] = AllocateFrame(128);
+  }
+
+  const auto after = GetFrameAllocatorStats();
+
+  EXPECT_EQ(after.heap_allocations, before.heap_allocations);
+
+  for (void* frame : frames)
+  {
+    DeallocateFrame(frame, 128);
+  }
+}
+
+TEST(FrameAllocator_Tests, Task_Create_CountsAllocation)
+{
+  const auto before = GetFrameAllocatorStats();
+
+  EXPECT_EQ(SyncWait(ReturnValue(10)), 10);
+
+  const auto after = GetFrameAllocatorStats();
+
+  EXPECT_GE(after.allocations - before.allocations, 1);
+  EXPECT_GE(after.deallocations - before.deallocations, 1);
+}
+} // namespace plex::tests
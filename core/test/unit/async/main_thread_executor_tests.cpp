@@ -0,0 +1,108 @@
+#include "plex/async/main_thread_executor.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/thread_pool.h"
+#include "plex/async/when_all.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace plex::tests
+{
+TEST(MainThreadExecutor_Tests, RunPending_NothingScheduled_ReturnsZero)
+{
+  MainThreadExecutor executor;
+
+  EXPECT_TRUE(executor.IsExecutorThread());
+  EXPECT_EQ(executor.RunPending(), 0);
+}
+
+TEST(MainThreadExecutor_Tests, RunPending_Scheduled_ResumedInScheduleOrder)
+{
+  MainThreadExecutor executor;
+
+  std::vector<size_t> order;
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    co_await executor.Schedule();
+    order.push_back(index);
+  };
+
+  std::vector<Task<>> tasks;
+
+  for (size_t i = 0; i < 4; i++)
+  {
+    tasks.push_back(make_task(i));
+  }
+
+  auto when_all = WhenAll(std::move(tasks));
+
+  SyncWaitFlag flag;
+
+  auto trigger_task = MakeTriggerTask<SyncWaitFlag>(when_all);
+
+  trigger_task.Start(flag);
+
+  EXPECT_TRUE(order.empty());
+  EXPECT_EQ(executor.RunPending(), 4);
+  EXPECT_TRUE(flag.IsDone());
+
+  ASSERT_EQ(order.size(), 4);
+
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(MainThreadExecutor_Tests, RunUntilComplete_HopsBetweenPoolAndMain_ResumedOnMainThread)
+{
+  ThreadPool pool(4, false);
+  MainThreadExecutor executor;
+
+  const std::thread::id main_thread_id = std::this_thread::get_id();
+
+  constexpr size_t amount = 64;
+
+  std::atomic_size_t on_main = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    for (size_t i = 0; i < 4; i++)
+    {
+      co_await pool.Schedule();
+      co_await executor.Schedule();
+
+      if (std::this_thread::get_id() == main_thread_id) on_main++;
+    }
+  };
+
+  std::vector<Task<>> tasks;
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task());
+  }
+
+  executor.RunUntilComplete(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(on_main, 4 * amount);
+}
+
+TEST(MainThreadExecutor_Tests, RunUntilComplete_Value_ReturnsResult)
+{
+  ThreadPool pool(2, false);
+  MainThreadExecutor executor;
+
+  auto task = [&]() -> Task<int>
+  {
+    co_await pool.Schedule();
+    co_await executor.Schedule();
+    co_return 42;
+  };
+
+  EXPECT_EQ(executor.RunUntilComplete(task()), 42);
+}
+} // namespace plex::tests
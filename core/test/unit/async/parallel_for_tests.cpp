@@ -0,0 +1,145 @@
+#include "plex/async/parallel_for.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "plex/async/sync_wait.h"
+
+namespace plex::tests
+{
+TEST(ParallelFor_Tests, ParallelFor_Empty_NoInvocations)
+{
+  ThreadPool pool(4, false);
+
+  std::atomic_size_t invocations = 0;
+
+  SyncWait(ParallelFor(pool, 10, 10, 1, [&](size_t) { invocations++; }));
+
+  EXPECT_EQ(invocations, 0);
+}
+
+TEST(ParallelFor_Tests, ParallelFor_PerIndex_EveryIndexOnce)
+{
+  constexpr size_t amount = 10000;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    auto counts = std::make_unique<std::atomic_size_t[]>(amount);
+
+    SyncWait(ParallelFor(pool, 0, amount, 16, [&](size_t i) { counts[i]++; }));
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      ASSERT_EQ(counts[i], 1) << "Index " << i;
+    }
+  }
+}
+
+TEST(ParallelFor_Tests, ParallelFor_PerChunk_ChunksCoverRange)
+{
+  constexpr size_t begin = 100;
+  constexpr size_t end = 5000;
+  constexpr size_t grain = 64;
+
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  std::atomic_size_t covered = 0;
+  std::atomic_size_t chunks = 0;
+  std::atomic_bool out_of_range = false;
+
+  SyncWait(ParallelFor(pool,
+    begin,
+    end,
+    grain,
+    [&](size_t chunk_begin, size_t chunk_end)
+    {
+      if (chunk_begin < begin || chunk_end > end || chunk_begin >= chunk_end) out_of_range = true;
+
+      covered += chunk_end - chunk_begin;
+      chunks++;
+    }));
+
+  EXPECT_FALSE(out_of_range);
+  EXPECT_EQ(covered, end - begin);
+  EXPECT_LE(chunks, (end - begin + grain - 1) / grain);
+}
+
+TEST(ParallelFor_Tests, ParallelFor_SmallerThanGrain_SingleChunkOnAwaitingThread)
+{
+  ThreadPool pool(4, false);
+
+  size_t chunks = 0;
+  std::thread::id thread_id;
+
+  SyncWait(ParallelFor(pool,
+    0,
+    10,
+    100,
+    [&](size_t, size_t)
+    {
+      chunks++;
+      thread_id = std::this_thread::get_id();
+    }));
+
+  EXPECT_EQ(chunks, 1);
+  EXPECT_EQ(thread_id, std::this_thread::get_id());
+}
+
+TEST(ParallelFor_Tests, ParallelReduce_Empty_Identity)
+{
+  ThreadPool pool(4, false);
+
+  const auto result = SyncWait(ParallelReduce(
+    pool, 5, 5, 1, size_t { 42 }, [](size_t i) { return i; }, [](size_t a, size_t b) { return a + b; }));
+
+  EXPECT_EQ(result, 42);
+}
+
+TEST(ParallelFor_Tests, ParallelReduce_SumPerIndex_CorrectValue)
+{
+  constexpr size_t amount = 100000;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    const auto result = SyncWait(ParallelReduce(
+      pool, 0, amount, 128, size_t { 0 }, [](size_t i) { return i; }, [](size_t a, size_t b) { return a + b; }));
+
+    EXPECT_EQ(result, amount * (amount - 1) / 2);
+  }
+}
+
+TEST(ParallelFor_Tests, ParallelReduce_MaxPerChunk_CorrectValue)
+{
+  constexpr size_t amount = 50000;
+
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  const auto result = SyncWait(ParallelReduce(
+    pool,
+    0,
+    amount,
+    256,
+    size_t { 0 },
+    [](size_t chunk_begin, size_t chunk_end)
+    {
+      size_t max = 0;
+
+      for (size_t i = chunk_begin; i != chunk_end; i++)
+      {
+        max = std::max(max, (i * 7919) % amount);
+      }
+
+      return max;
+    },
+    [](size_t a, size_t b) { return std::max(a, b); }));
+
+  EXPECT_EQ(result, amount - 1);
+}
+} // namespace plex::tests
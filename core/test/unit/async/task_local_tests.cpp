@@ -0,0 +1,153 @@
+#include "plex/async/task_local.h"
+#include "plex/async/async_generator.h"
+#include "plex/async/shared_task.h"
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/thread_pool.h"
+#include "plex/async/when_all.h"
+
+#include <gtest/gtest.h>
+
+namespace plex::tests
+{
+namespace
+{
+  TaskLocal<int> cValue;
+} // namespace
+
+TEST(TaskLocal_Tests, Get_NoContext_Nullptr)
+{
+  EXPECT_EQ(TaskContext::Current(), nullptr);
+  EXPECT_EQ(cValue.Get(), nullptr);
+
+  auto task = []() -> Task<int*> { co_return cValue.Get(); };
+
+  EXPECT_EQ(SyncWait(task()), nullptr);
+}
+
+TEST(TaskLocal_Tests, WithTaskContext_HopsBetweenWorkers_SameValue)
+{
+  ThreadPool pool(4, false);
+
+  TaskContext context;
+
+  int value = 10;
+
+  auto task = [&]() -> Task<size_t>
+  {
+    cValue.Set(&value);
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 100; i++)
+    {
+      co_await pool.Schedule();
+
+      if (cValue.Get() != &value) mismatches++;
+    }
+
+    co_return mismatches;
+  };
+
+  EXPECT_EQ(SyncWait(WithTaskContext(context, task())), 0);
+
+  // The context does not leak out of the task.
+  EXPECT_EQ(TaskContext::Current(), nullptr);
+}
+
+TEST(TaskLocal_Tests, WithTaskContext_StartedTasks_InheritContext)
+{
+  ThreadPool pool(4, false);
+
+  TaskContext context;
+
+  int value = 10;
+
+  auto child = [&]() -> Task<int*>
+  {
+    co_await pool.Schedule();
+    co_return cValue.Get();
+  };
+
+  auto shared_child = [&]() -> SharedTask<int*>
+  {
+    co_await pool.Schedule();
+    co_return cValue.Get();
+  };
+
+  auto generator = [&]() -> AsyncGenerator<int*>
+  {
+    co_await pool.Schedule();
+    co_yield cValue.Get();
+  };
+
+  auto parent = [&]() -> Task<bool>
+  {
+    cValue.Set(&value);
+
+    auto [first, second] = co_await CollectAll(child(), child());
+
+    const bool children = first == &value && second == &value;
+    const bool shared = co_await shared_child() == &value;
+
+    auto values = generator();
+    int* const* generated_value = co_await values.Next();
+    const bool generated = generated_value != nullptr && *generated_value == &value;
+
+    co_await pool.Schedule();
+
+    co_return children && shared && generated && cValue.Get() == &value;
+  };
+
+  EXPECT_TRUE(SyncWait(WithTaskContext(context, parent())));
+}
+
+TEST(TaskLocal_Tests, WithTaskContext_ConcurrentContexts_Isolated)
+{
+  ThreadPool pool(4, false);
+
+  constexpr size_t amount = 64;
+
+  std::vector<TaskContext> contexts(amount);
+  std::vector<int> values(amount);
+
+  std::atomic_size_t mismatches = 0;
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    cValue.Set(&values[index]);
+
+    for (size_t i = 0; i < 16; i++)
+    {
+      co_await pool.Schedule();
+
+      if (cValue.Get() != &values[index]) mismatches++;
+    }
+  };
+
+  std::vector<Task<>> tasks;
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(WithTaskContext(contexts[i], make_task(i)));
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(mismatches, 0);
+}
+
+TEST(TaskLocal_Tests, Constructor_TooManyTaskLocals_Terminates)
+{
+  auto allocate_all = []()
+  {
+    // Runs in a child process, the slots of this process are not taken.
+    for (size_t i = 0; i <= TaskContext::cMaxLocals; i++)
+    {
+      new TaskLocal<int>();
+    }
+  };
+
+  EXPECT_DEATH(allocate_all(), "Too many task locals");
+}
+} // namespace plex::tests
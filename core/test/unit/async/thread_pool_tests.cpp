@@ -5,6 +5,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 namespace plex::tests
 {
 TEST(ThreadPool_Tests, Constructor_CustomAmountThreads_CorrectCount)
@@ -77,4 +80,946 @@ TEST(ThreadPool_Tests, Schedule_16ThreadsMultipleTasks_Wait_CorrectExecution)
   EXPECT_EQ(count, amount);
 }
 
-} // namespace plex::tests
\ No newline at end of file
+TEST(ThreadPool_Tests, Constructor_WorkStealing_CorrectMode)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  EXPECT_EQ(pool.ThreadCount(), 4);
+  EXPECT_EQ(pool.Mode(), ThreadPoolMode::WorkStealing);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingOneThreadOneTask_Wait_CorrectExecution)
+{
+  ThreadPool pool(1, false, ThreadPoolMode::WorkStealing);
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    count++;
+  };
+
+  SyncWait(make_task());
+
+  EXPECT_EQ(count, 1);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealing16ThreadsMultipleTasks_Wait_CorrectExecution)
+{
+  ThreadPool pool(16, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 2000;
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    count++;
+  };
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task());
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, amount);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingFromWorkers_Wait_CorrectExecution)
+{
+  ThreadPool pool(8, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 1000; // More than a worker deque can hold, forces overflow into the injection queue.
+  constexpr size_t hops = 8;
+
+  std::atomic_int count = 0;
+
+  auto make_hopping_task = [&]() -> Task<>
+  {
+    for (size_t i = 0; i < hops; i++)
+    {
+      co_await pool.Schedule(); // After the first hop, scheduled from a worker thread.
+    }
+
+    count++;
+  };
+
+  auto make_spawner = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_hopping_task());
+    }
+
+    co_await WhenAll(std::move(tasks));
+  };
+
+  SyncWait(make_spawner());
+
+  EXPECT_EQ(count, amount);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingFromExternalThreads_Wait_CorrectExecution)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t producers_amount = 4;
+  constexpr size_t amount = 1000;
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule(); // Scheduled from a thread outside of the pool.
+    count++;
+  };
+
+  auto produce = [&]()
+  {
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+  };
+
+  std::vector<std::thread> producers;
+
+  for (size_t i = 0; i < producers_amount; i++)
+  {
+    producers.emplace_back(produce);
+  }
+
+  for (auto& producer : producers)
+  {
+    producer.join();
+  }
+
+  EXPECT_EQ(count, producers_amount * amount);
+}
+
+namespace
+{
+  void ScheduleMixedPriorities_SingleWorker_HigherPrioritiesFirst(ThreadPoolMode mode)
+  {
+    ThreadPool pool(1, false, mode);
+
+    constexpr size_t amount = 8; // Per priority
+
+    std::vector<SchedulePriority> order; // Only accessed by the single worker
+
+    auto make_task = [&](SchedulePriority priority) -> Task<>
+    {
+      co_await pool.Schedule(priority);
+      order.push_back(priority);
+    };
+
+    // Schedules everything from the worker, so that nothing executes before everything is scheduled.
+    auto make_root = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      std::vector<Task<>> tasks;
+
+      for (auto priority : { SchedulePriority::Low, SchedulePriority::Normal, SchedulePriority::High })
+      {
+        for (size_t i = 0; i < amount; i++)
+        {
+          tasks.push_back(make_task(priority));
+        }
+      }
+
+      co_await WhenAll(std::move(tasks));
+    };
+
+    SyncWait(make_root());
+
+    ASSERT_EQ(order.size(), 3 * amount);
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      if (i < amount) EXPECT_EQ(order[i], SchedulePriority::High);
+      else if (i < 2 * amount) EXPECT_EQ(order[i], SchedulePriority::Normal);
+      else
+      {
+        EXPECT_EQ(order[i], SchedulePriority::Low);
+      }
+    }
+  }
+
+  void ScheduleFloodOfHighPriority_SingleWorker_LowNotStarved(ThreadPoolMode mode)
+  {
+    ThreadPool pool(1, false, mode);
+
+    constexpr size_t amount = 1000;
+
+    size_t executed = 0; // Only accessed by the single worker
+    size_t low_position = 0;
+
+    auto make_task = [&](SchedulePriority priority) -> Task<>
+    {
+      co_await pool.Schedule(priority);
+
+      if (priority == SchedulePriority::Low) low_position = executed;
+
+      executed++;
+    };
+
+    auto make_root = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      std::vector<Task<>> tasks;
+
+      tasks.push_back(make_task(SchedulePriority::Low));
+
+      for (size_t i = 0; i < amount; i++)
+      {
+        tasks.push_back(make_task(SchedulePriority::High));
+      }
+
+      co_await WhenAll(std::move(tasks));
+    };
+
+    SyncWait(make_root());
+
+    EXPECT_EQ(executed, amount + 1);
+    EXPECT_LT(low_position, amount);
+  }
+} // namespace
+
+TEST(ThreadPool_Tests, Schedule_SharedMixedPriorities_HigherPrioritiesFirst)
+{
+  ScheduleMixedPriorities_SingleWorker_HigherPrioritiesFirst(ThreadPoolMode::Shared);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingMixedPriorities_HigherPrioritiesFirst)
+{
+  ScheduleMixedPriorities_SingleWorker_HigherPrioritiesFirst(ThreadPoolMode::WorkStealing);
+}
+
+TEST(ThreadPool_Tests, Schedule_SharedFloodOfHighPriority_LowNotStarved)
+{
+  ScheduleFloodOfHighPriority_SingleWorker_LowNotStarved(ThreadPoolMode::Shared);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingFloodOfHighPriority_LowNotStarved)
+{
+  ScheduleFloodOfHighPriority_SingleWorker_LowNotStarved(ThreadPoolMode::WorkStealing);
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingMixedPriorities16Threads_Wait_CorrectExecution)
+{
+  ThreadPool pool(16, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 3000;
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&](SchedulePriority priority) -> Task<>
+  {
+    co_await pool.Schedule(priority);
+    co_await pool.Schedule(priority); // From a worker
+    count++;
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task(static_cast<SchedulePriority>(i % 3)));
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, amount);
+}
+
+TEST(ThreadPool_Tests, Constructor_Shared_OneGroup)
+{
+  ThreadPool pool(4, true);
+
+  EXPECT_EQ(pool.GroupCount(), 1);
+}
+
+TEST(ThreadPool_Tests, Constructor_WorkStealingNotLocked_OneGroup)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  EXPECT_EQ(pool.GroupCount(), 1);
+}
+
+TEST(ThreadPool_Tests, Constructor_WorkStealingLocked_AtLeastOneGroup)
+{
+  ThreadPool pool(4, true, ThreadPoolMode::WorkStealing);
+
+  EXPECT_GE(pool.GroupCount(), 1);
+  EXPECT_LE(pool.GroupCount(), pool.ThreadCount());
+}
+
+TEST(ThreadPool_Tests, Schedule_WorkStealingLocalityHints_Wait_CorrectExecution)
+{
+  ThreadPool pool(8, true, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 2000;
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&](size_t key) -> Task<>
+  {
+    co_await pool.Schedule(LocalityHint { key }); // From outside of the pool
+    co_await pool.Schedule(LocalityHint { key + 1 }, SchedulePriority::High); // From a worker
+    co_await pool.Schedule(); // Without hint from a worker
+    count++;
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task(i % 7));
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, amount);
+}
+
+namespace
+{
+  void ScheduleBatch_Wait_CorrectExecution(ThreadPoolMode mode, bool from_worker)
+  {
+    ThreadPool pool(8, false, mode);
+
+    constexpr size_t amount = 2000; // More than fits in a worker deque
+
+    std::atomic_int count = 0;
+
+    ThreadPool::Batch batch;
+
+    auto make_task = [&](SchedulePriority priority) -> Task<>
+    {
+      co_await pool.Schedule(batch, priority);
+      count++;
+    };
+
+    auto submit = [&]() -> Task<>
+    {
+      EXPECT_EQ(batch.Size(), amount);
+
+      pool.Submit(batch);
+
+      EXPECT_TRUE(batch.Empty());
+
+      co_return;
+    };
+
+    auto make_root = [&]() -> Task<>
+    {
+      if (from_worker) co_await pool.Schedule();
+
+      std::vector<Task<>> tasks;
+      tasks.reserve(amount);
+
+      for (size_t i = 0; i < amount; i++)
+      {
+        tasks.push_back(make_task(static_cast<SchedulePriority>(i % 3)));
+      }
+
+      // Every task is added to the batch before it gets submitted.
+      co_await WhenAll(WhenAll(std::move(tasks)), submit());
+    };
+
+    SyncWait(make_root());
+
+    EXPECT_EQ(count, amount);
+  }
+} // namespace
+
+TEST(ThreadPool_Tests, Submit_EmptyBatch_DoesNothing)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  ThreadPool::Batch batch;
+
+  pool.Submit(batch);
+
+  EXPECT_TRUE(batch.Empty());
+  EXPECT_EQ(batch.Size(), 0);
+}
+
+TEST(ThreadPool_Tests, Submit_SharedBatch_Wait_CorrectExecution)
+{
+  ScheduleBatch_Wait_CorrectExecution(ThreadPoolMode::Shared, false);
+}
+
+TEST(ThreadPool_Tests, Submit_WorkStealingBatchFromExternalThread_Wait_CorrectExecution)
+{
+  ScheduleBatch_Wait_CorrectExecution(ThreadPoolMode::WorkStealing, false);
+}
+
+TEST(ThreadPool_Tests, Submit_WorkStealingBatchFromWorker_Wait_CorrectExecution)
+{
+  ScheduleBatch_Wait_CorrectExecution(ThreadPoolMode::WorkStealing, true);
+}
+
+TEST(ThreadPool_Tests, SleepFor_Short_ResumesOnWorkerAfterDuration)
+{
+  using namespace std::chrono_literals;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(2, false, mode);
+
+    std::thread::id resumed_on;
+
+    const auto start = ThreadPool::Clock::now();
+
+    auto task = [&]() -> Task<ThreadPool::Clock::duration>
+    {
+      co_await pool.SleepFor(5ms);
+      resumed_on = std::this_thread::get_id();
+      co_return ThreadPool::Clock::now() - start;
+    };
+
+    EXPECT_GE(SyncWait(task()), 5ms);
+    EXPECT_NE(resumed_on, std::this_thread::get_id());
+  }
+}
+
+TEST(ThreadPool_Tests, SleepUntil_Past_ResumesOnWorker)
+{
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  std::thread::id resumed_on;
+
+  auto task = [&]() -> Task<>
+  {
+    co_await pool.SleepUntil(ThreadPool::Clock::now() - std::chrono::seconds(1));
+    resumed_on = std::this_thread::get_id();
+  };
+
+  SyncWait(task());
+
+  EXPECT_NE(resumed_on, std::this_thread::get_id());
+}
+
+TEST(ThreadPool_Tests, SleepFor_DifferentDurations_ExpireInDeadlineOrder)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(1, false, ThreadPoolMode::WorkStealing);
+
+  std::vector<size_t> order; // Only accessed by the single worker
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    co_await pool.SleepFor(std::chrono::milliseconds(10 * (4 - index)));
+    order.push_back(index);
+  };
+
+  SyncWait(WhenAll(make_task(0), make_task(1), make_task(2), make_task(3)));
+
+  EXPECT_EQ(order, (std::vector<size_t> { 3, 2, 1, 0 }));
+}
+
+TEST(ThreadPool_Tests, SleepFor_ManyConcurrentTimers_AllResume)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 5000;
+
+  std::atomic_int count = 0;
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    co_await pool.Schedule(); // Timers are added concurrently from the workers
+    co_await pool.SleepFor(std::chrono::microseconds(index % 2000));
+    count++;
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task(i));
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, amount);
+}
+
+TEST(ThreadPool_Tests, SleepFor_CancelledWhileWaiting_ResumesEarly)
+{
+  using namespace std::chrono_literals;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(2, false, mode);
+
+    CancellationSource source;
+
+    const auto start = ThreadPool::Clock::now();
+
+    auto sleeper = [&]() -> Task<bool> { co_return co_await pool.SleepFor(10s, source.Token()); };
+
+    auto canceller = [&]() -> Task<>
+    {
+      co_await pool.SleepFor(5ms);
+      source.Cancel();
+    };
+
+    auto [expired, ignored] = SyncWait(CollectAll(sleeper(), canceller()));
+
+    EXPECT_FALSE(expired);
+    EXPECT_LT(ThreadPool::Clock::now() - start, 5s);
+  }
+}
+
+TEST(ThreadPool_Tests, SleepFor_AlreadyCancelled_ReturnsFalse)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  CancellationSource source;
+  source.Cancel();
+
+  auto task = [&]() -> Task<bool> { co_return co_await pool.SleepFor(10s, source.Token()); };
+
+  EXPECT_FALSE(SyncWait(task()));
+}
+
+TEST(ThreadPool_Tests, SleepFor_NotCancelled_ReturnsTrue)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  CancellationSource source;
+
+  auto task = [&]() -> Task<bool> { co_return co_await pool.SleepFor(1ms, source.Token()); };
+
+  EXPECT_TRUE(SyncWait(task()));
+}
+
+TEST(ThreadPool_Tests, SleepFor_ManyCancelledConcurrently_AllResume)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 1000;
+
+  CancellationSource source;
+
+  std::atomic_int cancelled = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    if (!co_await pool.SleepFor(10s, source.Token())) cancelled++;
+  };
+
+  auto canceller = [&]() -> Task<>
+  {
+    co_await pool.SleepFor(1ms);
+    source.Cancel();
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount + 1);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task());
+  }
+
+  tasks.push_back(canceller());
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(cancelled, amount);
+}
+
+TEST(ThreadPool_Tests, Stats_AfterWork_OnePerWorkerAndCounted)
+{
+  constexpr size_t amount = 1000;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    auto make_task = [&]() -> Task<> { co_await pool.Schedule(); };
+
+    std::vector<Task<>> tasks;
+    tasks.reserve(amount);
+
+    for (size_t i = 0; i < amount; i++)
+    {
+      tasks.push_back(make_task());
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    const auto stats = pool.Stats();
+
+    ASSERT_EQ(stats.size(), pool.ThreadCount());
+
+    uint64_t executed = 0;
+
+    for (const auto& worker : stats)
+    {
+      executed += worker.executed;
+    }
+
+    if constexpr (ThreadPool::cStatsEnabled) EXPECT_GE(executed, amount);
+    else
+    {
+      EXPECT_EQ(executed, 0);
+    }
+  }
+}
+
+namespace
+{
+  void ScheduleOn_EveryWorker_AlwaysSameThread(ThreadPoolMode mode)
+  {
+    ThreadPool pool(4, false, mode);
+
+    constexpr size_t amount = 64; // Per worker
+    constexpr size_t hops = 8;
+
+    std::atomic_size_t mismatches = 0;
+    std::atomic_size_t count = 0;
+
+    auto make_task = [&](size_t worker_index) -> Task<>
+    {
+      co_await pool.ScheduleOn(worker_index);
+
+      const std::thread::id thread_id = std::this_thread::get_id();
+
+      for (size_t i = 0; i < hops; i++)
+      {
+        co_await pool.Schedule(); // Can end up on any worker
+
+        co_await pool.ScheduleOn(worker_index);
+
+        if (std::this_thread::get_id() != thread_id) mismatches++;
+      }
+
+      count++;
+    };
+
+    std::vector<Task<>> tasks;
+
+    for (size_t i = 0; i < amount * pool.ThreadCount(); i++)
+    {
+      tasks.push_back(make_task(i % pool.ThreadCount()));
+    }
+
+    SyncWait(WhenAll(std::move(tasks)));
+
+    EXPECT_EQ(count, amount * pool.ThreadCount());
+    EXPECT_EQ(mismatches, 0);
+  }
+} // namespace
+
+TEST(ThreadPool_Tests, ScheduleOn_ParkedWorkers_OnlyTargetWokenUp)
+{
+  using namespace std::chrono_literals;
+
+  constexpr size_t target = 1;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(4, false, mode);
+
+    // Lets every worker run out of spinning and park.
+    std::this_thread::sleep_for(50ms);
+
+    const auto before = pool.Stats();
+
+    std::thread::id target_thread_id;
+    size_t mismatches = 0;
+
+    auto make_task = [&]() -> Task<>
+    {
+      co_await pool.ScheduleOn(target);
+
+      if (target_thread_id == std::thread::id {}) target_thread_id = std::this_thread::get_id();
+      else if (std::this_thread::get_id() != target_thread_id) mismatches++;
+    };
+
+    for (size_t i = 0; i < 8; i++)
+    {
+      SyncWait(make_task());
+    }
+
+    const auto after = pool.Stats();
+
+    EXPECT_EQ(mismatches, 0);
+
+    for (size_t i = 0; i != pool.ThreadCount(); i++)
+    {
+      if constexpr (ThreadPool::cStatsEnabled)
+      {
+        if (i == target) EXPECT_GT(after[i].wake_ups, before[i].wake_ups);
+        else
+        {
+          EXPECT_EQ(after[i].wake_ups, before[i].wake_ups);
+        }
+      }
+      else
+      {
+        EXPECT_EQ(after[i].wake_ups, 0);
+      }
+    }
+  }
+}
+
+TEST(ThreadPool_Tests, ScheduleOn_SharedEveryWorker_AlwaysSameThread)
+{
+  ScheduleOn_EveryWorker_AlwaysSameThread(ThreadPoolMode::Shared);
+}
+
+TEST(ThreadPool_Tests, ScheduleOn_WorkStealingEveryWorker_AlwaysSameThread)
+{
+  ScheduleOn_EveryWorker_AlwaysSameThread(ThreadPoolMode::WorkStealing);
+}
+
+namespace
+{
+  void SyncWaitHelping_BlockingTask_WaitingThreadExecutes(ThreadPoolMode mode)
+  {
+    ThreadPool pool(1, false, mode);
+
+    const std::thread::id waiting_thread_id = std::this_thread::get_id();
+
+    std::atomic_bool released = false;
+    std::thread::id blocker_thread_id;
+    std::thread::id releaser_thread_id;
+
+    // Keeps the thread executing it busy until released, the releaser can only be executed by the other thread.
+    auto make_blocker = [&]() -> Task<>
+    {
+      co_await pool.Schedule();
+
+      blocker_thread_id = std::this_thread::get_id();
+
+      while (!released.load(std::memory_order_acquire))
+      {
+        std::this_thread::yield();
+      }
+    };
+
+    auto make_releaser = [&]() -> Task<int>
+    {
+      co_await pool.Schedule();
+
+      releaser_thread_id = std::this_thread::get_id();
+      released.store(true, std::memory_order_release);
+
+      co_return 10;
+    };
+
+    auto result = SyncWait(pool, CollectAll(make_blocker(), make_releaser()));
+
+    EXPECT_EQ(std::get<1>(result), 10);
+    EXPECT_NE(blocker_thread_id, releaser_thread_id);
+    EXPECT_TRUE(blocker_thread_id == waiting_thread_id || releaser_thread_id == waiting_thread_id);
+  }
+} // namespace
+
+TEST(ThreadPool_Tests, SyncWaitHelping_SharedBlockingTask_WaitingThreadExecutes)
+{
+  SyncWaitHelping_BlockingTask_WaitingThreadExecutes(ThreadPoolMode::Shared);
+}
+
+TEST(ThreadPool_Tests, SyncWaitHelping_WorkStealingBlockingTask_WaitingThreadExecutes)
+{
+  SyncWaitHelping_BlockingTask_WaitingThreadExecutes(ThreadPoolMode::WorkStealing);
+}
+
+TEST(ThreadPool_Tests, SyncWaitHelping_WorkStealingManyTasks_Wait_CorrectExecution)
+{
+  ThreadPool pool(4, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 10000;
+
+  std::atomic_size_t count = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    count++;
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task());
+  }
+
+  SyncWait(pool, WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, amount);
+}
+
+namespace
+{
+  void SyncWaitHelping_WorkArrivesWhileParked_WaitingThreadWokenUp(ThreadPoolMode mode)
+  {
+    using namespace std::chrono_literals;
+
+    ThreadPool pool(1, false, mode);
+
+    const std::thread::id waiting_thread_id = std::this_thread::get_id();
+
+    std::atomic_bool released = false;
+    std::thread::id releaser_thread_id;
+
+    // Keeps the only worker busy, the releaser can only be executed by the waiting thread.
+    auto make_blocker = [&]() -> Task<>
+    {
+      co_await pool.ScheduleOn(0);
+
+      while (!released.load(std::memory_order_acquire))
+      {
+        std::this_thread::yield();
+      }
+    };
+
+    // Resumed by the timer thread long after the waiting thread parked.
+    auto make_releaser = [&]() -> Task<>
+    {
+      co_await pool.SleepFor(20ms);
+
+      releaser_thread_id = std::this_thread::get_id();
+      released.store(true, std::memory_order_release);
+    };
+
+    SyncWait(pool, CollectAll(make_blocker(), make_releaser()));
+
+    EXPECT_EQ(releaser_thread_id, waiting_thread_id);
+  }
+} // namespace
+
+TEST(ThreadPool_Tests, SyncWaitHelping_SharedWorkArrivesWhileParked_WaitingThreadWokenUp)
+{
+  SyncWaitHelping_WorkArrivesWhileParked_WaitingThreadWokenUp(ThreadPoolMode::Shared);
+}
+
+TEST(ThreadPool_Tests, SyncWaitHelping_WorkStealingWorkArrivesWhileParked_WaitingThreadWokenUp)
+{
+  SyncWaitHelping_WorkArrivesWhileParked_WaitingThreadWokenUp(ThreadPoolMode::WorkStealing);
+}
+
+TEST(ThreadPool_Tests, SyncWaitHelping_WorkStealingWorkerBusy_WaitingThreadExecutesInScheduleOrder)
+{
+  ThreadPool pool(1, false, ThreadPoolMode::WorkStealing);
+
+  constexpr size_t amount = 1000;
+
+  std::atomic_bool started = false;
+  std::atomic_bool released = false;
+
+  std::vector<size_t> order;
+
+  // Keeps the only worker busy so that the waiting thread executes everything else.
+  auto make_blocker = [&]() -> Task<>
+  {
+    co_await pool.ScheduleOn(0);
+
+    started.store(true, std::memory_order_release);
+
+    while (!released.load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+  };
+
+  auto make_task = [&](size_t index) -> Task<>
+  {
+    while (!started.load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+
+    co_await pool.Schedule();
+
+    order.push_back(index);
+
+    if (order.size() == amount) released.store(true, std::memory_order_release);
+  };
+
+  std::vector<Task<>> tasks;
+  tasks.reserve(amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    tasks.push_back(make_task(i));
+  }
+
+  SyncWait(pool, CollectAll(make_blocker(), WhenAll(std::move(tasks))));
+
+  ASSERT_EQ(order.size(), amount);
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(ThreadPool_Tests, SetWorkerPriority_IdleWorker_StillExecutes)
+{
+  ThreadPool pool(2, false);
+
+  EXPECT_TRUE(pool.SetWorkerPriority(0, ThreadSchedulerPolicy::Idle, 0));
+
+  // Realtime needs privileges, it only has to not disturb the pool when they are missing.
+  pool.SetWorkerPriority(1, ThreadSchedulerPolicy::Realtime, static_cast<int>(MinRealtimePriority));
+
+  std::atomic_size_t count = 0;
+
+  auto make_task = [&]() -> Task<>
+  {
+    co_await pool.Schedule();
+    count++;
+  };
+
+  std::vector<Task<>> tasks;
+
+  for (size_t i = 0; i < 100; i++)
+  {
+    tasks.push_back(make_task());
+  }
+
+  SyncWait(WhenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, 100);
+}
+
+} // namespace plex::tests
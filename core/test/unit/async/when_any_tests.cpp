@@ -0,0 +1,93 @@
+#include "plex/async/when_any.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "plex/async/sync_wait.h"
+#include "plex/async/task.h"
+#include "plex/async/thread_pool.h"
+
+namespace plex::tests
+{
+TEST(WhenAny_Tests, WhenAny_Single_Result)
+{
+  auto task = []() -> Task<int> { co_return 42; };
+
+  auto result = SyncWait(WhenAny(CancellationSource {}, task()));
+
+  ASSERT_EQ(result.index(), 0);
+  EXPECT_EQ(std::get<0>(result), 42);
+}
+
+TEST(WhenAny_Tests, WhenAny_FirstSynchronous_FirstWinsOthersCancelled)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  CancellationSource source;
+
+  auto fast = []() -> Task<int> { co_return 1; };
+
+  auto slow = [&]() -> Task<bool> { co_return co_await pool.SleepFor(10s, source.Token()); };
+
+  const auto start = ThreadPool::Clock::now();
+
+  auto result = SyncWait(WhenAny(source, fast(), slow()));
+
+  ASSERT_EQ(result.index(), 0);
+  EXPECT_EQ(std::get<0>(result), 1);
+  EXPECT_TRUE(source.IsCancellationRequested());
+  EXPECT_LT(ThreadPool::Clock::now() - start, 5s);
+}
+
+TEST(WhenAny_Tests, WhenAny_DeadlineBeforeWork_WorkAbandoned)
+{
+  using namespace std::chrono_literals;
+
+  for (auto mode : { ThreadPoolMode::Shared, ThreadPoolMode::WorkStealing })
+  {
+    ThreadPool pool(2, false, mode);
+
+    CancellationSource source;
+    CancellationToken token = source.Token();
+
+    std::atomic_size_t iterations = 0;
+
+    auto work = [&]() -> Task<size_t>
+    {
+      co_await pool.Schedule();
+
+      while (!token.IsCancellationRequested())
+      {
+        iterations++;
+
+        co_await pool.Schedule(); // Lets other work run between steps
+      }
+
+      co_return iterations.load();
+    };
+
+    auto result = SyncWait(WhenAny(source, work(), pool.SleepFor(5ms, token)));
+
+    ASSERT_EQ(result.index(), 1);
+  }
+}
+
+TEST(WhenAny_Tests, WhenAny_VoidResults_IndexOfFirst)
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool(2, false, ThreadPoolMode::WorkStealing);
+
+  CancellationSource source;
+
+  auto late = [&]() -> Task<> { co_await pool.SleepFor(10s, source.Token()); };
+  auto early = [&]() -> Task<> { co_await pool.SleepFor(1ms, source.Token()); };
+
+  auto result = SyncWait(WhenAny(source, late(), early()));
+
+  EXPECT_EQ(result.index(), 1);
+}
+} // namespace plex::tests
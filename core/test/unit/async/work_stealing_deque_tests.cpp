@@ -0,0 +1,155 @@
+#include "plex/async/work_stealing_deque.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace plex::tests
+{
+TEST(WorkStealingDeque_Tests, Constructor_Default_Empty)
+{
+  WorkStealingDeque<int, 8> deque;
+
+  EXPECT_TRUE(deque.EmptyApprox());
+  EXPECT_EQ(deque.SizeApprox(), 0);
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDeque_Tests, Push_Single_NotEmpty)
+{
+  WorkStealingDeque<int, 8> deque;
+
+  int value = 0;
+
+  EXPECT_TRUE(deque.Push(&value));
+
+  EXPECT_FALSE(deque.EmptyApprox());
+  EXPECT_EQ(deque.SizeApprox(), 1);
+}
+
+TEST(WorkStealingDeque_Tests, Pop_Multiple_LastInFirstOut)
+{
+  WorkStealingDeque<int, 8> deque;
+
+  int values[3] {};
+
+  deque.Push(&values[0]);
+  deque.Push(&values[1]);
+  deque.Push(&values[2]);
+
+  EXPECT_EQ(deque.Pop(), &values[2]);
+  EXPECT_EQ(deque.Pop(), &values[1]);
+  EXPECT_EQ(deque.Pop(), &values[0]);
+  EXPECT_EQ(deque.Pop(), nullptr);
+}
+
+TEST(WorkStealingDeque_Tests, Steal_Multiple_FirstInFirstOut)
+{
+  WorkStealingDeque<int, 8> deque;
+
+  int values[3] {};
+
+  deque.Push(&values[0]);
+  deque.Push(&values[1]);
+  deque.Push(&values[2]);
+
+  EXPECT_EQ(deque.Steal(), &values[0]);
+  EXPECT_EQ(deque.Steal(), &values[1]);
+  EXPECT_EQ(deque.Steal(), &values[2]);
+  EXPECT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDeque_Tests, Push_Full_Fails)
+{
+  WorkStealingDeque<int, 4> deque;
+
+  int values[5] {};
+
+  for (size_t i = 0; i < 4; i++)
+  {
+    EXPECT_TRUE(deque.Push(&values[i]));
+  }
+
+  EXPECT_FALSE(deque.Push(&values[4]));
+  EXPECT_EQ(deque.SizeApprox(), 4);
+}
+
+TEST(WorkStealingDeque_Tests, Push_WrapAround_CorrectOrder)
+{
+  WorkStealingDeque<int, 4> deque;
+
+  int values[16] {};
+
+  for (size_t i = 0; i < 16; i++)
+  {
+    EXPECT_TRUE(deque.Push(&values[i]));
+    EXPECT_EQ(deque.Steal(), &values[i]);
+  }
+
+  EXPECT_TRUE(deque.EmptyApprox());
+}
+
+TEST(WorkStealingDeque_Tests, Steal_ConcurrentThieves_EveryElementTakenOnce)
+{
+  constexpr size_t amount = 100000;
+  constexpr size_t thieves_amount = 4;
+
+  WorkStealingDeque<size_t, 1024> deque;
+
+  std::vector<size_t> values(amount);
+  std::vector<std::atomic_size_t> taken(amount);
+
+  std::atomic_bool done = false;
+
+  auto take = [&](size_t* item)
+  {
+    taken[static_cast<size_t>(item - values.data())].fetch_add(1, std::memory_order_relaxed);
+  };
+
+  std::vector<std::thread> thieves;
+
+  for (size_t i = 0; i < thieves_amount; i++)
+  {
+    thieves.emplace_back(
+      [&]()
+      {
+        while (!done.load(std::memory_order_acquire) || !deque.EmptyApprox())
+        {
+          if (size_t* item = deque.Steal()) take(item);
+        }
+      });
+  }
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    while (!deque.Push(&values[i]))
+    {
+      if (size_t* item = deque.Pop()) take(item);
+    }
+
+    if (i % 3 == 0)
+    {
+      if (size_t* item = deque.Pop()) take(item);
+    }
+  }
+
+  while (size_t* item = deque.Pop())
+  {
+    take(item);
+  }
+
+  done.store(true, std::memory_order_release);
+
+  for (auto& thief : thieves)
+  {
+    thief.join();
+  }
+
+  for (size_t i = 0; i < amount; i++)
+  {
+    EXPECT_EQ(taken[i].load(), 1);
+  }
+}
+} // namespace plex::tests
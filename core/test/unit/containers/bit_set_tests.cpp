@@ -0,0 +1,90 @@
+#include "plex/containers/bit_set.h"
+
+#include <gtest/gtest.h>
+
+namespace plex::tests
+{
+TEST(BitSet_Tests, DefaultConstructor_NoBits)
+{
+  BitSet set;
+
+  EXPECT_TRUE(set.None());
+  EXPECT_EQ(set.Count(), 0);
+  EXPECT_FALSE(set.Test(0));
+  EXPECT_FALSE(set.Test(1000));
+}
+
+TEST(BitSet_Tests, Set_PastSize_Grows)
+{
+  BitSet set;
+
+  set.Set(3);
+  set.Set(200);
+
+  EXPECT_TRUE(set.Test(3));
+  EXPECT_TRUE(set.Test(200));
+  EXPECT_FALSE(set.Test(4));
+  EXPECT_FALSE(set.Test(199));
+  EXPECT_GE(set.Size(), 201);
+  EXPECT_EQ(set.Count(), 2);
+}
+
+TEST(BitSet_Tests, Reset_SetBit_Zero)
+{
+  BitSet set;
+
+  set.Set(70);
+  set.Reset(70);
+  set.Reset(5000); // Past size
+
+  EXPECT_FALSE(set.Test(70));
+  EXPECT_TRUE(set.None());
+}
+
+TEST(BitSet_Tests, Intersects_DifferentSizes_CorrectResult)
+{
+  BitSet small;
+  BitSet large;
+
+  small.Set(1);
+  large.Set(2);
+  large.Set(300);
+
+  EXPECT_FALSE(small.Intersects(large));
+  EXPECT_FALSE(large.Intersects(small));
+
+  small.Set(2);
+
+  EXPECT_TRUE(small.Intersects(large));
+  EXPECT_TRUE(large.Intersects(small));
+}
+
+TEST(BitSet_Tests, OrAssign_LargerSet_Union)
+{
+  BitSet set;
+  BitSet other(256);
+
+  set.Set(1);
+  other.Set(255);
+
+  set |= other;
+
+  EXPECT_TRUE(set.Test(1));
+  EXPECT_TRUE(set.Test(255));
+  EXPECT_EQ(set.Count(), 2);
+}
+
+TEST(BitSet_Tests, Clear_ManyBits_None)
+{
+  BitSet set;
+
+  for (size_t i = 0; i < 500; i += 3)
+  {
+    set.Set(i);
+  }
+
+  set.Clear();
+
+  EXPECT_TRUE(set.None());
+}
+} // namespace plex::tests
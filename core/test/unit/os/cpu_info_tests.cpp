@@ -18,4 +18,60 @@ TEST(Threading_Tests, GetCPUInfo_NormalExecution_HasCaches)
 
   EXPECT_GT(info.caches.size(), 0);
 }
-} // namespace plex::tests
\ No newline at end of file
+
+TEST(Threading_Tests, GetCPUInfo_NormalExecution_HasNumaNodes)
+{
+  auto info = GetCPUInfo();
+
+  EXPECT_GT(info.numa_nodes.size(), 0);
+}
+
+TEST(Threading_Tests, GetCPUInfo_NormalExecution_ProcessorsDisjoint)
+{
+  auto info = GetCPUInfo();
+
+  uint64_t seen = 0;
+
+  for (const auto& processor : info.processors)
+  {
+    EXPECT_NE(processor.mask, 0);
+    EXPECT_EQ(seen & processor.mask, 0);
+
+    seen |= processor.mask;
+  }
+}
+
+TEST(Threading_Tests, GetCPUInfo_NormalExecution_ProcessorsInNumaNodes)
+{
+  auto info = GetCPUInfo();
+
+  for (const auto& processor : info.processors)
+  {
+    bool found = false;
+
+    for (const auto& node : info.numa_nodes)
+    {
+      if (node.id == processor.numa_node) found = (node.mask & processor.mask) != 0;
+    }
+
+    EXPECT_TRUE(found);
+  }
+}
+
+TEST(Threading_Tests, GetCPUInfo_NormalExecution_ValidCaches)
+{
+  auto info = GetCPUInfo();
+
+  for (const auto& cache : info.caches)
+  {
+    EXPECT_GT(cache.level, 0);
+    EXPECT_GT(cache.size, 0);
+    EXPECT_NE(cache.mask, 0);
+  }
+}
+
+TEST(Threading_Tests, GetCacheSize_FirstLevel_NotZero)
+{
+  EXPECT_GT(GetCacheSize(1), 0);
+}
+} // namespace plex::tests
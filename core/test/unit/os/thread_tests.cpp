@@ -0,0 +1,103 @@
+#include "plex/os/thread.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "plex/config/compiler.h"
+
+#if PLATFORM_LINUX
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace plex::tests
+{
+namespace
+{
+  ///
+  /// Thread that stays alive until destroyed, so that its priority can be changed. Sleeps so that it does not starve
+  /// other threads when given a realtime priority.
+  ///
+  class SleepingThread
+  {
+  public:
+    SleepingThread()
+      : done_(false), thread_(
+                        [this]
+                        {
+                          while (!done_.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        })
+    {}
+
+    ~SleepingThread()
+    {
+      done_ = true;
+      thread_.join();
+    }
+
+    std::thread::native_handle_type NativeHandle()
+    {
+      return thread_.native_handle();
+    }
+
+  private:
+    std::atomic_bool done_;
+    std::thread thread_;
+  };
+} // namespace
+
+TEST(Threading_Tests, SetThreadPriority_Normal_Success)
+{
+  SleepingThread thread;
+
+  EXPECT_TRUE(SetThreadPriority(thread.NativeHandle(), ThreadSchedulerPolicy::Normal, 0));
+}
+
+TEST(Threading_Tests, SetThreadPriority_Idle_Success)
+{
+  SleepingThread thread;
+
+  EXPECT_TRUE(SetThreadPriority(thread.NativeHandle(), ThreadSchedulerPolicy::Idle, 0));
+}
+
+TEST(Threading_Tests, SetThreadPriority_Realtime_SuccessOrNoPrivileges)
+{
+  SleepingThread thread;
+
+  for (auto policy : { ThreadSchedulerPolicy::Realtime, ThreadSchedulerPolicy::RealtimeFifo })
+  {
+    const bool success =
+      SetThreadPriority(thread.NativeHandle(), policy, static_cast<int>(MaxRealtimePriority));
+
+#if PLATFORM_LINUX
+    int native_policy;
+    sched_param param {};
+
+    ASSERT_EQ(pthread_getschedparam(thread.NativeHandle(), &native_policy, &param), 0);
+
+    if (success)
+    {
+      EXPECT_EQ(native_policy, policy == ThreadSchedulerPolicy::Realtime ? SCHED_RR : SCHED_FIFO);
+      EXPECT_EQ(param.sched_priority, sched_get_priority_max(native_policy));
+    }
+    else
+    {
+      // Only allowed to fail without privileges, in which case nothing changed.
+      sched_param realtime_param {};
+      realtime_param.sched_priority = sched_get_priority_min(SCHED_RR);
+
+      EXPECT_EQ(pthread_setschedparam(thread.NativeHandle(), SCHED_RR, &realtime_param), EPERM);
+      EXPECT_EQ(native_policy, SCHED_OTHER);
+    }
+#else
+    EXPECT_TRUE(success);
+#endif
+
+    EXPECT_TRUE(SetThreadPriority(thread.NativeHandle(), ThreadSchedulerPolicy::Normal, 0));
+  }
+}
+} // namespace plex::tests
@@ -348,4 +348,63 @@ TEST(Scheduler_Algorithm_Tests, ComputeSchedulerData_Complex8s_RunsAfterDependen
   EXPECT_TRUE(RunsAfter(steps, system3, system8));
 }
 
-} // namespace plex::tests
\ No newline at end of file
+TEST(Scheduler_Algorithm_Tests, ComputeSchedulerData_ChainSameData_TransitivelyReduced)
+{
+  auto system1 = SystemMock<1, MockQuery<MockData<0>>>;
+  auto system2 = SystemMock<2, MockQuery<MockData<0>>>;
+  auto system3 = SystemMock<3, MockQuery<MockData<0>>>;
+  auto system4 = SystemMock<4, MockQuery<MockData<0>>>;
+
+  Stage stage1;
+  stage1.AddSystem(system1);
+
+  Stage stage2;
+  stage2.AddSystem(system2);
+
+  Stage stage3;
+  stage3.AddSystem(system3);
+
+  Stage stage4;
+  stage4.AddSystem(system4);
+
+  Vector<Stage*> stages { { &stage1, &stage2, &stage3, &stage4 } };
+
+  auto steps = ComputeSchedulerData(stages);
+
+  ASSERT_EQ(steps.size(), 4);
+
+  // Every system depends on all the previous ones, but only the direct predecessor is needed.
+  EXPECT_EQ(steps[0].dependencies.size(), 0);
+
+  for (size_t i = 1; i < steps.size(); i++)
+  {
+    ASSERT_EQ(steps[i].dependencies.size(), 1);
+    EXPECT_EQ(steps[i].dependencies[0], i - 1);
+  }
+
+  EXPECT_TRUE(RunsAfter(steps, system1, system4));
+}
+
+TEST(Scheduler_Algorithm_Tests, ComputeSchedulerData_ExplicitOrderLaterSystem_InSequence)
+{
+  auto system1 = SystemMock<1, MockQuery<MockData<0>>>;
+  auto system2 = SystemMock<2, MockQuery<MockData<0>>>;
+
+  Stage stage1;
+
+  stage1.AddSystem(system1).After(system2);
+  stage1.AddSystem(system2);
+
+  Vector<Stage*> stages { { &stage1 } };
+
+  auto steps = ComputeSchedulerData(stages);
+
+  EXPECT_EQ(steps.size(), 2);
+
+  EXPECT_FALSE(HasCircularDependency(steps));
+
+  EXPECT_TRUE(RunsAfter(steps, system2, system1));
+  EXPECT_FALSE(RunsAfter(steps, system1, system2));
+}
+
+} // namespace plex::tests
@@ -0,0 +1,186 @@
+#include "plex/scheduler/scheduler_profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+namespace plex::tests
+{
+namespace
+{
+  using namespace std::chrono_literals;
+
+  void SystemMock1() {}
+
+  void SystemMock2() {}
+
+  SystemHandle Handle(void (*system)())
+  {
+    return std::bit_cast<SystemHandle>(system);
+  }
+} // namespace
+
+TEST(SchedulerProfiler_Tests, Samples_NothingRecorded_Empty)
+{
+  SchedulerProfiler profiler;
+
+  EXPECT_TRUE(profiler.Samples().empty());
+  EXPECT_TRUE(profiler.Summary().empty());
+}
+
+TEST(SchedulerProfiler_Tests, Record_SingleSystem_SampleRecorded)
+{
+  SchedulerProfiler profiler;
+
+  const auto run_start = SchedulerProfiler::Clock::now();
+
+  profiler.BeginRun(run_start);
+  profiler.Record(Handle(SystemMock1), run_start + 10us, run_start + 30us);
+
+  const auto samples = profiler.Samples();
+
+  ASSERT_EQ(samples.size(), 1);
+  EXPECT_EQ(samples[0].system, Handle(SystemMock1));
+  EXPECT_EQ(samples[0].run, 1);
+  EXPECT_EQ(samples[0].thread, 0);
+  EXPECT_EQ(samples[0].start, run_start + 10us);
+  EXPECT_EQ(samples[0].end, run_start + 30us);
+  EXPECT_EQ(samples[0].dependency_wait, 10us);
+}
+
+TEST(SchedulerProfiler_Tests, Record_MultipleThreads_SamplesOrderedByStart)
+{
+  SchedulerProfiler profiler;
+
+  const auto run_start = SchedulerProfiler::Clock::now();
+
+  profiler.BeginRun(run_start);
+
+  std::thread thread([&]() { profiler.Record(Handle(SystemMock2), run_start, run_start + 5us); });
+  thread.join();
+
+  profiler.Record(Handle(SystemMock1), run_start + 10us, run_start + 20us);
+
+  const auto samples = profiler.Samples();
+
+  ASSERT_EQ(samples.size(), 2);
+  EXPECT_EQ(samples[0].system, Handle(SystemMock2));
+  EXPECT_EQ(samples[1].system, Handle(SystemMock1));
+  EXPECT_NE(samples[0].thread, samples[1].thread);
+}
+
+TEST(SchedulerProfiler_Tests, Record_ManyProfilersDestroyed_OnlyOwnSamples)
+{
+  const auto run_start = SchedulerProfiler::Clock::now();
+
+  SchedulerProfiler kept;
+
+  kept.BeginRun(run_start);
+  kept.Record(Handle(SystemMock1), run_start, run_start + 5us);
+
+  // The thread records into every profiler in turn, dropping the buffers of the destroyed ones.
+  for (size_t i = 0; i < 100; i++)
+  {
+    auto profiler = std::make_unique<SchedulerProfiler>();
+
+    profiler->BeginRun(run_start);
+    profiler->Record(Handle(SystemMock2), run_start, run_start + 10us);
+
+    const auto samples = profiler->Samples();
+
+    ASSERT_EQ(samples.size(), 1);
+    EXPECT_EQ(samples[0].system, Handle(SystemMock2));
+    EXPECT_EQ(samples[0].thread, 0);
+  }
+
+  kept.Record(Handle(SystemMock1), run_start + 10us, run_start + 15us);
+
+  const auto samples = kept.Samples();
+
+  ASSERT_EQ(samples.size(), 2);
+  EXPECT_EQ(samples[0].thread, samples[1].thread);
+}
+
+TEST(SchedulerProfiler_Tests, Summary_ManyRuns_Percentiles)
+{
+  SchedulerProfiler profiler;
+
+  const auto start = SchedulerProfiler::Clock::now();
+
+  for (size_t i = 1; i <= 100; i++)
+  {
+    profiler.BeginRun(start);
+    profiler.Record(Handle(SystemMock1),
+      start + std::chrono::microseconds(i),
+      start + std::chrono::microseconds(2 * i));
+    profiler.Record(Handle(SystemMock2), start, start + 1us);
+  }
+
+  const auto summary = profiler.Summary();
+
+  ASSERT_EQ(summary.size(), 2);
+
+  // Slowest first
+  EXPECT_EQ(summary[0].system, Handle(SystemMock1));
+  EXPECT_EQ(summary[0].executions, 100);
+  EXPECT_EQ(summary[0].mean, 50500ns);
+  EXPECT_EQ(summary[0].p50, 50us);
+  EXPECT_EQ(summary[0].p99, 99us);
+  EXPECT_EQ(summary[0].max, 100us);
+  EXPECT_EQ(summary[0].dependency_wait_p50, 50us);
+  EXPECT_EQ(summary[0].dependency_wait_p99, 99us);
+
+  EXPECT_EQ(summary[1].system, Handle(SystemMock2));
+  EXPECT_EQ(summary[1].executions, 100);
+  EXPECT_EQ(summary[1].p50, 1us);
+  EXPECT_EQ(summary[1].dependency_wait_p99, 0us);
+}
+
+TEST(SchedulerProfiler_Tests, WriteChromeTrace_Samples_EventPerSample)
+{
+  SchedulerProfiler profiler;
+
+  const auto start = SchedulerProfiler::Clock::now();
+
+  profiler.BeginRun(start);
+  profiler.Record(Handle(SystemMock1), start, start + 1500ns);
+  profiler.Record(Handle(SystemMock2), start + 2us, start + 3us);
+
+  std::ostringstream stream;
+  profiler.WriteChromeTrace(stream);
+
+  const std::string trace = stream.str();
+
+  EXPECT_EQ(trace.find("{\"traceEvents\":["), 0);
+  EXPECT_NE(trace.find("\"ts\":0.000,\"dur\":1.500"), std::string::npos);
+  EXPECT_NE(trace.find("\"ts\":2.000,\"dur\":1.000"), std::string::npos);
+
+  size_t events = 0;
+
+  for (size_t i = trace.find("\"ph\":\"X\""); i != std::string::npos; i = trace.find("\"ph\":\"X\"", i + 1))
+  {
+    events++;
+  }
+
+  EXPECT_EQ(events, 2);
+}
+
+TEST(SchedulerProfiler_Tests, Clear_Recorded_Empty)
+{
+  SchedulerProfiler profiler;
+
+  const auto start = SchedulerProfiler::Clock::now();
+
+  profiler.BeginRun(start);
+  profiler.Record(Handle(SystemMock1), start, start + 1us);
+
+  profiler.Clear();
+
+  EXPECT_TRUE(profiler.Samples().empty());
+
+  profiler.Record(Handle(SystemMock1), start, start + 1us);
+
+  EXPECT_EQ(profiler.Samples().size(), 1);
+}
+} // namespace plex::tests
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 #include "plex/async/sync_wait.h"
 #include "plex/async/thread_pool.h"
 
@@ -42,6 +46,14 @@ namespace
     return vector;
   }
 
+  void RecordSystemMockCall(size_t id)
+  {
+    static std::mutex mutex;
+
+    std::lock_guard lock(mutex); // Systems without dependencies between them may run at the same time
+    SystemMockCallOrder().push_back(id);
+  }
+
   template<size_t id>
   std::atomic_size_t& SystemMockCallCount()
   {
@@ -53,7 +65,22 @@ namespace
   void SystemMock([[maybe_unused]] queries... q)
   {
     SystemMockCallCount<id>()++;
-    SystemMockCallOrder().push_back(id);
+    RecordSystemMockCall(id);
+  }
+
+  template<size_t id, Query... queries>
+  void SlowSystemMock([[maybe_unused]] queries... q)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    SystemMockCallCount<id>()++;
+    RecordSystemMockCall(id);
+  }
+
+  template<size_t id, size_t milliseconds>
+  void SleepingSystemMock()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    RecordSystemMockCall(id);
   }
 
   template<size_t id, Query... queries>
@@ -61,7 +88,15 @@ namespace
   {
     co_await thread_pool.Schedule();
     SystemMockCallCount<id>()++;
-    SystemMockCallOrder().push_back(id);
+    RecordSystemMockCall(id);
+  }
+
+  template<size_t id, Query... queries>
+  Task<void> ReadyAsyncSystemMock([[maybe_unused]] queries... q)
+  {
+    SystemMockCallCount<id>()++;
+    RecordSystemMockCall(id);
+    co_return;
   }
 } // namespace
 
@@ -205,4 +240,203 @@ TEST(Scheduler_Tests, RunAll_AsycDependantSystems_ExecuteInOrder)
   EXPECT_EQ(SystemMockCallOrder(), expected_order);
 }
 
-} // namespace plex::tests
\ No newline at end of file
+TEST(Scheduler_Tests, RunAll_AsyncDiamondRunManyTimes_CorrectExecution)
+{
+  Context context;
+
+  Scheduler scheduler;
+
+  // 1 writes both, 2 and 3 read one each in parallel, 4 writes both.
+  scheduler.AddSystem<MockStage<1>>(AsyncSystemMock<1, MockQuery<MockData<0>, MockData<1>>>);
+  scheduler.AddSystem<MockStage<2>>(AsyncSystemMock<2, MockQuery<const MockData<0>>>);
+  scheduler.AddSystem<MockStage<2>>(SystemMock<3, MockQuery<const MockData<1>>>);
+  scheduler.AddSystem<MockStage<3>>(AsyncSystemMock<4, MockQuery<MockData<0>, MockData<1>>>);
+
+  SystemMockCallCount<1>() = 0;
+  SystemMockCallCount<2>() = 0;
+  SystemMockCallCount<3>() = 0;
+  SystemMockCallCount<4>() = 0;
+
+  constexpr size_t runs = 100;
+
+  for (size_t i = 0; i < runs; i++)
+  {
+    SystemMockCallOrder().clear();
+
+    scheduler.Schedule<MockStage<1>>();
+    scheduler.Schedule<MockStage<2>>();
+    scheduler.Schedule<MockStage<3>>();
+
+    SyncWait(scheduler.RunAll(context));
+
+    ASSERT_EQ(SystemMockCallOrder().size(), 4);
+    EXPECT_EQ(SystemMockCallOrder().front(), 1);
+    EXPECT_EQ(SystemMockCallOrder().back(), 4);
+  }
+
+  EXPECT_EQ(SystemMockCallCount<1>(), runs);
+  EXPECT_EQ(SystemMockCallCount<2>(), runs);
+  EXPECT_EQ(SystemMockCallCount<3>(), runs);
+  EXPECT_EQ(SystemMockCallCount<4>(), runs);
+}
+
+TEST(Scheduler_Tests, RunAll_AsyncSystemsDoneWithoutSuspendingRunManyTimes_ExecuteInOrder)
+{
+  Context context;
+
+  Scheduler scheduler;
+
+  scheduler.AddSystem<MockStage<1>>(ReadyAsyncSystemMock<1, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<2>>(SystemMock<2, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<3>>(ReadyAsyncSystemMock<3, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<4>>(AsyncSystemMock<4, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<5>>(ReadyAsyncSystemMock<5, MockQuery<MockData<0>>>);
+
+  SystemMockCallCount<1>() = 0;
+  SystemMockCallCount<3>() = 0;
+  SystemMockCallCount<5>() = 0;
+
+  constexpr size_t runs = 100;
+
+  for (size_t i = 0; i < runs; i++)
+  {
+    SystemMockCallOrder().clear();
+
+    scheduler.Schedule<MockStage<1>>();
+    scheduler.Schedule<MockStage<2>>();
+    scheduler.Schedule<MockStage<3>>();
+    scheduler.Schedule<MockStage<4>>();
+    scheduler.Schedule<MockStage<5>>();
+
+    SyncWait(scheduler.RunAll(context));
+
+    Vector<size_t> expected_order { { 1, 2, 3, 4, 5 } };
+    ASSERT_EQ(SystemMockCallOrder(), expected_order);
+  }
+
+  // The same runners are resumed by every run
+  EXPECT_EQ(SystemMockCallCount<1>(), runs);
+  EXPECT_EQ(SystemMockCallCount<3>(), runs);
+  EXPECT_EQ(SystemMockCallCount<5>(), runs);
+}
+
+TEST(Scheduler_Tests, RunAll_SkewedExecutionTimes_LongestPathFirst)
+{
+  Context context;
+
+  Scheduler scheduler;
+
+  // 1, 3 and 4 are a chain of fast systems, 2 is a slow system on its own.
+  scheduler.AddSystem<MockStage<1>>(SystemMock<1, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<1>>(SlowSystemMock<2>);
+  scheduler.AddSystem<MockStage<2>>(SystemMock<3, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<3>>(SystemMock<4, MockQuery<MockData<0>>>);
+
+  auto run = [&]()
+  {
+    SystemMockCallOrder().clear();
+
+    scheduler.Schedule<MockStage<1>>();
+    scheduler.Schedule<MockStage<2>>();
+    scheduler.Schedule<MockStage<3>>();
+
+    SyncWait(scheduler.RunAll(context));
+  };
+
+  // Nothing measured yet, the longest chain goes first.
+  run();
+
+  Vector<size_t> expected_first_order { { 1, 3, 4, 2 } };
+  EXPECT_EQ(SystemMockCallOrder(), expected_first_order);
+
+  // The slow system is now known to be the longest path.
+  run();
+
+  Vector<size_t> expected_second_order { { 2, 1, 3, 4 } };
+  EXPECT_EQ(SystemMockCallOrder(), expected_second_order);
+}
+
+TEST(Scheduler_Tests, RunAll_AscendingExecutionTimes_LongestFirstOnceMeasured)
+{
+  Context context;
+
+  Scheduler scheduler;
+
+  // Independent systems, each about a tenth slower than the one before it.
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<1, 40>);
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<2, 44>);
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<3, 48>);
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<4, 53>);
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<5, 58>);
+  scheduler.AddSystem<MockStage<1>>(SleepingSystemMock<6, 64>);
+
+  auto run = [&]()
+  {
+    SystemMockCallOrder().clear();
+
+    scheduler.Schedule<MockStage<1>>();
+
+    SyncWait(scheduler.RunAll(context));
+  };
+
+  // Nothing measured yet, the systems run in the order they were added.
+  run();
+
+  Vector<size_t> expected_first_order { { 1, 2, 3, 4, 5, 6 } };
+  EXPECT_EQ(SystemMockCallOrder(), expected_first_order);
+
+  // Neighbours are within the jitter, but the slowest system is far longer than the fastest one.
+  run();
+
+  ASSERT_EQ(SystemMockCallOrder().size(), 6);
+  EXPECT_EQ(SystemMockCallOrder().front(), 6);
+  EXPECT_EQ(SystemMockCallOrder().back(), 1);
+}
+
+TEST(Scheduler_Tests, RunAll_Profiler_EverySystemRecorded)
+{
+  Context context;
+
+  Scheduler scheduler;
+
+  scheduler.AddSystem<MockStage<1>>(SystemMock<1, MockQuery<MockData<0>>>);
+  scheduler.AddSystem<MockStage<2>>(AsyncSystemMock<2, MockQuery<MockData<0>>>);
+
+  SchedulerProfiler profiler;
+
+  constexpr size_t runs = 3;
+
+  for (size_t i = 0; i < runs; i++)
+  {
+    // Only the runs in the middle are profiled
+    scheduler.SetProfiler(i == 0 ? nullptr : &profiler);
+
+    scheduler.Schedule<MockStage<1>>();
+    scheduler.Schedule<MockStage<2>>();
+
+    SyncWait(scheduler.RunAll(context));
+  }
+
+  const auto samples = profiler.Samples();
+
+  ASSERT_EQ(samples.size(), 4);
+
+  for (size_t i = 0; i < samples.size(); i += 2)
+  {
+    EXPECT_EQ(samples[i].system, std::bit_cast<SystemHandle>(&SystemMock<1, MockQuery<MockData<0>>>));
+    EXPECT_EQ(samples[i + 1].system, std::bit_cast<SystemHandle>(&AsyncSystemMock<2, MockQuery<MockData<0>>>));
+    EXPECT_EQ(samples[i].run, samples[i + 1].run);
+
+    // The second system waits on the first one
+    EXPECT_LE(samples[i].end, samples[i + 1].start);
+    EXPECT_GE(samples[i + 1].dependency_wait, samples[i].end - samples[i].start);
+  }
+
+  const auto summary = profiler.Summary();
+
+  ASSERT_EQ(summary.size(), 2);
+  EXPECT_EQ(summary[0].executions, runs - 1);
+  EXPECT_EQ(summary[1].executions, runs - 1);
+}
+
+} // namespace plex::tests
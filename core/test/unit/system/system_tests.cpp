@@ -47,6 +47,20 @@ namespace
     }
   };
 
+  template<bool ReadOnly>
+  struct AllComponentsMock
+  {
+    static AllComponentsMock Fetch(void*, Context&, Context&)
+    {
+      return AllComponentsMock();
+    }
+
+    static consteval std::array<QueryDataAccess, 1> GetDataAccess() noexcept
+    {
+      return { QueryDataAccess { "components", {}, ReadOnly, false } }; // Every section of the data source
+    }
+  };
+
   size_t system_call_counter;
 
   template<typename... Queries>
@@ -416,6 +430,39 @@ TEST(SystemObject_Tests, Constructor_Subroutine)
   EXPECT_EQ(system, object.Handle());
 }
 
+TEST(SystemObject_Tests, ExecutionTime_NeverRecorded_Zero)
+{
+  SystemObject object(SystemMock2<ResourcesMock<>>);
+
+  EXPECT_EQ(object.ExecutionTime(), std::chrono::nanoseconds { 0 });
+}
+
+TEST(SystemObject_Tests, RecordExecutionTime_FirstExecution_TakenAsIs)
+{
+  SystemObject object(SystemMock2<ResourcesMock<>>);
+
+  object.RecordExecutionTime(std::chrono::nanoseconds { 800 });
+
+  EXPECT_EQ(object.ExecutionTime(), std::chrono::nanoseconds { 800 });
+}
+
+TEST(SystemObject_Tests, RecordExecutionTime_MultipleExecutions_MovingAverage)
+{
+  SystemObject object(SystemMock2<ResourcesMock<>>);
+
+  object.RecordExecutionTime(std::chrono::nanoseconds { 800 });
+  object.RecordExecutionTime(std::chrono::nanoseconds { 1600 });
+
+  EXPECT_EQ(object.ExecutionTime(), std::chrono::nanoseconds { 900 });
+
+  for (size_t i = 0; i < 100; i++)
+  {
+    object.RecordExecutionTime(std::chrono::nanoseconds { 1600 });
+  }
+
+  EXPECT_NEAR(static_cast<double>(object.ExecutionTime().count()), 1600.0, 10.0);
+}
+
 TEST(SystemObject_Tests, HasDependency_SystemNoDependencies_NoDependency)
 {
   auto system1 = SystemMock2<ResourcesMock<>>;
@@ -553,4 +600,51 @@ TEST(SystemObject_Tests, HasDependency_WriteWriteThreadSafe_NoDependency)
 
   EXPECT_FALSE(object1.HasDependency(object2));
 }
-} // namespace plex::tests
\ No newline at end of file
+
+TEST(SystemObject_Tests, HasDependency_WriteWholeSourceReadSection_Dependency)
+{
+  auto system1 = SystemMockId2<0, AllComponentsMock<false>>;
+  auto system2 = SystemMockId2<1, EntitiesMock<const int>>;
+
+  SystemObject object1(system1);
+  SystemObject object2(system2);
+
+  EXPECT_TRUE(object1.HasDependency(object2));
+  EXPECT_TRUE(object2.HasDependency(object1));
+}
+
+TEST(SystemObject_Tests, HasDependency_ReadWholeSourceWriteSection_Dependency)
+{
+  auto system1 = SystemMockId2<0, AllComponentsMock<true>>;
+  auto system2 = SystemMockId2<1, EntitiesMock<int>>;
+
+  SystemObject object1(system1);
+  SystemObject object2(system2);
+
+  EXPECT_TRUE(object1.HasDependency(object2));
+  EXPECT_TRUE(object2.HasDependency(object1));
+}
+
+TEST(SystemObject_Tests, HasDependency_ReadWholeSourceReadSection_NoDependency)
+{
+  auto system1 = SystemMockId2<0, AllComponentsMock<true>>;
+  auto system2 = SystemMockId2<1, EntitiesMock<const int>>;
+
+  SystemObject object1(system1);
+  SystemObject object2(system2);
+
+  EXPECT_FALSE(object1.HasDependency(object2));
+}
+
+TEST(SystemObject_Tests, HasDependency_WriteWholeSourceOtherSource_NoDependency)
+{
+  auto system1 = SystemMockId2<0, AllComponentsMock<false>>;
+  auto system2 = SystemMockId2<1, ResourcesMock<int>>;
+
+  SystemObject object1(system1);
+  SystemObject object2(system2);
+
+  EXPECT_FALSE(object1.HasDependency(object2));
+  EXPECT_FALSE(object2.HasDependency(object1));
+}
+} // namespace plex::tests
@@ -1,6 +1,5 @@
 
 #include "plex/app/app.h"
-#include "plex/async/sync_wait.h"
 #include "plex/async/task.h"
 #include "plex/debug/logging.h"
 #include "plex/ecs/ecs.h"
@@ -50,7 +49,7 @@ public:
 
     Schedule<TestApp::EventsUpdateStage>();
 
-    SyncWait(RunScheduler());
+    RunFrame();
   }
 
   static Task<void> EventsUpdateSystem(ThreadPool& pool, EventRegistry& registry)